@@ -0,0 +1,97 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <memory_resource>
+#include <type_traits>
+
+namespace yagit{
+
+/// @brief Alignment (in bytes) of data of ImageData - it is equal to the size of cache line
+/// and the size of the widest SIMD register (AVX-512)
+constexpr size_t DataAlignment = 64;
+
+/**
+ * @brief Allocator returning memory aligned to DataAlignment bytes and obtained from a memory resource
+ * 
+ * By default memory is obtained from std::pmr::get_default_resource() (i.e. from operator new),
+ * but any other memory resource can be supplied (e.g. pool of buffers reused between images
+ * or resource allocating huge pages).
+ * 
+ * @code
+ * std::pmr::unsynchronized_pool_resource pool;
+ * yagit::ImageData img(data, size, offset, spacing, &pool);
+ * @endcode
+ * 
+ * @warning Memory resource must outlive all containers using it.
+ */
+template <typename T>
+class AlignedAllocator{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    AlignedAllocator() noexcept
+        : m_resource(std::pmr::get_default_resource()) {}
+
+    /// @brief Create allocator obtaining memory from @a resource (nullptr means default resource)
+    AlignedAllocator(std::pmr::memory_resource* resource) noexcept
+        : m_resource(resource != nullptr ? resource : std::pmr::get_default_resource()) {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>& other) noexcept
+        : m_resource(other.getResource()) {}
+
+    T* allocate(size_t n){
+        if(n > std::numeric_limits<size_t>::max() / sizeof(T)){
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(m_resource->allocate(n * sizeof(T), Alignment));
+    }
+
+    void deallocate(T* p, size_t n) noexcept{
+        m_resource->deallocate(p, n * sizeof(T), Alignment);
+    }
+
+    std::pmr::memory_resource* getResource() const noexcept{
+        return m_resource;
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>& other) const noexcept{
+        return m_resource == other.getResource() || m_resource->is_equal(*other.getResource());
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>& other) const noexcept{
+        return !(*this == other);
+    }
+
+private:
+    static constexpr size_t Alignment = alignof(T) > DataAlignment ? alignof(T) : DataAlignment;
+
+    std::pmr::memory_resource* m_resource;
+};
+
+}
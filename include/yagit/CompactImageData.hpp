@@ -0,0 +1,150 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "yagit/DataStructs.hpp"
+#include "yagit/AlignedAllocator.hpp"
+#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+#include "yagit/Gamma.hpp"
+
+namespace yagit{
+
+/**
+ * @brief Enum with 16-bit floating-point formats of CompactImageData
+ */
+enum class CompactFormat{
+    Float16,  ///< IEEE 754 half precision (11-bit significand, maximum value 65504)
+    BFloat16, ///< bfloat16 (8-bit significand, the same range as float)
+    UInt16    ///< Unsigned integers multiplied by scaling factor (like pixel data and Dose Grid Scaling of RT Dose)
+};
+
+/**
+ * @brief Container storing image as 16-bit values and its metadata (size, offset, spacing)
+ * 
+ * It takes half the memory of ImageData, so it is suited for keeping many images in memory
+ * (e.g. in batch jobs). Values are rounded to the nearest representable value when image is created
+ * and are widened to float when they are read.
+ * Dose distributions are smooth, so precision of Float16 (relative error below 0.05%)
+ * is sufficient for gamma index with 1% dose difference criterion.
+ * BFloat16 has the range of float, but its relative error is up to 0.4%.
+ * UInt16 stores non-negative values quantized to 65536 levels between 0 and the maximum value
+ * (it is the native format of 16-bit RT Dose, see DataReader::readRTDoseDicomCompact).
+ * It is only a storage format - integers are multiplied by scaling factor when they are widened
+ * and gamma index is calculated in float like for other formats (there are no kernels working in integer units).
+ * 
+ * Classic and Wendling gamma index functions have overloads taking CompactImageData. They widen reference image
+ * in parts (e.g. slabs of frames), and most of them keep raw 16-bit values of evaluated image, which are widened
+ * only in registers when the kernel reads them, so the kernel reads half as many bytes (see their documentation
+ * for the exceptions). Other gamma index functions take ImageView, so image has to be widened with toImageData() first. linearFrameAtZ also has an overload for CompactImageData,
+ * which widens only two frames. streamed() can be passed to gammaIndex3DWendlingStreamed,
+ * which widens only the frames that are currently needed.
+ * 
+ * @note Values of Float16 image greater than 65504 (in absolute value) are stored as infinity.
+ */
+class CompactImageData{
+public:
+    using value_type = float;
+    using storage_type = uint16_t;
+    using allocator_type = AlignedAllocator<storage_type>;
+    using container_type = std::vector<storage_type, allocator_type>;
+    using size_type = container_type::size_type;
+
+    CompactImageData() = default;
+
+    /**
+     * @brief Create image with values of @a image rounded to @a format
+     * 
+     * In UInt16 format, scaling factor is chosen so that the maximum value of @a image is stored as 65535.
+     * @throw std::invalid_argument if format is UInt16 and @a image contains negative, infinite or NaN values
+     */
+    CompactImageData(const ImageView& image, CompactFormat format,
+                     const allocator_type& allocator = allocator_type());
+
+    /**
+     * @brief Create image taking ownership of @a data that is already stored in @a format
+     * @param scaling Factor by which values are multiplied when they are widened (used only in UInt16 format)
+     */
+    CompactImageData(container_type&& data, CompactFormat format,
+                     const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+                     double scaling = 1);
+
+    DataSize getSize() const{
+        return m_size;
+    }
+    DataOffset getOffset() const{
+        return m_offset;
+    }
+    DataSpacing getSpacing() const{
+        return m_spacing;
+    }
+    CompactFormat getFormat() const{
+        return m_format;
+    }
+    /// @brief Factor by which values are multiplied when they are widened (1 for floating-point formats)
+    double getScaling() const{
+        return m_scaling;
+    }
+
+    /// @brief Number of elements of image (frames*rows*columns)
+    size_type size() const{
+        return m_data.size();
+    }
+
+    /// @brief Get image element at position (@a frame, @a row, @a column) widened to float
+    value_type get(uint32_t frame, uint32_t row, uint32_t column) const{
+        return get((frame * m_size.rows + row) * m_size.columns + column);
+    }
+
+    /// @brief Get element at @a index of flattened image widened to float
+    value_type get(uint32_t index) const;
+
+    /// @brief Pointer to the first 16-bit element of image (raw value)
+    const storage_type* data() const{
+        return m_data.data();
+    }
+
+    /// @brief Returns image widened to float
+    ImageData toImageData() const;
+
+    /// @brief Returns @a nrOfFrames frames starting at @a frameBegin widened to float
+    /// @throw std::out_of_range if frames are outside of image
+    ImageData::container_type readFrames(uint32_t frameBegin, uint32_t nrOfFrames) const;
+
+    /**
+     * @brief Get image that is widened to float frame by frame, when its frames are read
+     * @warning Returned object refers to this image, so this image must outlive it.
+     */
+    StreamedImage streamed() const;
+
+private:
+    container_type m_data;
+    CompactFormat m_format{CompactFormat::Float16};
+    double m_scaling{1};
+
+    DataSize m_size{0, 0, 0};
+    DataOffset m_offset{0, 0, 0};
+    DataSpacing m_spacing{1, 1, 1};
+};
+
+}
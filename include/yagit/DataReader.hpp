@@ -19,8 +19,12 @@
 #pragma once
 
 #include <string>
+#include <istream>
+#include <vector>
 
 #include "yagit/ImageData.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/MappedImage.hpp"
 
 namespace yagit::DataReader{
 
@@ -32,12 +36,134 @@ namespace yagit::DataReader{
  */
 ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo = false);
 
+/**
+ * @brief Read RT Dose DICOM data from stream and retrieve dose image from it
+ * 
+ * Stream is read only inside this function, so it can be e.g. a stream received over network.
+ * 
+ * @param stream Stream containing RT Dose DICOM data (in the same format as .dcm file)
+ * @param displayInfo Whether to show additional information read from the stream
+ * @return Image containing dose values and image info (size, offset, spacing) retrieved from DICOM data
+ */
+ImageData readRTDoseDicom(std::istream& stream, bool displayInfo = false);
+
+/**
+ * @brief Read RT Dose DICOM data from memory buffer and retrieve dose image from it
+ * 
+ * Buffer is read in place, without copying it to a temporary file or stream.
+ * 
+ * @param data Pointer to RT Dose DICOM data (in the same format as .dcm file)
+ * @param size Size of data in bytes
+ * @param displayInfo Whether to show additional information read from the buffer
+ * @return Image containing dose values and image info (size, offset, spacing) retrieved from DICOM data
+ */
+ImageData readRTDoseDicomFromBuffer(const char* data, size_t size, bool displayInfo = false);
+
+/**
+ * @brief Read RT Dose DICOM file with 16-bit pixel data and retrieve dose image from it without converting it to float
+ * 
+ * Pixel data is stored as it is (in UInt16 format) with Dose Grid Scaling as scaling factor,
+ * so the image takes half the memory of image returned by readRTDoseDicom and widened values are the same.
+ * It is only a storage format - gamma index functions taking CompactImageData multiply values by scaling factor
+ * when they widen them and calculate gamma index in float, not in scaled integer units.
+ * 
+ * @param filepath File path to RT Dose DICOM (.dcm)
+ * @param displayInfo Whether to show additional information read from the file
+ * @return Image containing raw pixel data, scaling factor and image info (size, offset, spacing)
+ * retrieved from DICOM file
+ * @throw std::runtime_error if pixel data isn't 16-bit
+ */
+CompactImageData readRTDoseDicomCompact(const std::string& filepath, bool displayInfo = false);
+
+/**
+ * @brief Read RT Dose DICOM files containing consecutive frames of one volume and stack them into one dose image
+ * 
+ * Files can be given in any order - they are sorted by z position of their first frame.
+ * All files must have the same number of rows and columns, x and y position and pixel spacing,
+ * and frames of consecutive files must be evenly spaced.
+ * Pixel data of each file is converted directly into its frames of image.
+ * When yagit is built with threads (THREADS and THREADS_SIMD versions), files are read and converted in parallel.
+ * 
+ * @param filepaths File paths to RT Dose DICOM files (.dcm)
+ * @param displayInfo Whether to show additional information read from the files
+ * @return Image containing dose values of all frames and image info (size, offset, spacing)
+ * @throw std::invalid_argument if list of files is empty
+ * @throw std::runtime_error if geometry of files is inconsistent
+ */
+ImageData readRTDoseDicomSeries(const std::vector<std::string>& filepaths, bool displayInfo = false);
+
+/**
+ * @brief Read RT Dose DICOM files with doses of the same grid (e.g. doses of beams) and sum them into one dose image
+ * 
+ * All files must have the same size, offset and spacing.
+ * Doses are summed in one pass over pixel data of all files (in double precision),
+ * without creating image for each file.
+ * When yagit is built with threads (THREADS and THREADS_SIMD versions), files are read and summed in parallel.
+ * 
+ * @param filepaths File paths to RT Dose DICOM files (.dcm)
+ * @param displayInfo Whether to show additional information read from the files
+ * @return Image containing sum of doses and image info (size, offset, spacing)
+ * @throw std::invalid_argument if list of files is empty
+ * @throw std::runtime_error if files have different size, offset or spacing
+ */
+ImageData readRTDoseDicomSum(const std::vector<std::string>& filepaths, bool displayInfo = false);
+
 /**
  * @brief Read MetaImage file and retrieve image from it
- * @param filepath File path to MetaImage file (.mha)
+ * 
+ * Compressed pixel data (CompressedData = True) is decompressed in blocks while it is read.
+ * Pixel data can be stored in the same file as header (ElementDataFile = LOCAL) or in separate data files
+ * (e.g. .mhd header with .raw data), whose paths are relative to directory of header file.
+ * ElementDataFile can contain name of one data file, LIST of data files (in the following lines)
+ * or pattern of names with range of numbers (e.g. slice%03d.raw 1 100 1).
+ * Each data file contains the same part of pixel data (e.g. one frame), optionally preceded by HeaderSize bytes.
+ * When yagit is built with threads (THREADS and THREADS_SIMD versions), parts of data are read in parallel.
+ * 
+ * @param filepath File path to MetaImage file (.mha or .mhd)
  * @param displayInfo Whether to show additional information read from the file
  * @return Image and its info (size, offset, spacing) retrieved from MetaImage file
  */
 ImageData readMetaImage(const std::string& filepath, bool displayInfo = false);
 
+/**
+ * @brief Read MetaImage data from stream and retrieve image from it
+ * 
+ * Pixel data must be stored in the stream just after header (ElementDataFile = LOCAL).
+ * Stream doesn't have to be seekable.
+ * 
+ * @param stream Stream containing MetaImage data (in the same format as .mha file)
+ * @param displayInfo Whether to show additional information read from the stream
+ * @return Image and its info (size, offset, spacing) retrieved from MetaImage data
+ * @throw std::runtime_error if pixel data is stored in separate data files
+ */
+ImageData readMetaImage(std::istream& stream, bool displayInfo = false);
+
+/**
+ * @brief Read MetaImage data from memory buffer and retrieve image from it
+ * 
+ * Pixel data must be stored in the buffer just after header (ElementDataFile = LOCAL).
+ * Uncompressed pixel data in system byte order is converted to float directly from the buffer,
+ * without intermediate copies (buffer doesn't have to be aligned).
+ * 
+ * @param data Pointer to MetaImage data (in the same format as .mha file)
+ * @param size Size of data in bytes
+ * @param displayInfo Whether to show additional information read from the buffer
+ * @return Image and its info (size, offset, spacing) retrieved from MetaImage data
+ * @throw std::runtime_error if pixel data is stored in separate data files
+ */
+ImageData readMetaImageFromBuffer(const char* data, size_t size, bool displayInfo = false);
+
+/**
+ * @brief Memory-map MetaImage file and retrieve image from it without reading its data
+ * 
+ * Image data is mapped only if it is stored as uncompressed floats (MET_FLOAT) in system byte order
+ * in one file (header file or one data file), otherwise it is read and converted to float
+ * in the same way as in readMetaImage.
+ * 
+ * @param filepath File path to MetaImage file (.mha or .mhd)
+ * @param displayInfo Whether to show additional information read from the file
+ * @return Image and its info (size, offset, spacing) retrieved from MetaImage file
+ */
+MappedImage mapMetaImage(const std::string& filepath, bool displayInfo = false);
+
 }
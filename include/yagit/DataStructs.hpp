@@ -19,6 +19,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace yagit{
 
@@ -72,4 +73,21 @@ struct DataSpacing{
     }
 };
 
+/**
+ * @brief Distance between consecutive frames, rows, and columns of 3D image in memory, in number of elements
+ * @note Values can be negative (e.g. for flipped image)
+ */
+struct DataStrides{
+    std::ptrdiff_t frames;   ///< Number of elements between consecutive frames
+    std::ptrdiff_t rows;     ///< Number of elements between consecutive rows
+    std::ptrdiff_t columns;  ///< Number of elements between consecutive columns
+
+    bool operator==(const DataStrides& other) const{
+        return frames == other.frames && rows == other.rows && columns == other.columns;
+    }
+    bool operator!=(const DataStrides& other) const{
+        return !operator==(other);
+    }
+};
+
 }
@@ -26,9 +26,20 @@ namespace yagit::DataWriter{
 
 /**
  * @brief Write image to MetaImage file (.mha)
+ * 
+ * Compressed data is written as zlib stream (CompressedData = True), which is readable by ITK.
+ * Dose and gamma index images usually contain large areas of constant values (e.g. air),
+ * so they are compressed several times, what reduces time of writing files to slow (e.g. network) storage.
+ * Data is compressed in 1 MiB blocks, which are processed by several threads if yagit is built with threads.
+ * Whole compressed data is kept in memory until it is written,
+ * because its size (CompressedDataSize) is stored in header before the data.
+ *
  * @param img Image to save
  * @param filepath File path where image will be saved
+ * @param compressionLevel Level of zlib compression from 1 (the fastest) to 9 (the best compression)
+ * or 0 to write uncompressed data
+ * @throw std::invalid_argument if @a compressionLevel is not in range [0, 9]
  */
-void writeToMetaImage(const ImageData& img, const std::string& filepath);
+void writeToMetaImage(const ImageData& img, const std::string& filepath, int compressionLevel = 0);
 
 }
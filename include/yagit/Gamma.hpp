@@ -18,22 +18,97 @@
  ********************************************************************************************/
 #pragma once
 
+#include <vector>
+#include <cstdint>
+#include <functional>
+
 #include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
 #include "yagit/GammaParameters.hpp"
 #include "yagit/GammaResult.hpp"
 
 namespace yagit{
 
+class CompactImageData;
+
+/**
+ * @brief 3D image that is read frame by frame, so it doesn't have to be stored in memory as a whole
+ */
+struct StreamedImage{
+    DataSize size;        ///< Size of the whole image
+    DataOffset offset;    ///< Offset of the whole image
+    DataSpacing spacing;  ///< Spacing of the image
+    /**
+     * @brief Function returning @a nrOfFrames frames starting at @a frameBegin
+     * (frames * rows * columns values in the same order as in ImageData)
+     */
+    std::function<ImageData::container_type(uint32_t frameBegin, uint32_t nrOfFrames)> readFrames;
+};
+
+/**
+ * @brief Function receiving consecutive slabs (groups of frames) of gamma index image.
+ * Slab starts at frame @a frameBegin of the whole gamma index image.
+ */
+using GammaSlabWriter = std::function<void(const GammaResult& slab, uint32_t frameBegin)>;
+
+/**
+ * @brief Passing rate that gamma index has to achieve, used to stop calculation early
+ */
+struct GammaPassingRateTarget{
+    /// Required passing rate (fraction of voxels with gamma index <= 1, in range [0, 1])
+    double passingRate;
+    /// @brief Stop also when the required passing rate is guaranteed to be met.
+    /// By default calculation is stopped only when it can no longer be met.
+    bool stopWhenGuaranteed = false;
+};
+
+/**
+ * @brief Result of gamma index calculation with passing rate target
+ */
+struct GammaTargetResult{
+    /// Gamma index values (NaN for voxels that haven't been calculated, when calculation has been stopped early)
+    GammaResult gammaResult;
+    /// Calculation has been stopped early, so @a gammaResult doesn't contain all gamma index values
+    bool partial;
+    /// Passing rate of full gamma index is (or would be) not lower than target passing rate
+    bool targetMet;
+};
+
+/**
+ * @brief Summary statistics of gamma index (calculated without NaN values)
+ */
+struct GammaSummary{
+    double passingRate;   ///< The percentage of values that are less than or equal to 1
+    float minGamma;       ///< Minimum value of gamma index
+    float maxGamma;       ///< Maximum value of gamma index
+    double meanGamma;     ///< Mean of values of gamma index
+    double varGamma;      ///< Variance of values of gamma index
+    size_t size;          ///< Number of values of gamma index (without NaN values)
+    /// @brief Number of values in consecutive bins of width @a histogramBinWidth starting at 0.
+    /// The last bin contains all values greater than or equal to its lower bound.
+    std::vector<size_t> histogram;
+    float histogramBinWidth;  ///< Width of histogram bin
+};
+
 /**
  * @brief Enum with methods of calculating gamma index
  */
 enum class GammaMethod{
     Classic,  ///< Classic method. Based on https://doi.org/10.1118/1.598248
-    Wendling  ///< Wendling method. Based on https://doi.org/10.1118/1.2721657
+    Wendling, ///< Wendling method. Based on https://doi.org/10.1118/1.2721657
+    Chi       ///< Chi method (approximation of gamma index). Based on https://doi.org/10.1088/0031-9155/48/21/006
 };
 
 /**
- * @brief Calculate 2D gamma index using classic or Wendling method.
+ * @brief Enum with sizes of gamma index image returned by functions calculating gamma index on cropped images
+ */
+enum class GammaCropResult{
+    FullSize,  ///< Result has the size of reference image (values outside of the cropped region are NaN)
+    Cropped    ///< Result has the size of cropped region (with offset of its first voxel)
+};
+
+/**
+ * @brief Calculate 2D gamma index using classic, Wendling or chi method.
  * 
  * It takes into account y and x coordinates of images.
  * It doesn't take into account the z coordinates
@@ -45,11 +120,11 @@ enum class GammaMethod{
  * @param method Method that will be used to calculate gamma index
  * @return 2D image containing gamma index values 
  */
-GammaResult gammaIndex2D(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2D(const ImageView& refImg2D, const ImageView& evalImg2D,
                          const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling);
 
 /**
- * @brief Calculate 2.5D gamma index using classic or Wendling method.
+ * @brief Calculate 2.5D gamma index using classic, Wendling or chi method.
  * 
  * It calculates gamma index slice by slice going along axial plane.
  * On each slice, it takes into account y and x coordinates of images.
@@ -61,11 +136,11 @@ GammaResult gammaIndex2D(const ImageData& refImg2D, const ImageData& evalImg2D,
  * @param method Method that will be used to calculate gamma index
  * @return 3D image containing gamma index values
  */
-GammaResult gammaIndex2_5D(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5D(const ImageView& refImg3D, const ImageView& evalImg3D,
                            const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling);
 
 /**
- * @brief Calculate 3D gamma index using classic or Wendling method.
+ * @brief Calculate 3D gamma index using classic, Wendling or chi method.
  * 
  * It takes into account z, y, and x coordinates of images.
  * 
@@ -75,9 +150,179 @@ GammaResult gammaIndex2_5D(const ImageData& refImg3D, const ImageData& evalImg3D
  * @param method Method that will be used to calculate gamma index
  * @return 3D image containing gamma index values
  */
-GammaResult gammaIndex3D(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3D(const ImageView& refImg3D, const ImageView& evalImg3D,
                          const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling);
 
+/**
+ * @brief Calculate 2D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff.
+ * 
+ * Reference image is cropped to the bounding box (expanded by one voxel) and evaluated image is cropped
+ * to the same region expanded by maxSearchDistance, so voxels below dose cutoff (usually most of the image)
+ * are not processed by the gamma index method at all.
+ * For Wendling and chi methods it returns the same values as gammaIndex2D.
+ * For classic method values greater than maxSearchDistance / dtaThreshold can be greater than
+ * values returned by gammaIndex2D (evaluated voxels further than maxSearchDistance are not taken into account).
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 2D image containing gamma index values
+ */
+GammaResult gammaIndex2DCropped(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate 2D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff
+ * that are inside of region of interest.
+ * 
+ * See gammaIndex2DCropped for details.
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param roiMask Mask of region of interest with the same size as @a refImg2D
+ * (voxels with non-zero values are inside of region of interest)
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 2D image containing gamma index values
+ */
+GammaResult gammaIndex2DCropped(const ImageView& refImg2D, const ImageView& evalImg2D, const ImageView& roiMask,
+                                const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate 2.5D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff.
+ * 
+ * See gammaIndex2DCropped for details.
+ * Classic method compares frames with the same index, so for this method frames of evaluated image
+ * are cropped to the same indices as frames of reference image.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex2_5DCropped(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                  const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                  GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate 2.5D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff
+ * that are inside of region of interest.
+ * 
+ * See gammaIndex2DCropped for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param roiMask Mask of region of interest with the same size as @a refImg3D
+ * (voxels with non-zero values are inside of region of interest)
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex2_5DCropped(const ImageView& refImg3D, const ImageView& evalImg3D, const ImageView& roiMask,
+                                  const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                  GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate 3D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff.
+ * 
+ * See gammaIndex2DCropped for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex3DCropped(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate 3D gamma index only in the bounding box of reference voxels with dose not lower than doseCutoff
+ * that are inside of region of interest.
+ * 
+ * See gammaIndex2DCropped for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param roiMask Mask of region of interest with the same size as @a refImg3D
+ * (voxels with non-zero values are inside of region of interest)
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param resultSize Size of returned image
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex3DCropped(const ImageView& refImg3D, const ImageView& evalImg3D, const ImageView& roiMask,
+                                const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                GammaCropResult resultSize = GammaCropResult::FullSize);
+
+/**
+ * @brief Calculate only summary statistics of 2D gamma index, without storing the whole gamma index image.
+ * 
+ * Reference image is processed in chunks of rows, and statistics of each chunk are accumulated while
+ * it is still in cache, so memory usage doesn't depend on the size of image and
+ * values don't have to be read again by functions of GammaResult.
+ * For Wendling method each chunk is calculated like in gammaIndex2DCropped.
+ * The statistics are the same as statistics of the result of gammaIndex2D.
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param histogramBins Number of bins of histogram
+ * @param histogramMax Upper bound of the last but one bin of histogram
+ * (the last bin contains values greater than or equal to it)
+ * @return Summary statistics of gamma index
+ */
+GammaSummary gammaIndex2DSummary(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                 const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                 uint32_t histogramBins = 21, float histogramMax = 2);
+
+/**
+ * @brief Calculate only summary statistics of 2.5D gamma index, without storing the whole gamma index image.
+ * 
+ * Reference image is processed in chunks of frames. See gammaIndex2DSummary for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param histogramBins Number of bins of histogram
+ * @param histogramMax Upper bound of the last but one bin of histogram
+ * (the last bin contains values greater than or equal to it)
+ * @return Summary statistics of gamma index
+ */
+GammaSummary gammaIndex2_5DSummary(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                   const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                   uint32_t histogramBins = 21, float histogramMax = 2);
+
+/**
+ * @brief Calculate only summary statistics of 3D gamma index, without storing the whole gamma index image.
+ * 
+ * Reference image is processed in chunks of frames. See gammaIndex2DSummary for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param method Method that will be used to calculate gamma index
+ * @param histogramBins Number of bins of histogram
+ * @param histogramMax Upper bound of the last but one bin of histogram
+ * (the last bin contains values greater than or equal to it)
+ * @return Summary statistics of gamma index
+ */
+GammaSummary gammaIndex3DSummary(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                 const GammaParameters& gammaParams, GammaMethod method = GammaMethod::Wendling,
+                                 uint32_t histogramBins = 21, float histogramMax = 2);
+
 /**
  * @brief Calculate 2D gamma index using classic method.
  * 
@@ -92,7 +337,7 @@ GammaResult gammaIndex3D(const ImageData& refImg3D, const ImageData& evalImg3D,
  * @param gammaParams Parameters of gamma index
  * @return 2D image containing gamma index values
  */
-GammaResult gammaIndex2DClassic(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2DClassic(const ImageView& refImg2D, const ImageView& evalImg2D,
                                 const GammaParameters& gammaParams);
 
 /**
@@ -110,7 +355,7 @@ GammaResult gammaIndex2DClassic(const ImageData& refImg2D, const ImageData& eval
  * @param gammaParams Parameters of gamma index
  * @return 3D image containing gamma index values
  */
-GammaResult gammaIndex2_5DClassic(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5DClassic(const ImageView& refImg3D, const ImageView& evalImg3D,
                                   const GammaParameters& gammaParams);
 
 /**
@@ -125,7 +370,7 @@ GammaResult gammaIndex2_5DClassic(const ImageData& refImg3D, const ImageData& ev
  * @param gammaParams Parameters of gamma index
  * @return 3D image containing gamma index values 
  */
-GammaResult gammaIndex3DClassic(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3DClassic(const ImageView& refImg3D, const ImageView& evalImg3D,
                                 const GammaParameters& gammaParams);
 
 /**
@@ -143,7 +388,7 @@ GammaResult gammaIndex3DClassic(const ImageData& refImg3D, const ImageData& eval
  * @param gammaParams Parameters of gamma index
  * @return 2D image containing gamma index values
  */
-GammaResult gammaIndex2DWendling(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2DWendling(const ImageView& refImg2D, const ImageView& evalImg2D,
                                  const GammaParameters& gammaParams);
 
 /**
@@ -151,8 +396,9 @@ GammaResult gammaIndex2DWendling(const ImageData& refImg2D, const ImageData& eva
  * 
  * It calculates gamma index slice by slice going along axial plane.
  * On each slice, it takes into account y and x coordinates of images.
- * @a evalImg3D is interpolated along the z axis before gamma calculations
- * to have the same grid only along that axis as @a refImg.
+ * @a evalImg3D is interpolated along the z axis to have the same grid only along that axis as @a refImg.
+ * Frames are interpolated on demand when their slice is calculated
+ * and released afterwards, so the whole interpolated image is never stored in memory.
  * 
  * It is faster than classic method, so using this function is recommended.
  * Based on https://doi.org/10.1118/1.2721657
@@ -162,7 +408,7 @@ GammaResult gammaIndex2DWendling(const ImageData& refImg2D, const ImageData& eva
  * @param gammaParams Parameters of gamma index
  * @return 3D image containing gamma index values 
  */
-GammaResult gammaIndex2_5DWendling(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5DWendling(const ImageView& refImg3D, const ImageView& evalImg3D,
                                    const GammaParameters& gammaParams);
 
 /**
@@ -178,7 +424,229 @@ GammaResult gammaIndex2_5DWendling(const ImageData& refImg3D, const ImageData& e
  * @param gammaParams Parameters of gamma index
  * @return 3D image containing gamma index values 
  */
-GammaResult gammaIndex3DWendling(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3DWendling(const ImageView& refImg3D, const ImageView& evalImg3D,
                                  const GammaParameters& gammaParams);
 
+/**
+ * @brief Calculate 3D gamma index using Wendling method, reading images and writing result slab by slab.
+ * 
+ * Reference image is processed in slabs of @a slabFrames frames.
+ * For each slab only frames of evaluated image that are within maxSearchDistance of the slab are read,
+ * and calculated slab of gamma index is passed to @a writeSlab, so peak memory usage depends
+ * on the size of slab and not on the size of the whole image.
+ * It returns the same values as gammaIndex3DWendling up to rounding - coordinates of each slab
+ * are calculated from its first frame, so they can differ slightly from coordinates of the whole image.
+ * 
+ * Based on https://doi.org/10.1118/1.2721657
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param slabFrames Number of frames of reference image processed at once
+ * @param writeSlab Function receiving calculated slabs of gamma index image (in order of frames)
+ */
+void gammaIndex3DWendlingStreamed(const StreamedImage& refImg3D, const StreamedImage& evalImg3D,
+                                  const GammaParameters& gammaParams, uint32_t slabFrames,
+                                  const GammaSlabWriter& writeSlab);
+
+/**
+ * @brief Calculate 2D gamma index using classic method for images stored in 16-bit format.
+ * 
+ * Reference image is widened to float in bands of rows.
+ * In SIMD and THREADS_SIMD versions, each band is compared with raw 16-bit values of evaluated image,
+ * which are widened in SIMD registers, so evaluated image isn't widened in memory at all.
+ * In the other versions, evaluated image is widened in bands too and each band of reference image
+ * is compared with all of them one after another.
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 2D image containing gamma index values
+ */
+GammaResult gammaIndex2DClassic(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 2.5D gamma index using classic method for images stored in 16-bit format.
+ * 
+ * Frames are calculated one after another, so only the current frame of reference image is widened to float.
+ * Evaluated frames are widened like in gammaIndex2DClassic for compact images.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex2_5DClassic(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                  const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 3D gamma index using classic method for images stored in 16-bit format.
+ * 
+ * Reference image is widened to float in slabs of frames.
+ * Evaluated image is widened like in gammaIndex2DClassic for compact images (in slabs of frames).
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex3DClassic(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 2D gamma index using Wendling method for images stored in 16-bit format.
+ * 
+ * Evaluated image is copied to the padded layout used by the search with its raw 16-bit values,
+ * which are widened to float only when they are read. When yagit is built with ENABLE_WENDLING_SIMD,
+ * vectorized kernels need float values, so evaluated image is widened while it is copied instead.
+ * Reference image is widened in bands of rows.
+ * Results may differ from gammaIndex2DWendling of widened images only by rounding of coordinates.
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 2D image containing gamma index values
+ */
+GammaResult gammaIndex2DWendling(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                 const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 2.5D gamma index using Wendling method for images stored in 16-bit format.
+ * 
+ * Reference image is widened frame by frame. For each of its frames, only the two frames
+ * of evaluated image used by interpolation along the z axis are widened.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex2_5DWendling(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                   const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 3D gamma index using Wendling method for images stored in 16-bit format.
+ * 
+ * Evaluated image is copied to the bricked layout used by the search with its raw 16-bit values,
+ * which are widened to float only when they are read (except when yagit is built with ENABLE_WENDLING_SIMD,
+ * see gammaIndex2DWendling for compact images). Reference image is widened in slabs of frames.
+ * Results may differ from gammaIndex3DWendling of widened images only by rounding of coordinates.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing gamma index values
+ */
+GammaResult gammaIndex3DWendling(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                 const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 2D gamma index using Wendling method until it is known whether passing rate target is met.
+ * 
+ * Reference image is processed tile by tile, and passing rate is tracked while tiles are calculated.
+ * Calculation stops as soon as @a target can no longer be met (or is guaranteed to be met,
+ * if it is requested in @a target), so failing plans are rejected in a fraction of time of full calculation.
+ * Voxels that haven't been calculated are NaN and the result is marked as partial.
+ * See gammaIndex2DWendling for details.
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param target Passing rate target
+ * @return 2D image containing gamma index values with information whether target is met
+ */
+GammaTargetResult gammaIndex2DWendlingWithTarget(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                                 const GammaParameters& gammaParams,
+                                                 const GammaPassingRateTarget& target);
+
+/**
+ * @brief Calculate 2.5D gamma index using Wendling method until it is known whether passing rate target is met.
+ * 
+ * See gammaIndex2DWendlingWithTarget and gammaIndex2_5DWendling for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param target Passing rate target
+ * @return 3D image containing gamma index values with information whether target is met
+ */
+GammaTargetResult gammaIndex2_5DWendlingWithTarget(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                   const GammaParameters& gammaParams,
+                                                   const GammaPassingRateTarget& target);
+
+/**
+ * @brief Calculate 3D gamma index using Wendling method until it is known whether passing rate target is met.
+ * 
+ * See gammaIndex2DWendlingWithTarget and gammaIndex3DWendling for details.
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @param target Passing rate target
+ * @return 3D image containing gamma index values with information whether target is met
+ */
+GammaTargetResult gammaIndex3DWendlingWithTarget(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                 const GammaParameters& gammaParams,
+                                                 const GammaPassingRateTarget& target);
+
+/**
+ * @brief Calculate 2D chi index - fast approximation of 2D gamma index.
+ * 
+ * It takes into account y and x coordinates of images.
+ * It doesn't take into account the z coordinates
+ * (different z-offsets of @a refImg and @a evalImg have no impact on the result).
+ * 
+ * Chi = (Deval - Dref) / sqrt(DD^2 + DTA^2 * |grad Dref|^2) is calculated in a single pass
+ * over voxels of @a refImg2D, where @a evalImg2D is linearly interpolated
+ * and gradient of @a refImg2D is calculated with central differences.
+ * Absolute value of chi is returned, so the result can be interpreted like gamma index.
+ * It approximates gamma index well for smooth dose distributions,
+ * so it can be used e.g. to screen plans before calculating gamma index with Wendling method.
+ * Parameters maxSearchDistance, stepSize and interpolation are not used.
+ * Based on https://doi.org/10.1088/0031-9155/48/21/006
+ * 
+ * @param refImg2D 2D reference image
+ * @param evalImg2D 2D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 2D image containing absolute values of chi index
+ */
+GammaResult gammaIndex2DChi(const ImageView& refImg2D, const ImageView& evalImg2D,
+                            const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 2.5D chi index - fast approximation of 2.5D gamma index.
+ * 
+ * It calculates chi index slice by slice going along axial plane,
+ * so gradient of @a refImg3D is calculated only along y and x axes.
+ * @a evalImg3D is interpolated along the z axis before calculations
+ * to have the same grid only along that axis as @a refImg.
+ * 
+ * See gammaIndex2DChi for details.
+ * Based on https://doi.org/10.1088/0031-9155/48/21/006
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing absolute values of chi index
+ */
+GammaResult gammaIndex2_5DChi(const ImageView& refImg3D, const ImageView& evalImg3D,
+                              const GammaParameters& gammaParams);
+
+/**
+ * @brief Calculate 3D chi index - fast approximation of 3D gamma index.
+ * 
+ * It takes into account z, y, and x coordinates of images.
+ * 
+ * See gammaIndex2DChi for details.
+ * Based on https://doi.org/10.1088/0031-9155/48/21/006
+ * 
+ * @param refImg3D 3D reference image
+ * @param evalImg3D 3D evaluated image
+ * @param gammaParams Parameters of gamma index
+ * @return 3D image containing absolute values of chi index
+ */
+GammaResult gammaIndex3DChi(const ImageView& refImg3D, const ImageView& evalImg3D,
+                            const GammaParameters& gammaParams);
+
 }
@@ -28,6 +28,23 @@ enum class GammaNormalization{
     Local    ///< Using local reference value (value at current voxel in the reference image)
 };
 
+/**
+ *  @brief Enum with types of interpolation of evaluated dose at search points (used only for Wendling method)
+*/
+enum class GammaInterpolation{
+    Nearest,  ///< Dose of the nearest voxel (the fastest, e.g. for screening)
+    Linear,   ///< Bilinear/trilinear interpolation
+    Cubic     ///< Bicubic/tricubic Catmull-Rom interpolation (the most accurate, allows a larger step size)
+};
+
+/**
+ *  @brief Enum with orders in which reference voxels are processed (used only for Wendling method)
+*/
+enum class GammaTraversal{
+    Raster,  ///< Row by row and frame by frame
+    Tiled    ///< In tiles ordered along Z-order (Morton) curve, so neighbouring voxels of the next row/frame are close
+};
+
 /**
  *  @brief Structure with parameters of gamma index
  */
@@ -49,6 +66,12 @@ struct GammaParameters{
     /// @brief Step size in millimeters [mm] that is used when searching within the circle/sphere.
     /// Used only for Wendling method.
     float stepSize;
+    /// @brief Interpolation of evaluated image at search points.
+    /// Used only for Wendling method.
+    GammaInterpolation interpolation = GammaInterpolation::Linear;
+    /// @brief Order in which reference voxels are processed (it doesn't change the result).
+    /// Used only for Wendling method.
+    GammaTraversal traversal = GammaTraversal::Raster;
 };
 
 }
@@ -22,6 +22,22 @@
 
 namespace yagit{
 
+/**
+ * @brief Statistics of gamma index values, ignoring NaN values
+ */
+struct GammaStatistics{
+    size_t size;       ///< Number of values of gamma index (without NaN values)
+    double sumGamma;   ///< Sum of values of gamma index
+    double meanGamma;  ///< Mean of values of gamma index
+    double varGamma;   ///< Variance of values of gamma index
+    float minGamma;    ///< Minimum value of gamma index
+    float maxGamma;    ///< Maximum value of gamma index
+    /// @brief Passing rates at consecutive thresholds (the percentage of values less than or equal to threshold)
+    std::vector<double> passingRates;
+    /// @brief Values of gamma index at consecutive percentiles
+    std::vector<float> percentiles;
+};
+
 /**
  * @brief Container storing gamma index values
  */
@@ -42,6 +58,23 @@ public:
     double meanGamma() const;
     /// @brief Variance of values of gamma index. It ignores NaN values.
     double varGamma() const;
+
+    /**
+     * @brief Calculate statistics of gamma index together, ignoring NaN values.
+     * 
+     * Size, sum, mean, variance, min, max and passing rates are calculated in a single pass over values,
+     * so it is faster than calling the functions calculating them separately.
+     * Percentiles are found with selection algorithm on a copy of values (without sorting them)
+     * and are linearly interpolated between the closest values (like in NumPy).
+     * 
+     * @param thresholds Thresholds at which passing rates are calculated (passing rate at threshold 1
+     * is equal to passingRate())
+     * @param percentiles Percentiles (from 0 to 100) of gamma index values to find
+     * @return Statistics of gamma index (passing rates and percentiles are NaN if there are no values)
+     * @throw std::invalid_argument if any percentile is outside [0, 100]
+     */
+    GammaStatistics statistics(const std::vector<float>& thresholds = {1},
+                               const std::vector<double>& percentiles = {}) const;
 };
 
 }
@@ -20,18 +20,36 @@
 
 #include <vector>
 #include <stdexcept>
+#include <type_traits>
 
 #include "yagit/DataStructs.hpp"
 #include "yagit/Image.hpp"
+#include "yagit/AlignedAllocator.hpp"
 
 namespace yagit{
 
+/**
+ * @brief Statistics of image values, ignoring any NaNs
+ */
+struct ImageStatistics{
+    size_t size;  ///< Number of elements of image (without NaN values)
+    double sum;   ///< Sum of image values
+    double mean;  ///< Mean of image values (NaN if there are no values)
+    double var;   ///< Variance of image values (NaN if there are no values)
+    float min;    ///< Minimum value of the image (infinity if there are no values)
+    float max;    ///< Maximum value of the image (-infinity if there are no values)
+};
+
 /**
  * @brief Container storing image and its metadata (size, offset, spacing)
  * 
  * Images are in format (frame, row, column) corresponding to (z, y, x) axes.
  * Coordinates are based on LPS coordinate system.
  * 
+ * Data is stored contiguously in memory aligned to DataAlignment bytes, so it can be loaded
+ * with aligned SIMD instructions. Memory is obtained from a memory resource of AlignedAllocator
+ * that can be supplied in constructors (by default operator new is used).
+ * 
  * @note It doesn't contain information about the plane in which the image is saved.
  * Instead, it assumes that all images are in the axial plane.
  */
@@ -41,21 +59,37 @@ public:
     // it is a float instead of a double, because a float provides sufficient precision for gamma index calculations
     // additionally, it takes two times less space and has better optimization possibilities
     using value_type = float;
-    using size_type = std::vector<value_type>::size_type;
+    using allocator_type = AlignedAllocator<value_type>;
+    using container_type = std::vector<value_type, allocator_type>;
+    using size_type = container_type::size_type;
     using reference = value_type&;
     using const_reference = const value_type&;
-    using pointer = std::vector<value_type>::pointer;
-    using const_pointer = std::vector<value_type>::const_pointer;
+    using pointer = container_type::pointer;
+    using const_pointer = container_type::const_pointer;
 
     ImageData();
 
-    template <typename U>
-    ImageData(const std::vector<U>& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing);
+    /// @brief Create image with copy of @a data
+    /// (std::vector<float> is also copied, because it doesn't guarantee alignment of data)
+    template <typename U, typename Allocator>
+    ImageData(const std::vector<U, Allocator>& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+              const allocator_type& allocator = allocator_type());
+
+    ImageData(const Image2D& image2d, const DataOffset& offset, const DataSpacing& spacing,
+              const allocator_type& allocator = allocator_type());
+    ImageData(const Image3D& image3d, const DataOffset& offset, const DataSpacing& spacing,
+              const allocator_type& allocator = allocator_type());
 
-    ImageData(const Image2D& image2d, const DataOffset& offset, const DataSpacing& spacing);
-    ImageData(const Image3D& image3d, const DataOffset& offset, const DataSpacing& spacing);
+    /// @brief Create image taking ownership of @a data (without copying it)
+    ImageData(container_type&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing) noexcept;
 
-    ImageData(std::vector<value_type>&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing) noexcept;
+    /// @brief Create image with copy of @a data and release memory of @a data
+    /// (std::vector<float> can't be moved, because it doesn't guarantee alignment of data).
+    /// It is a template accepting only rvalue std::vector<float>, so braced lists still create container_type
+    template <typename Vector, typename = std::enable_if_t<std::is_same_v<Vector, std::vector<value_type>>>>
+    [[deprecated("copies into aligned storage; use ImageData::container_type")]]
+    ImageData(Vector&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+              const allocator_type& allocator = allocator_type());
 
     ImageData(const ImageData& other) = default;
     ImageData& operator=(const ImageData& other) = default;
@@ -84,6 +118,11 @@ public:
     void setOffset(const DataOffset& offset);
     void setSpacing(const DataSpacing& spacing);
 
+    /// @brief Allocator (with memory resource) used to allocate data of image
+    allocator_type getAllocator() const{
+        return m_data.get_allocator();
+    }
+
     /// @brief Number of elements of image (frames*rows*columns)
     size_type size() const{
         return m_data.size();
@@ -175,11 +214,16 @@ public:
     /// @brief Number of elements of image, ignoring any NaNs
     size_type nansize() const;
 
+    /// @brief Statistics of image values (size, sum, mean, variance, min, max) calculated together
+    /// in a single pass over the image, ignoring any NaNs.
+    /// It is faster than calling nanmin, nanmax, nansum, nanmean, nanvar and nansize separately.
+    ImageStatistics nanstatistics() const;
+
     bool containsNan() const;
     bool containsInf() const;
 
 protected:
-    std::vector<value_type> m_data;
+    container_type m_data;
 
     DataSize m_size;
     DataOffset m_offset;
@@ -187,9 +231,10 @@ protected:
 };
 
 
-template <typename U>
-ImageData::ImageData(const std::vector<U>& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing)
-    : m_data(data.begin(), data.end()), m_size(size), m_offset(offset), m_spacing(spacing) {
+template <typename U, typename Allocator>
+ImageData::ImageData(const std::vector<U, Allocator>& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+                     const allocator_type& allocator)
+    : m_data(data.begin(), data.end(), allocator), m_size(size), m_offset(offset), m_spacing(spacing) {
     if(spacing.frames <= 0 || spacing.rows <= 0 || spacing.columns <= 0){
         throw std::invalid_argument("spacing should be greater than 0");
     }
@@ -198,4 +243,12 @@ ImageData::ImageData(const std::vector<U>& data, const DataSize& size, const Dat
     }
 }
 
+template <typename Vector, typename>
+ImageData::ImageData(Vector&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+                     const allocator_type& allocator)
+    : ImageData(static_cast<const std::vector<value_type>&>(data), size, offset, spacing, allocator) {
+    // data is moved from, so it doesn't keep its memory
+    std::vector<value_type>().swap(data);
+}
+
 }
@@ -0,0 +1,133 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "yagit/DataStructs.hpp"
+#include "yagit/ImageData.hpp"
+
+namespace yagit{
+
+/**
+ * @brief Non-owning read-only view of image stored in external buffer and its metadata (size, offset, spacing)
+ * 
+ * It allows to calculate gamma index and interpolate images that are stored in other containers
+ * (e.g. aligned buffers or NumPy/ITK arrays) without copying them to ImageData.
+ * ImageData (and GammaResult) is implicitly converted to ImageView without copying its data.
+ * 
+ * Elements of image can be separated by strides (e.g. view of a part of larger image or image with padded rows).
+ * Gamma index and interpolation functions need contiguous data, so they copy images with other strides
+ * once at the beginning - views of contiguous data are never copied.
+ * 
+ * @warning View doesn't own data, so buffer must outlive the view.
+ */
+class ImageView{
+public:
+    using value_type = ImageData::value_type;
+    using size_type = ImageData::size_type;
+    using const_reference = ImageData::const_reference;
+    using const_pointer = ImageData::const_pointer;
+
+    ImageView() = default;
+
+    /**
+     * @brief Create view of contiguous image stored in (frame, row, column) order
+     * @param data Pointer to the first element of image
+     */
+    ImageView(const_pointer data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing);
+
+    /**
+     * @brief Create view of image which elements are separated by @a strides
+     * @param data Pointer to the first element of image
+     * @param strides Distances between consecutive frames, rows, and columns in number of elements
+     */
+    ImageView(const_pointer data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+              const DataStrides& strides);
+
+    /// @brief Create view of the whole @a image (without copying its data)
+    ImageView(const ImageData& image) noexcept
+        : m_data(image.data()), m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()),
+          m_strides(contiguousStrides(image.getSize())) {}
+
+    DataSize getSize() const{
+        return m_size;
+    }
+    DataOffset getOffset() const{
+        return m_offset;
+    }
+    DataSpacing getSpacing() const{
+        return m_spacing;
+    }
+    DataStrides getStrides() const{
+        return m_strides;
+    }
+
+    /// @brief Number of elements of image (frames*rows*columns)
+    size_type size() const{
+        return static_cast<size_type>(m_size.frames) * m_size.rows * m_size.columns;
+    }
+
+    /// @brief Whether elements of image are stored contiguously in (frame, row, column) order
+    bool isContiguous() const{
+        return m_strides == contiguousStrides(m_size);
+    }
+
+    /// @brief Get image element at position (@a frame, @a row, @a column)
+    /// with checking that the position is within the valid range
+    const_reference at(uint32_t frame, uint32_t row, uint32_t column) const;
+
+    /// @brief Get image element at position (@a frame, @a row, @a column)
+    const_reference get(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_data[frame * m_strides.frames + row * m_strides.rows + column * m_strides.columns];
+    }
+
+    /// @brief Get element at @a index of flattened image
+    /// @warning It can be used only if view is contiguous
+    const_reference get(uint32_t index) const{
+        return m_data[index];
+    }
+
+    /// @brief Pointer to the first element of image
+    /// @warning Elements are stored contiguously only if view is contiguous
+    const_pointer data() const{
+        return m_data;
+    }
+
+    /// @brief Returns copy of flattened image
+    std::vector<value_type> getData() const;
+
+    /// @brief Returns copy of image
+    ImageData toImageData() const;
+
+private:
+    static DataStrides contiguousStrides(const DataSize& size){
+        return {static_cast<std::ptrdiff_t>(size.rows) * size.columns, static_cast<std::ptrdiff_t>(size.columns), 1};
+    }
+
+    const_pointer m_data{nullptr};
+
+    DataSize m_size{0, 0, 0};
+    DataOffset m_offset{0, 0, 0};
+    DataSpacing m_spacing{1, 1, 1};
+    DataStrides m_strides{0, 0, 1};
+};
+
+}
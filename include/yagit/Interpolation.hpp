@@ -21,7 +21,9 @@
 #include <optional>
 
 #include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
 #include "yagit/Image.hpp"
+#include "yagit/CompactImageData.hpp"
 
 namespace yagit::Interpolation{
 
@@ -33,7 +35,7 @@ namespace yagit::Interpolation{
  * @param axis Axis along which interpolation is performed
  * @return Interpolated image with new spacing
  */
-ImageData linearAlongAxis(const ImageData& img, float spacing, ImageAxis axis);
+ImageData linearAlongAxis(const ImageView& img, float spacing, ImageAxis axis);
 
 /**
  * @brief Linear interpolation along @a axis on new grid with @a offset and @a spacing
@@ -48,7 +50,7 @@ ImageData linearAlongAxis(const ImageData& img, float spacing, ImageAxis axis);
  * @param axis Axis along which interpolation is performed
  * @return Image interpolated on new grid
  */
-ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing, ImageAxis axis);
+ImageData linearAlongAxis(const ImageView& img, float gridOffset, float spacing, ImageAxis axis);
 
 /**
  * @brief Linear interpolation along @a axis on the grid of @a refImg.
@@ -61,7 +63,34 @@ ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing,
  * @param axis Axis along which interpolation is performed
  * @return Image interpolated on the grid of @a refImg
  */
-ImageData linearAlongAxis(const ImageData& targetImg, const ImageData& refImg, ImageAxis axis);
+ImageData linearAlongAxis(const ImageView& targetImg, const ImageView& refImg, ImageAxis axis);
+
+/**
+ * @brief Linear interpolation along Z axis of a single axial frame at @a z coordinate
+ * 
+ * It returns the frame at @a z of the image returned by linearAlongAxis(img, spacing, ImageAxis::Z)
+ * (the same formula is used, so values are equal up to rounding of Z coordinates),
+ * but it doesn't interpolate the whole image, so it can be used to process an image frame by frame.
+ * 
+ * @param img Image on which interpolation is performed
+ * @param z Z coordinate of the frame
+ * @param spacing Spacing along Z of the grid on which frames are interpolated
+ * @return If the frame is inside the image, then an interpolated 2D image with z-offset equal to @a z is returned
+ */
+std::optional<ImageData> linearFrameAtZ(const ImageView& img, float z, float spacing);
+
+/**
+ * @brief Linear interpolation along Z axis of a single axial frame at @a z coordinate of image stored in 16-bit format
+ * 
+ * It returns the same values as linearFrameAtZ(img.toImageData(), z, spacing), but only the two frames
+ * between which the frame at @a z lies are widened to float.
+ * 
+ * @param img Image on which interpolation is performed
+ * @param z Z coordinate of the frame
+ * @param spacing Spacing along Z of the grid on which frames are interpolated
+ * @return If the frame is inside the image, then an interpolated 2D image with z-offset equal to @a z is returned
+ */
+std::optional<ImageData> linearFrameAtZ(const CompactImageData& img, float z, float spacing);
 
 /**
  * @brief Bilinear interpolation on @a plane with new spacing
@@ -74,7 +103,7 @@ ImageData linearAlongAxis(const ImageData& targetImg, const ImageData& refImg, I
  * @param plane Plane on which interpolation is performed
  * @return Interpolated image with new spacing
  */
-ImageData bilinearOnPlane(const ImageData& img, float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane);
+ImageData bilinearOnPlane(const ImageView& img, float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane);
 
 /**
  * @brief Bilinear interpolation on @a plane on new grid with offset and spacing.
@@ -97,7 +126,7 @@ ImageData bilinearOnPlane(const ImageData& img, float firstAxisSpacing, float se
  * @param plane Plane on which interpolation is performed
  * @return Image interpolated on new grid
  */
-ImageData bilinearOnPlane(const ImageData& img, float firstAxisGridOffset, float secondAxisGridOffset,
+ImageData bilinearOnPlane(const ImageView& img, float firstAxisGridOffset, float secondAxisGridOffset,
                           float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane);
 
 /**
@@ -111,7 +140,7 @@ ImageData bilinearOnPlane(const ImageData& img, float firstAxisGridOffset, float
  * @param plane Plane on which interpolation is performed
  * @return Image interpolated on the grid of @a refImg
  */
-ImageData bilinearOnPlane(const ImageData& targetImg, const ImageData& refImg, ImagePlane plane);
+ImageData bilinearOnPlane(const ImageView& targetImg, const ImageView& refImg, ImagePlane plane);
 
 /**
  * @brief Trilinear interpolation - along all axes (Z, Y, X) - with new spacing
@@ -119,7 +148,7 @@ ImageData bilinearOnPlane(const ImageData& targetImg, const ImageData& refImg, I
  * @param spacing New spacing by which interpolation is performed
  * @return Interpolated image with new spacing
  */
-ImageData trilinear(const ImageData& img, const DataSpacing& spacing);
+ImageData trilinear(const ImageView& img, const DataSpacing& spacing);
 
 /**
  * @brief Trilinear interpolation - along all axes (Z, Y, X) - on new grid with @a offset and @a spacing.
@@ -132,7 +161,7 @@ ImageData trilinear(const ImageData& img, const DataSpacing& spacing);
  * @param spacing New spacing by which interpolation is performed
  * @return Image interpolated on new grid
  */
-ImageData trilinear(const ImageData& img, const DataOffset& gridOffset, const DataSpacing& spacing);
+ImageData trilinear(const ImageView& img, const DataOffset& gridOffset, const DataSpacing& spacing);
 
 /**
  * @brief Trilinear interpolation - along all axes (Z, Y, X) - on the grid of @a refImg.
@@ -144,7 +173,7 @@ ImageData trilinear(const ImageData& img, const DataOffset& gridOffset, const Da
  * @param refImg Image from which offset and spacing is retrieved and used to create grid on which interpolation is performed
  * @return Image interpolated on the grid of @a refImg
  */
-ImageData trilinear(const ImageData& targetImg, const ImageData& refImg);
+ImageData trilinear(const ImageView& targetImg, const ImageView& refImg);
 
 /**
  * @brief Bilinear interpolation at point inside image
@@ -155,7 +184,7 @@ ImageData trilinear(const ImageData& targetImg, const ImageData& refImg);
  * @param x X coordinate of the point where interpolation is performed
  * @return If the point is inside the image, then an interpolated value is returned
  */
-std::optional<float> bilinearAtPoint(const ImageData& img, uint32_t frame, float y, float x);
+std::optional<float> bilinearAtPoint(const ImageView& img, uint32_t frame, float y, float x);
 
 /**
  * @brief Trilinear interpolation at point inside image
@@ -166,6 +195,6 @@ std::optional<float> bilinearAtPoint(const ImageData& img, uint32_t frame, float
  * @param x X coordinate of the point where interpolation is performed
  * @return If the point is inside the image, then an interpolated value is returned
  */
-std::optional<float> trilinearAtPoint(const ImageData& img, float z, float y, float x);
+std::optional<float> trilinearAtPoint(const ImageView& img, float z, float y, float x);
 
 }
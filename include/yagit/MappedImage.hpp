@@ -0,0 +1,133 @@
+/********************************************************************************************
+ * Copyright (C) 2023-2024 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <string>
+
+#include "yagit/DataStructs.hpp"
+#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+
+namespace yagit{
+
+/**
+ * @brief Read-only image which data is memory-mapped from a file and its metadata (size, offset, spacing)
+ * 
+ * Creating the image doesn't read its data - pages of the file are loaded lazily by the operating system
+ * when they are accessed for the first time, so even multi-GB files are opened almost instantly.
+ * MappedImage is implicitly converted to ImageView, so it can be passed directly
+ * to gamma index and interpolation functions without copying its data.
+ * 
+ * Image can also own data read into memory (see DataReader::mapMetaImage, which falls back to it
+ * for files that can't be mapped), so it can be used in the same way regardless of where its data is stored.
+ * 
+ * @note Mapped file shouldn't be modified while the image exists.
+ */
+class MappedImage{
+public:
+    using value_type = ImageData::value_type;
+    using size_type = ImageData::size_type;
+    using const_reference = ImageData::const_reference;
+    using const_pointer = ImageData::const_pointer;
+
+    MappedImage() = default;
+
+    /**
+     * @brief Map file containing image stored as floats in system byte order
+     * @param filepath File path to file containing image
+     * @param dataOffset Position of the first element of image in the file (in bytes)
+     * @throw std::invalid_argument if @a dataOffset isn't a multiple of float alignment
+     * @throw std::runtime_error if file cannot be mapped or it is too small to contain the image
+     */
+    MappedImage(const std::string& filepath, size_t dataOffset,
+                const DataSize& size, const DataOffset& offset, const DataSpacing& spacing);
+
+    /// @brief Create image owning @a image that is already stored in memory
+    explicit MappedImage(ImageData&& image) noexcept;
+
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    MappedImage(MappedImage&& other) noexcept;
+    MappedImage& operator=(MappedImage&& other) noexcept;
+
+    ~MappedImage();
+
+    DataSize getSize() const{
+        return m_size;
+    }
+    DataOffset getOffset() const{
+        return m_offset;
+    }
+    DataSpacing getSpacing() const{
+        return m_spacing;
+    }
+
+    /// @brief Whether data of image is memory-mapped from a file (otherwise it is owned by the image)
+    bool isMapped() const{
+        return m_mapping != nullptr;
+    }
+
+    /// @brief Number of elements of image (frames*rows*columns)
+    size_type size() const{
+        return static_cast<size_type>(m_size.frames) * m_size.rows * m_size.columns;
+    }
+
+    /// @brief Get image element at position (@a frame, @a row, @a column)
+    const_reference get(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_data[(frame * m_size.rows + row) * m_size.columns + column];
+    }
+
+    /// @brief Get element at @a index of flattened image
+    const_reference get(uint32_t index) const{
+        return m_data[index];
+    }
+
+    /// @brief Pointer to the first element of image
+    const_pointer data() const{
+        return m_data;
+    }
+
+    /// @brief Returns view of the whole image (without copying its data)
+    ImageView view() const{
+        return ImageView(m_data, m_size, m_offset, m_spacing);
+    }
+
+    operator ImageView() const{
+        return view();
+    }
+
+    /// @brief Returns copy of image
+    ImageData toImageData() const;
+
+private:
+    void unmap() noexcept;
+
+    void* m_mapping{nullptr};
+    size_t m_mappingSize{0};
+    ImageData m_ownedData;
+
+    const_pointer m_data{nullptr};
+
+    DataSize m_size{0, 0, 0};
+    DataOffset m_offset{0, 0, 0};
+    DataSpacing m_spacing{1, 1, 1};
+};
+
+}
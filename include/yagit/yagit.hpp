@@ -18,9 +18,13 @@
  ********************************************************************************************/
 #pragma once
 
+#include "yagit/AlignedAllocator.hpp"
 #include "yagit/DataStructs.hpp"
 #include "yagit/Image.hpp"
 #include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/MappedImage.hpp"
 #include "yagit/GammaResult.hpp"
 
 #include "yagit/GammaParameters.hpp"
@@ -20,6 +20,8 @@ set SIMD_EXTENSION=DEFAULT
 
 set ENABLE_FMA=OFF
 
+set ENABLE_WENDLING_SIMD=OFF
+
 set BUILD_EXAMPLES=OFF
 set BUILD_TESTING=OFF
 set BUILD_PERFORMANCE_TESTING=OFF
@@ -89,6 +91,7 @@ cmake .. -DCMAKE_BUILD_TYPE=%BUILD_TYPE% ^
          -DGAMMA_VERSION=%GAMMA_VERSION% ^
          -DSIMD_EXTENSION=%SIMD_EXTENSION% ^
          -DENABLE_FMA=%ENABLE_FMA% ^
+         -DENABLE_WENDLING_SIMD=%ENABLE_WENDLING_SIMD% ^
          -DBUILD_EXAMPLES=%BUILD_EXAMPLES% ^
          -DBUILD_TESTING=%BUILD_TESTING% ^
          -DBUILD_PERFORMANCE_TESTING=%BUILD_PERFORMANCE_TESTING% ^
@@ -18,6 +18,8 @@ SIMD_EXTENSION=DEFAULT
 
 ENABLE_FMA=OFF
 
+ENABLE_WENDLING_SIMD=OFF
+
 BUILD_EXAMPLES=OFF
 BUILD_TESTING=OFF
 BUILD_PERFORMANCE_TESTING=OFF
@@ -115,6 +117,7 @@ cmake .. -DCMAKE_BUILD_TYPE=$BUILD_TYPE \
          -DGAMMA_VERSION=$GAMMA_VERSION \
          -DSIMD_EXTENSION=$SIMD_EXTENSION \
          -DENABLE_FMA=$ENABLE_FMA \
+         -DENABLE_WENDLING_SIMD=$ENABLE_WENDLING_SIMD \
          -DBUILD_EXAMPLES=$BUILD_EXAMPLES \
          -DBUILD_TESTING=$BUILD_TESTING \
          -DBUILD_PERFORMANCE_TESTING=$BUILD_PERFORMANCE_TESTING \
@@ -0,0 +1,143 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/CompactImageData.hpp"
+
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+#include "HalfFloat.hpp"
+
+namespace yagit{
+
+namespace{
+constexpr double UInt16Max = 65535;
+
+// the same conversion as in DataReader::readRTDoseDicom, so widened values of RT Dose are identical
+float scaledToFloat(uint16_t value, double scaling){
+    return static_cast<float>(static_cast<double>(value) * scaling);
+}
+
+void widen(const uint16_t* begin, const uint16_t* end, float* output, CompactFormat format, double scaling){
+    if(format == CompactFormat::Float16){
+        halfToFloat(begin, end, output);
+    }
+    else if(format == CompactFormat::BFloat16){
+        bfloat16ToFloat(begin, end, output);
+    }
+    else{
+        for(; begin < end; begin++, output++){
+            *output = scaledToFloat(*begin, scaling);
+        }
+    }
+}
+
+// scaling factor of UInt16 format, so that the maximum value of image is stored as the maximum integer
+double uint16Scaling(const ImageView& image){
+    float maxValue = 0;
+    for(uint32_t k = 0; k < image.getSize().frames; k++){
+        for(uint32_t j = 0; j < image.getSize().rows; j++){
+            for(uint32_t i = 0; i < image.getSize().columns; i++){
+                const float value = image.get(k, j, i);
+                if(!(value >= 0) || std::isinf(value)){
+                    throw std::invalid_argument("UInt16 format can't store negative, infinite or NaN values");
+                }
+                maxValue = std::max(maxValue, value);
+            }
+        }
+    }
+    return maxValue > 0 ? maxValue / UInt16Max : 1;
+}
+}
+
+CompactImageData::CompactImageData(const ImageView& image, CompactFormat format, const allocator_type& allocator)
+    : m_data(allocator), m_format(format),
+      m_scaling(format == CompactFormat::UInt16 ? uint16Scaling(image) : 1),
+      m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()) {
+    m_data.reserve(image.size());
+    for(uint32_t k = 0; k < m_size.frames; k++){
+        for(uint32_t j = 0; j < m_size.rows; j++){
+            for(uint32_t i = 0; i < m_size.columns; i++){
+                const float value = image.get(k, j, i);
+                if(format == CompactFormat::Float16){
+                    m_data.push_back(floatToHalf(value));
+                }
+                else if(format == CompactFormat::BFloat16){
+                    m_data.push_back(floatToBFloat16(value));
+                }
+                else{
+                    const double quantized = std::round(static_cast<double>(value) / m_scaling);
+                    m_data.push_back(static_cast<uint16_t>(std::min(quantized, UInt16Max)));
+                }
+            }
+        }
+    }
+}
+
+CompactImageData::CompactImageData(container_type&& data, CompactFormat format,
+                                   const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+                                   double scaling)
+    : m_data(std::move(data)), m_format(format), m_scaling(format == CompactFormat::UInt16 ? scaling : 1),
+      m_size(size), m_offset(offset), m_spacing(spacing) {
+    if(spacing.frames <= 0 || spacing.rows <= 0 || spacing.columns <= 0){
+        throw std::invalid_argument("spacing should be greater than 0");
+    }
+    if(!(m_scaling > 0) || std::isinf(m_scaling)){
+        throw std::invalid_argument("scaling should be greater than 0");
+    }
+    if(m_data.size() != static_cast<size_t>(size.frames) * size.rows * size.columns){
+        throw std::invalid_argument("size is inconsistent with data size information");
+    }
+}
+
+CompactImageData::value_type CompactImageData::get(uint32_t index) const{
+    if(m_format == CompactFormat::Float16){
+        return halfToFloat(m_data[index]);
+    }
+    else if(m_format == CompactFormat::BFloat16){
+        return bfloat16ToFloat(m_data[index]);
+    }
+    return scaledToFloat(m_data[index], m_scaling);
+}
+
+ImageData CompactImageData::toImageData() const{
+    ImageData::container_type data(m_data.size());
+    widen(m_data.data(), m_data.data() + m_data.size(), data.data(), m_format, m_scaling);
+    return ImageData(std::move(data), m_size, m_offset, m_spacing);
+}
+
+ImageData::container_type CompactImageData::readFrames(uint32_t frameBegin, uint32_t nrOfFrames) const{
+    if(frameBegin > m_size.frames || nrOfFrames > m_size.frames - frameBegin){
+        throw std::out_of_range("frames out of range");
+    }
+    const size_t frameSize = static_cast<size_t>(m_size.rows) * m_size.columns;
+    const uint16_t* begin = m_data.data() + frameBegin * frameSize;
+    ImageData::container_type frames(nrOfFrames * frameSize);
+    widen(begin, begin + frames.size(), frames.data(), m_format, m_scaling);
+    return frames;
+}
+
+StreamedImage CompactImageData::streamed() const{
+    return StreamedImage{m_size, m_offset, m_spacing, [this](uint32_t frameBegin, uint32_t nrOfFrames){
+        return readFrames(frameBegin, nrOfFrames);
+    }};
+}
+
+}
@@ -0,0 +1,53 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include "yagit/ImageView.hpp"
+
+namespace yagit{
+
+// view of image with contiguous data - if image isn't contiguous, its copy is stored and viewed.
+// It is used at the beginning of functions that index data of image linearly:
+//   return func(ContiguousImage(img), ...);
+// (temporary lives until the end of call, and it is converted to const ImageView&)
+class ContiguousImage{
+public:
+    explicit ContiguousImage(const ImageView& img)
+        : m_view(img){
+        if(!img.isContiguous()){
+            m_data = img.toImageData();
+            m_view = m_data;
+        }
+    }
+
+    // view points to data of this object, so it can't be copied nor moved
+    ContiguousImage(const ContiguousImage&) = delete;
+    ContiguousImage& operator=(const ContiguousImage&) = delete;
+
+    operator const ImageView&() const{
+        return m_view;
+    }
+
+private:
+    ImageData m_data;
+    ImageView m_view;
+};
+
+}
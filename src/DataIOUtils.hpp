@@ -0,0 +1,81 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#ifdef ENABLE_PARALLEL_IO
+#include <thread>
+#include <atomic>
+#include <exception>
+#endif
+
+namespace yagit{
+
+namespace{
+// zlib takes sizes as 32-bit integers, so larger buffers are processed in parts
+constexpr size_t ZlibMaxChunkSize = size_t{1} << 30;
+// compressed data is read in blocks of this size and written as independently compressed blocks of this size
+constexpr size_t CompressedBlockSize = size_t{1} << 20;
+
+// calls func(i) for each i in [0, nrOfTasks),
+// when yagit is built with threads, tasks are distributed dynamically between threads
+// and the first exception thrown by any task is rethrown after all threads are joined
+template<typename Function>
+void forEachInParallel(size_t nrOfTasks, Function&& func){
+#ifdef ENABLE_PARALLEL_IO
+    const size_t nrOfThreads = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), nrOfTasks);
+    if(nrOfThreads > 1){  // multi-threaded
+        std::atomic<size_t> nextTask{0};
+        std::vector<std::exception_ptr> exceptions(nrOfThreads);
+
+        std::vector<std::thread> threads;
+        threads.reserve(nrOfThreads);
+        for(size_t t = 0; t < nrOfThreads; t++){
+            threads.emplace_back([nrOfTasks, &func, &nextTask, &exception = exceptions[t]](){
+                try{
+                    for(size_t i = nextTask++; i < nrOfTasks; i = nextTask++){
+                        func(i);
+                    }
+                }
+                catch(...){
+                    exception = std::current_exception();
+                }
+            });
+        }
+        for(auto& thread : threads){
+            thread.join();
+        }
+        for(const auto& exception : exceptions){
+            if(exception){
+                std::rethrow_exception(exception);
+            }
+        }
+        return;
+    }
+#endif
+    for(size_t i = 0; i < nrOfTasks; i++){  // single-threaded
+        func(i);
+    }
+}
+}
+
+}
@@ -20,12 +20,24 @@
 #include "yagit/DataReader.hpp"
 
 #include <fstream>
+#include <istream>
+#include <streambuf>
 #include <optional>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <filesystem>
+#include <cmath>
+#include <cstring>
 
 #include <gdcmReader.h>
 #include <gdcmAttribute.h>
 #include <gdcmTagKeywords.h>
 #include <gdcmByteSwap.h>
+#include <gdcm_zlib.h>
+
+#include "DataIOUtils.hpp"
 
 namespace yagit::DataReader{
 
@@ -82,14 +94,17 @@ std::vector<typename gdcm::Attribute<G, E>::ArrayType> getMultipleValues(const g
     return {&attr.GetValue(0), &attr.GetValue(attr.GetNumberOfValues()-1) + 1};
 }
 
-std::vector<char> getPixelData(const gdcm::DataSet& ds){
+// returns pointer to pixel data and its size in bytes (without copying, so it is valid as long as data set exists)
+std::pair<const char*, size_t> getPixelData(const gdcm::DataSet& ds){
     if(!ds.FindDataElement(PixelDataTag)){
-        return {};
+        return {nullptr, 0};
     }
     const gdcm::DataElement& data = ds.GetDataElement(PixelDataTag);
-    uint32_t dataLength = data.GetVL();
-    const char* dataPtr = data.GetByteValue()->GetPointer();
-    return std::vector<char>(dataPtr, dataPtr + dataLength);
+    const gdcm::ByteValue* byteValue = data.GetByteValue();
+    if(byteValue == nullptr){
+        return {nullptr, 0};
+    }
+    return {byteValue->GetPointer(), static_cast<uint32_t>(data.GetVL())};
 }
 
 template<typename T>
@@ -115,17 +130,90 @@ gdcm::SwapCode getDataEndianness(const std::optional<gdcm::UIComp>& transferSynt
 double roundTo5DecimalPlaces(double number){
     return std::round(number * 1e5) / 1e5;
 }
+
+// read-only stream buffer over memory, so that data in memory can be read as a stream without copying it
+class MemoryStreamBuffer : public std::streambuf{
+public:
+    MemoryStreamBuffer(const char* data, size_t size){
+        char* begin = const_cast<char*>(data);  // data is never modified, because buffer has no put area
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override{
+        if(!(which & std::ios_base::in)){
+            return pos_type(off_type(-1));
+        }
+        off_type base = 0;
+        if(dir == std::ios_base::cur){
+            base = gptr() - eback();
+        }
+        else if(dir == std::ios_base::end){
+            base = egptr() - eback();
+        }
+        const off_type position = base + offset;
+        if(position < 0 || position > egptr() - eback()){
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + position, egptr());
+        return pos_type(position);
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override{
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
 }
 
-ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo){
-    gdcm::Reader reader;
-    reader.SetFileName(filepath.c_str());
-    if(!reader.Read()) {
+namespace{
+// convert uint pixel data to float dose data
+// dose = float(double(PixelData) * double(DoseGridScaling))
+// Dose is float, because there is little difference between double and float doses.
+// And in gamma calculations, this difference has little significance.
+// Thanks to this, the data takes up less memory and calculations are performed faster.
+// Loop has no branches and pixel data can't alias dose data, so compiler vectorizes it.
+template<typename T>
+void convertPixelDataToDoseData(const char* pixelData, size_t dataSize, double doseGridScaling, float* doseData){
+    const T* dataPtr = reinterpret_cast<const T*>(pixelData);
+    for(size_t i = 0; i < dataSize; i++){
+        doseData[i] = static_cast<float>(static_cast<double>(dataPtr[i]) * doseGridScaling);
+    }
+}
+
+// pixel data of RT Dose and its info read from DICOM file (after validation of its attributes)
+struct RTDose{
+    std::unique_ptr<gdcm::Reader> reader;  // owns pixel data
+    const char* pixelData;
+    size_t pixelDataBytes;
+    uint16_t bitsAllocated;
+    double doseGridScaling;
+    DataSize size;
+    DataOffset offset;
+    DataSpacing spacing;
+};
+
+std::unique_ptr<gdcm::Reader> readDicom(const std::string& filepath){
+    auto reader = std::make_unique<gdcm::Reader>();
+    reader->SetFileName(filepath.c_str());
+    if(!reader->Read()) {
         throw std::runtime_error("cannot read " + filepath + " file");
     }
+    return reader;
+}
+
+// stream is used only while reading, after that all data is owned by reader
+std::unique_ptr<gdcm::Reader> readDicom(std::istream& stream){
+    auto reader = std::make_unique<gdcm::Reader>();
+    reader->SetStream(stream);
+    if(!reader->Read()) {
+        throw std::runtime_error("cannot read DICOM data from stream");
+    }
+    return reader;
+}
 
-    const gdcm::DataSet& header = reader.GetFile().GetHeader();
-    const gdcm::DataSet& ds = reader.GetFile().GetDataSet();
+RTDose readRTDose(std::unique_ptr<gdcm::Reader> reader, bool displayInfo){
+    const gdcm::DataSet& header = reader->GetFile().GetHeader();
+    const gdcm::DataSet& ds = reader->GetFile().GetDataSet();
 
     auto sopClassUID = getValue(ds, SOPClassUIDAttr);
     if(sopClassUID == std::nullopt || *sopClassUID != RTDoseSOPClassUID){
@@ -233,9 +321,9 @@ ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo){
         throw std::runtime_error("DICOM file doesn't have attribute Pixel Representation (0028,0103) equal to 0");
     }
 
-    std::vector<char> pixelData = getPixelData(ds);
+    const auto [pixelData, pixelDataBytes] = getPixelData(ds);
     uint32_t correctDataSizeBytes = frames.value() * rows.value() * columns.value() * bitsAllocated.value() / 8;
-    if(pixelData.size() != correctDataSizeBytes){
+    if(pixelDataBytes != correctDataSizeBytes){
         throw std::runtime_error("DICOM file doesn't have attribute Pixel Data (7FE0,0010) containing " +
                                  std::to_string(correctDataSizeBytes) + " bytes of data");
     }
@@ -273,30 +361,7 @@ ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo){
                   << "BitsStored: " << *bitsStored << "\n"
                   << "HighBit: " << *highBit << "\n"
                   << "PixelRepresentation: " << *pixelRepresentation << "\n";
-        std::cout << "PixelData: array of " << pixelData.size() << " bytes\n";
-    }
-
-
-    std::vector<float> doseData;
-    const size_t doseDataSize = pixelData.size() / (*bitsAllocated / 8);  // number of elements
-    doseData.reserve(doseDataSize);
-
-    // convert uint pixelData to float doseData
-    // dose = float(double(PixelData) * double(DoseGridScaling))
-    // Dose is float, because there is little difference between double and float doses.
-    // And in gamma calculations, this difference has little significance.
-    // Thanks to this, the data takes up less memory and calculations are performed faster.
-    if(*bitsAllocated == 32){
-        const uint32_t* dataPtr = reinterpret_cast<const uint32_t*>(pixelData.data());
-        for(size_t i=0; i < doseDataSize; i++, dataPtr++){
-            doseData.emplace_back(static_cast<float>(static_cast<double>(*dataPtr) * doseGridScaling.value()));
-        }
-    }
-    else if(*bitsAllocated == 16){
-        const uint16_t* dataPtr = reinterpret_cast<const uint16_t*>(pixelData.data());
-        for(size_t i=0; i < doseDataSize; i++, dataPtr++){
-            doseData.emplace_back(static_cast<float>(static_cast<double>(*dataPtr) * doseGridScaling.value()));
-        }
+        std::cout << "PixelData: array of " << pixelDataBytes << " bytes\n";
     }
 
     DataSize size{static_cast<uint32_t>(*frames),
@@ -309,7 +374,190 @@ ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo){
                         static_cast<float>(pixelSpacing[0]),
                         static_cast<float>(pixelSpacing[1])};
 
-    return ImageData(std::move(doseData), size, offset, spacing);
+    return RTDose{std::move(reader), pixelData, pixelDataBytes, *bitsAllocated, *doseGridScaling, size, offset, spacing};
+}
+
+// converts pixel data of RT Dose to doses (dose data must have space for all elements)
+void convertRTDoseToDoseData(const RTDose& rtDose, float* doseData){
+    const size_t doseDataSize = rtDose.pixelDataBytes / (rtDose.bitsAllocated / 8);
+    if(rtDose.bitsAllocated == 32){
+        convertPixelDataToDoseData<uint32_t>(rtDose.pixelData, doseDataSize, rtDose.doseGridScaling, doseData);
+    }
+    else if(rtDose.bitsAllocated == 16){
+        convertPixelDataToDoseData<uint16_t>(rtDose.pixelData, doseDataSize, rtDose.doseGridScaling, doseData);
+    }
+}
+
+RTDose readRTDose(const std::string& filepath, bool displayInfo){
+    return readRTDose(readDicom(filepath), displayInfo);
+}
+
+ImageData rtDoseToImageData(const RTDose& rtDose){
+    // pixel data is converted directly from buffer of gdcm to doses, without intermediate copies
+    const size_t doseDataSize = rtDose.pixelDataBytes / (rtDose.bitsAllocated / 8);  // number of elements
+    ImageData::container_type doseData(doseDataSize);
+    convertRTDoseToDoseData(rtDose, doseData.data());
+
+    return ImageData(std::move(doseData), rtDose.size, rtDose.offset, rtDose.spacing);
+}
+}
+
+ImageData readRTDoseDicom(const std::string& filepath, bool displayInfo){
+    return rtDoseToImageData(readRTDose(filepath, displayInfo));
+}
+
+ImageData readRTDoseDicom(std::istream& stream, bool displayInfo){
+    return rtDoseToImageData(readRTDose(readDicom(stream), displayInfo));
+}
+
+ImageData readRTDoseDicomFromBuffer(const char* data, size_t size, bool displayInfo){
+    MemoryStreamBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    return readRTDoseDicom(stream, displayInfo);
+}
+
+CompactImageData readRTDoseDicomCompact(const std::string& filepath, bool displayInfo){
+    const RTDose rtDose = readRTDose(filepath, displayInfo);
+    if(rtDose.bitsAllocated != 16){
+        throw std::runtime_error("DICOM file with attribute Bits Allocated (0028,0100) equal to " +
+                                 std::to_string(rtDose.bitsAllocated) + " can't be stored in 16-bit integers");
+    }
+
+    // pixel data is kept as it is, and Dose Grid Scaling is applied when values are read
+    const uint16_t* dataPtr = reinterpret_cast<const uint16_t*>(rtDose.pixelData);
+    CompactImageData::container_type data(dataPtr, dataPtr + rtDose.pixelDataBytes / sizeof(uint16_t));
+    return CompactImageData(std::move(data), CompactFormat::UInt16, rtDose.size, rtDose.offset, rtDose.spacing,
+                            rtDose.doseGridScaling);
+}
+
+namespace{
+// reads RT Doses from all files, when yagit is built with threads, files are read in parallel
+// (except when info is displayed, so that info of consecutive files isn't mixed)
+std::vector<RTDose> readRTDoses(const std::vector<std::string>& filepaths, bool displayInfo){
+    if(filepaths.empty()){
+        throw std::invalid_argument("list of files is empty");
+    }
+
+    std::vector<RTDose> rtDoses(filepaths.size());
+    if(displayInfo){
+        for(size_t i = 0; i < filepaths.size(); i++){
+            std::cout << "File: " << filepaths[i] << "\n";
+            rtDoses[i] = readRTDose(filepaths[i], displayInfo);
+        }
+    }
+    else{
+        forEachInParallel(filepaths.size(), [&rtDoses, &filepaths](size_t i){
+            rtDoses[i] = readRTDose(filepaths[i], false);
+        });
+    }
+    return rtDoses;
+}
+
+// add doses of elements [begin, begin + count) of pixel data to sum
+template<typename T>
+void addPixelDataToDoseSum(const char* pixelData, size_t begin, size_t count, double doseGridScaling, double* doseSum){
+    const T* dataPtr = reinterpret_cast<const T*>(pixelData) + begin;
+    for(size_t i = 0; i < count; i++){
+        doseSum[i] += static_cast<double>(dataPtr[i]) * doseGridScaling;
+    }
+}
+
+// number of elements summed at once - sums of block fit in L1 cache
+constexpr size_t SumBlockSize = 4096;
+}
+
+ImageData readRTDoseDicomSeries(const std::vector<std::string>& filepaths, bool displayInfo){
+    std::vector<RTDose> rtDoses = readRTDoses(filepaths, displayInfo);
+    std::stable_sort(rtDoses.begin(), rtDoses.end(), [](const RTDose& a, const RTDose& b){
+        return a.offset.frames < b.offset.frames;
+    });
+
+    const RTDose& first = rtDoses.front();
+    std::optional<float> frameSpacing;
+    uint32_t nrOfFrames = 0;
+    for(const auto& rtDose : rtDoses){
+        if(rtDose.size.rows != first.size.rows || rtDose.size.columns != first.size.columns){
+            throw std::runtime_error("RT Dose files have different number of rows or columns");
+        }
+        if(rtDose.offset.rows != first.offset.rows || rtDose.offset.columns != first.offset.columns){
+            throw std::runtime_error("RT Dose files have different Image Position Patient (0020,0032) in x or y");
+        }
+        if(rtDose.spacing.rows != first.spacing.rows || rtDose.spacing.columns != first.spacing.columns){
+            throw std::runtime_error("RT Dose files have different Pixel Spacing (0028,0030)");
+        }
+        if(rtDose.size.frames > 1){
+            if(frameSpacing.has_value() && *frameSpacing != rtDose.spacing.frames){
+                throw std::runtime_error("RT Dose files have different spacing between frames");
+            }
+            frameSpacing = rtDose.spacing.frames;
+        }
+        nrOfFrames += rtDose.size.frames;
+    }
+    if(!frameSpacing.has_value()){
+        // all files have one frame
+        frameSpacing = rtDoses.size() > 1 ? rtDoses[1].offset.frames - first.offset.frames : first.spacing.frames;
+    }
+    if(rtDoses.size() > 1 && *frameSpacing <= 0){
+        throw std::runtime_error("RT Dose files have frames at the same position");
+    }
+
+    // consecutive files must continue frames of previous files (with tolerance for rounding of positions)
+    const float tolerance = 1e-3f * *frameSpacing;
+    uint32_t frameIndex = 0;
+    std::vector<size_t> dataIndices(rtDoses.size());
+    for(size_t i = 0; i < rtDoses.size(); i++){
+        const float expectedPosition = first.offset.frames + static_cast<float>(frameIndex) * *frameSpacing;
+        if(std::abs(rtDoses[i].offset.frames - expectedPosition) > tolerance){
+            throw std::runtime_error("uneven spacing between frames of RT Dose files not supported");
+        }
+        dataIndices[i] = static_cast<size_t>(frameIndex) * first.size.rows * first.size.columns;
+        frameIndex += rtDoses[i].size.frames;
+    }
+
+    // pixel data of each file is converted directly into its frames of volume
+    ImageData::container_type doseData(static_cast<size_t>(nrOfFrames) * first.size.rows * first.size.columns);
+    forEachInParallel(rtDoses.size(), [&rtDoses, &dataIndices, &doseData](size_t i){
+        convertRTDoseToDoseData(rtDoses[i], doseData.data() + dataIndices[i]);
+    });
+
+    DataSize size{nrOfFrames, first.size.rows, first.size.columns};
+    DataSpacing spacing{*frameSpacing, first.spacing.rows, first.spacing.columns};
+    return ImageData(std::move(doseData), size, first.offset, spacing);
+}
+
+ImageData readRTDoseDicomSum(const std::vector<std::string>& filepaths, bool displayInfo){
+    const std::vector<RTDose> rtDoses = readRTDoses(filepaths, displayInfo);
+
+    const RTDose& first = rtDoses.front();
+    for(const auto& rtDose : rtDoses){
+        if(rtDose.size != first.size || rtDose.offset != first.offset || rtDose.spacing != first.spacing){
+            throw std::runtime_error("RT Dose files have different size, offset or spacing");
+        }
+    }
+
+    // doses of all files are summed in one pass over blocks of elements,
+    // so doses of single files aren't stored and each pixel data is read once
+    const size_t doseDataSize = static_cast<size_t>(first.size.frames) * first.size.rows * first.size.columns;
+    const size_t nrOfBlocks = (doseDataSize + SumBlockSize - 1) / SumBlockSize;
+    ImageData::container_type doseData(doseDataSize);
+    forEachInParallel(nrOfBlocks, [&rtDoses, &doseData, doseDataSize](size_t block){
+        const size_t begin = block * SumBlockSize;
+        const size_t count = std::min(SumBlockSize, doseDataSize - begin);
+        double doseSum[SumBlockSize]{};
+        for(const auto& rtDose : rtDoses){
+            if(rtDose.bitsAllocated == 32){
+                addPixelDataToDoseSum<uint32_t>(rtDose.pixelData, begin, count, rtDose.doseGridScaling, doseSum);
+            }
+            else if(rtDose.bitsAllocated == 16){
+                addPixelDataToDoseSum<uint16_t>(rtDose.pixelData, begin, count, rtDose.doseGridScaling, doseSum);
+            }
+        }
+        for(size_t i = 0; i < count; i++){
+            doseData[begin + i] = static_cast<float>(doseSum[i]);
+        }
+    });
+
+    return ImageData(std::move(doseData), first.size, first.offset, first.spacing);
 }
 
 namespace{
@@ -327,8 +575,10 @@ const std::string TransformMatrixTag{"TransformMatrix"};
 const std::string BinaryDataTag{"BinaryData"};
 const std::string BinaryDataByteOrderMSBTag{"BinaryDataByteOrderMSB"};
 const std::string CompressedDataTag{"CompressedData"};
+const std::string CompressedDataSizeTag{"CompressedDataSize"};
 const std::string ElementTypeTag{"ElementType"};
 const std::string ElementDataFileTag{"ElementDataFile"};
+const std::string HeaderSizeTag{"HeaderSize"};
 
 const std::string AsciiCharType{"MET_ASCII_CHAR_TYPE"};
 const std::string CharType{"MET_CHAR"};
@@ -346,12 +596,15 @@ const std::string DoubleType{"MET_DOUBLE"};
 }
 
 namespace{
+// pixel data doesn't have to be aligned (e.g. when it is converted directly from buffer given by user),
+// so elements are copied with memcpy, which compiler replaces with unaligned loads
 template <typename T>
-void convertPixelDataToFloatData(const std::vector<char>& pixelData, std::vector<float>& floatData){
-    const T* dataPtr = reinterpret_cast<const T*>(pixelData.data());
-    const size_t dataSize = pixelData.size() / sizeof(T);
-    for(size_t i=0; i < dataSize; i++, dataPtr++){
-        floatData.emplace_back(static_cast<float>(*dataPtr));
+void convertPixelDataToFloatData(const char* pixelData, size_t bytes, ImageData::container_type& floatData){
+    const size_t dataSize = bytes / sizeof(T);
+    for(size_t i=0; i < dataSize; i++){
+        T value;
+        std::memcpy(&value, pixelData + i * sizeof(T), sizeof(T));
+        floatData.emplace_back(static_cast<float>(value));
     }
 }
 
@@ -390,19 +643,62 @@ void swapBytes64(std::vector<char>& data){
 }
 }
 
-ImageData readMetaImage(const std::string& filepath, bool displayInfo){
-    std::ifstream file(filepath, std::ios::binary);
-    if(!file.is_open()){
-        throw std::runtime_error("cannot read " + filepath + " file");
+namespace{
+// name of data file from pattern like slice%03d.raw (only one integer conversion with optional width is allowed)
+std::string formatDataFileName(const std::string& pattern, int64_t number){
+    const size_t percentPos = pattern.find('%');
+    size_t pos = percentPos + 1;
+    const bool zeroPadding = (pos < pattern.size() && pattern[pos] == '0');
+    size_t width = 0;
+    for(; pos < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[pos])); pos++){
+        width = width * 10 + (pattern[pos] - '0');
+    }
+    if(pos >= pattern.size() || pattern[pos] != 'd' || pattern.find('%', pos) != std::string::npos){
+        throw std::runtime_error("pattern of data files " + pattern + " doesn't have exactly one %d conversion");
     }
 
-    DataSize size{};
-    DataOffset offset{};
-    DataSpacing spacing{};
+    std::string numberStr = std::to_string(number);
+    if(numberStr.size() < width){
+        numberStr.insert(number < 0 ? 1 : 0, width - numberStr.size(), zeroPadding ? '0' : ' ');
+    }
+    return pattern.substr(0, percentPos) + numberStr + pattern.substr(pos + 1);
+}
+
+// ElementDataFile is either name of data file or pattern of names with range of numbers (pattern min max step)
+std::vector<std::string> dataFilesFromPattern(const std::string& value){
+    std::istringstream ss(value);
+    std::string pattern;
+    int64_t min{}, max{}, step{};
+    if(value.find('%') == std::string::npos || !(ss >> pattern >> min >> max >> step)){
+        return {value};
+    }
+    if(step == 0 || (max - min) / step < 0){
+        throw std::runtime_error("range of data files " + value + " is invalid");
+    }
+
+    std::vector<std::string> dataFiles;
+    for(int64_t i = min; (step > 0 ? i <= max : i >= max); i += step){
+        dataFiles.push_back(formatDataFileName(pattern, i));
+    }
+    return dataFiles;
+}
 
+struct MetaImageHeader{
+    DataSize size;
+    DataOffset offset;
+    DataSpacing spacing;
     gdcm::SwapCode dataEndianness = gdcm::SwapCode::LittleEndian;
     uint32_t typeBytesSize = 1;
-    std::string type{""};
+    std::string type;
+    bool compressed = false;
+    size_t compressedDataSize = 0;  // 0 if it is unknown
+    std::vector<std::string> dataFiles;  // empty if data is stored in the same file as header (LOCAL)
+    int64_t headerSize = 0;  // bytes skipped at the beginning of each data file (-1 - data is at the end of file)
+};
+
+// reads header of MetaImage file, after that file is positioned at the beginning of pixel data
+MetaImageHeader readMetaImageHeader(std::istream& file, bool displayInfo){
+    MetaImageHeader header{};
 
     bool objectTypeOccurred = false;
     bool nDimsOccurred = false;
@@ -437,7 +733,7 @@ ImageData readMetaImage(const std::string& filepath, bool displayInfo){
         }
         else if(tag == DimSizeTag){
             std::istringstream ss(value);
-            ss >> size.columns >> size.rows >> size.frames;
+            ss >> header.size.columns >> header.size.rows >> header.size.frames;
             if(ss.fail()){
                 throw std::runtime_error(tag + " tag has too few elements or some elements aren't integers");
             }
@@ -445,7 +741,7 @@ ImageData readMetaImage(const std::string& filepath, bool displayInfo){
         }
         else if(tag == OffsetTag || tag == PositionTag || tag == OriginTag){
             std::istringstream ss(value);
-            ss >> offset.columns >> offset.rows >> offset.frames;
+            ss >> header.offset.columns >> header.offset.rows >> header.offset.frames;
             if(ss.fail()){
                 throw std::runtime_error(tag + " tag has too few elements or some elements aren't floats");
             }
@@ -453,7 +749,7 @@ ImageData readMetaImage(const std::string& filepath, bool displayInfo){
         }
         else if(tag == ElementSpacingTag || tag == ElementSizeTag){
             std::istringstream ss(value);
-            ss >> spacing.columns >> spacing.rows >> spacing.frames;
+            ss >> header.spacing.columns >> header.spacing.rows >> header.spacing.frames;
             if(ss.fail()){
                 throw std::runtime_error(tag + " tag has too few elements or some elements aren't floats");
             }
@@ -476,38 +772,67 @@ ImageData readMetaImage(const std::string& filepath, bool displayInfo){
             }
         }
         else if(tag == BinaryDataByteOrderMSBTag){
-            dataEndianness = (value == "True" ? gdcm::SwapCode::BigEndian : gdcm::SwapCode::LittleEndian);
+            header.dataEndianness = (value == "True" ? gdcm::SwapCode::BigEndian : gdcm::SwapCode::LittleEndian);
         }
         else if(tag == CompressedDataTag){
-            if(value != "False"){
-                throw std::runtime_error("compressed data not supported");
+            if(value != "True" && value != "False"){
+                throw std::runtime_error(tag + " tag doesn't have value True or False");
+            }
+            header.compressed = (value == "True");
+        }
+        else if(tag == CompressedDataSizeTag){
+            std::istringstream ss(value);
+            ss >> header.compressedDataSize;
+            if(ss.fail()){
+                throw std::runtime_error(tag + " tag isn't an integer");
             }
         }
         else if(tag == ElementTypeTag){
             if(value == AsciiCharType || value == CharType || value == UcharType){
-                typeBytesSize = 1;
+                header.typeBytesSize = 1;
             }
             else if(value == ShortType || value == UshortType){
-                typeBytesSize = 2;
+                header.typeBytesSize = 2;
             }
             else if(value == IntType || value == UintType ||
                     value == LongType || value == UlongType ||
                     value == FloatType){
-                typeBytesSize = 4;
+                header.typeBytesSize = 4;
             }
             else if(value == LongLongType || value == UlongLongType ||
                     value == DoubleType){
-                typeBytesSize = 8;
+                header.typeBytesSize = 8;
             }
             else{
                 throw std::runtime_error(value + " data type not supported");
             }
-            type = value;
+            header.type = value;
             elementTypeOccurred = true;
         }
+        else if(tag == HeaderSizeTag){
+            std::istringstream ss(value);
+            ss >> header.headerSize;
+            if(ss.fail() || header.headerSize < -1){
+                throw std::runtime_error(tag + " tag isn't a non-negative integer or -1");
+            }
+        }
         else if(tag == ElementDataFileTag){
-            if(value != "LOCAL"){
-                throw std::runtime_error("non-local data not supported");
+            if(value.rfind("LIST", 0) == 0){
+                // names of data files are in the following lines (till the end of file)
+                while(std::getline(file, line)){
+                    if(std::string dataFile = trim(line); !dataFile.empty()){
+                        if(displayInfo){
+                            std::cout << dataFile << "\n";
+                        }
+                        header.dataFiles.push_back(std::move(dataFile));
+                    }
+                }
+                if(header.dataFiles.empty()){
+                    throw std::runtime_error(tag + " tag doesn't have list of data files");
+                }
+            }
+            else if(value != "LOCAL"){
+                header.dataFiles = dataFilesFromPattern(value);
             }
             elementDataFileOccurred = true;
             break;
@@ -537,70 +862,309 @@ ImageData readMetaImage(const std::string& filepath, bool displayInfo){
         throw std::runtime_error("ElementDataFile tag didn't occurred");
     }
 
-    // read pixel data
-    size_t dataSize = size.frames * size.rows * size.columns;
-    size_t bytes = dataSize * typeBytesSize;
-    std::vector<char> pixelData(bytes);
-    file.read(pixelData.data(), bytes);
-    std::streamsize bytesRead = file.gcount();
-    if(bytesRead != static_cast<std::streamsize>(bytes)){
-        throw std::runtime_error("pixel data doesn't contain " + std::to_string(bytes) + " bytes of data");
+    return header;
+}
+
+// reads compressed pixel data (zlib or gzip stream) in blocks and decompresses it directly to pixelData
+void readCompressedPixelData(std::istream& file, size_t compressedDataSize, char* pixelData, size_t pixelDataSize){
+    z_stream stream{};
+    // 32 added to window bits enables automatic detection of zlib and gzip headers
+    if(inflateInit2(&stream, 15 + 32) != Z_OK){
+        throw std::runtime_error("cannot initialize decompression of pixel data");
     }
 
-    file.close();
+    std::vector<char> block(CompressedBlockSize);
+    size_t remainingInput = (compressedDataSize > 0 ? compressedDataSize : std::numeric_limits<size_t>::max());
+    size_t bytesDecompressed = 0;
+    int status = Z_OK;
+    while(status == Z_OK){
+        if(stream.avail_in == 0){
+            file.read(block.data(), std::min(block.size(), remainingInput));
+            const size_t bytesRead = static_cast<size_t>(file.gcount());
+            if(bytesRead == 0){
+                break;
+            }
+            remainingInput -= bytesRead;
+            stream.next_in = reinterpret_cast<Bytef*>(block.data());
+            stream.avail_in = static_cast<uInt>(bytesRead);
+        }
+
+        const size_t outputSize = std::min(pixelDataSize - bytesDecompressed, ZlibMaxChunkSize);
+        stream.next_out = reinterpret_cast<Bytef*>(pixelData + bytesDecompressed);
+        stream.avail_out = static_cast<uInt>(outputSize);
+        status = inflate(&stream, Z_NO_FLUSH);
+        bytesDecompressed += outputSize - stream.avail_out;
+    }
+    inflateEnd(&stream);
+
+    if(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR){
+        throw std::runtime_error("compressed pixel data is corrupted");
+    }
+    if(bytesDecompressed != pixelDataSize){
+        throw std::runtime_error("pixel data doesn't contain " + std::to_string(pixelDataSize) + " bytes of data");
+    }
+}
+
+// contiguous part of pixel data stored in a data file
+struct PixelDataPart{
+    std::string filepath;
+    size_t fileOffset;      // position of the part in the file (in bytes)
+    char* data;             // destination of the part
+    size_t size;            // size of the part (in bytes, after decompression)
+    size_t compressedSize;  // size of compressed part in the file (0 if it is unknown)
+};
+
+// raw data files are read in chunks, so that a single large file can be read with several threads
+constexpr size_t ReadChunkSize = size_t{64} << 20;
+
+// divides pixel data into parts stored in data files (each file contains the same number of bytes)
+std::vector<PixelDataPart> getPixelDataParts(const std::string& filepath, size_t localDataOffset,
+                                             const MetaImageHeader& header, char* pixelData, size_t bytes){
+    if(header.dataFiles.empty()){
+        return {{filepath, localDataOffset, pixelData, bytes, header.compressedDataSize}};
+    }
+
+    const size_t nrOfFiles = header.dataFiles.size();
+    if(bytes % nrOfFiles != 0){
+        throw std::runtime_error("pixel data with " + std::to_string(bytes) + " bytes can't be divided into " +
+                                 std::to_string(nrOfFiles) + " data files");
+    }
+    const size_t partSize = bytes / nrOfFiles;
+    // CompressedDataSize is the size of the whole pixel data, so it is known only for one file
+    const size_t compressedSize = (nrOfFiles == 1 ? header.compressedDataSize : 0);
+
+    std::vector<PixelDataPart> parts;
+    parts.reserve(nrOfFiles);
+    for(size_t i = 0; i < nrOfFiles; i++){
+        // paths of data files are relative to directory of header file
+        std::filesystem::path dataFilepath(header.dataFiles[i]);
+        if(dataFilepath.is_relative()){
+            dataFilepath = std::filesystem::path(filepath).parent_path() / dataFilepath;
+        }
+
+        size_t fileOffset = static_cast<size_t>(header.headerSize);
+        if(header.headerSize == -1){
+            if(header.compressed){
+                throw std::runtime_error("HeaderSize tag equal to -1 not supported for compressed data");
+            }
+            std::error_code error;
+            const size_t fileSize = std::filesystem::file_size(dataFilepath, error);
+            if(error){
+                throw std::runtime_error("cannot read " + dataFilepath.string() + " file");
+            }
+            fileOffset = (fileSize >= partSize ? fileSize - partSize : 0);
+        }
+
+        parts.push_back({dataFilepath.string(), fileOffset, pixelData + i * partSize, partSize, compressedSize});
+    }
+    return parts;
+}
+
+// uncompressed parts are checked and split into chunks that can be read independently
+std::vector<PixelDataPart> splitRawPixelDataParts(const std::vector<PixelDataPart>& parts){
+    std::vector<PixelDataPart> chunks;
+    for(const auto& part : parts){
+        std::error_code error;
+        const size_t fileSize = std::filesystem::file_size(part.filepath, error);
+        if(error){
+            throw std::runtime_error("cannot read " + part.filepath + " file");
+        }
+        if(fileSize < part.fileOffset || fileSize - part.fileOffset < part.size){
+            throw std::runtime_error("pixel data doesn't contain " + std::to_string(part.size) + " bytes of data");
+        }
+
+        for(size_t offset = 0; offset < part.size; offset += ReadChunkSize){
+            const size_t chunkSize = std::min(ReadChunkSize, part.size - offset);
+            chunks.push_back({part.filepath, part.fileOffset + offset, part.data + offset, chunkSize, 0});
+        }
+    }
+    return chunks;
+}
+
+void readPixelDataPart(const PixelDataPart& part, bool compressed){
+    std::ifstream file(part.filepath, std::ios::binary);
+    if(!file.is_open()){
+        throw std::runtime_error("cannot read " + part.filepath + " file");
+    }
+    file.seekg(static_cast<std::streamoff>(part.fileOffset));
+
+    if(compressed){
+        readCompressedPixelData(file, part.compressedSize, part.data, part.size);
+    }
+    else{
+        file.read(part.data, static_cast<std::streamsize>(part.size));
+        if(static_cast<size_t>(file.gcount()) != part.size){
+            throw std::runtime_error("cannot read " + part.filepath + " file");
+        }
+    }
+}
+
+// reads parts of pixel data, each part is read with positioned read into its own destination,
+// so when yagit is built with threads, parts are read in parallel
+void readPixelDataParts(const std::vector<PixelDataPart>& parts, bool compressed){
+    forEachInParallel(parts.size(), [&parts, compressed](size_t i){
+        readPixelDataPart(parts[i], compressed);
+    });
+}
 
-    // convert data to system endianness
-    gdcm::SwapCode systemEndianness = (gdcm::ByteSwap<uint16_t>::SystemIsBigEndian() ? gdcm::SwapCode::BigEndian
-                                                                                     : gdcm::SwapCode::LittleEndian);
-    if(systemEndianness != dataEndianness){
-        if(typeBytesSize == 2){
+gdcm::SwapCode systemEndianness(){
+    return gdcm::ByteSwap<uint16_t>::SystemIsBigEndian() ? gdcm::SwapCode::BigEndian : gdcm::SwapCode::LittleEndian;
+}
+
+void swapPixelDataToSystemEndianness(std::vector<char>& pixelData, const MetaImageHeader& header){
+    const gdcm::SwapCode dataEndianness = header.dataEndianness;
+    if(systemEndianness() != dataEndianness){
+        if(header.typeBytesSize == 2){
             swapBytesToSystemEndianness<uint16_t>(pixelData, dataEndianness);
         }
-        else if(typeBytesSize == 4){
+        else if(header.typeBytesSize == 4){
             swapBytesToSystemEndianness<uint32_t>(pixelData, dataEndianness);
         }
         // gdcm doesn't support bytes swap for 64-bit data, so we use our own
-        else if(typeBytesSize == 8){
+        else if(header.typeBytesSize == 8){
             swapBytes64(pixelData);
         }
     }
+}
+
+// converts pixel data in system endianness to image
+ImageData convertPixelDataToImageData(const char* pixelData, size_t bytes, const MetaImageHeader& header){
+    const std::string& type = header.type;
 
-    // convert bytes data to float data
-    std::vector<float> floatData;
-    floatData.reserve(dataSize);
+    ImageData::container_type floatData;
+    floatData.reserve(bytes / header.typeBytesSize);
 
     if(type == AsciiCharType || type == CharType){
-        convertPixelDataToFloatData<int8_t>(pixelData, floatData);
+        convertPixelDataToFloatData<int8_t>(pixelData, bytes, floatData);
     }
     else if(type == UcharType){
-        convertPixelDataToFloatData<uint8_t>(pixelData, floatData);
+        convertPixelDataToFloatData<uint8_t>(pixelData, bytes, floatData);
     }
     else if(type == ShortType){
-        convertPixelDataToFloatData<int16_t>(pixelData, floatData);
+        convertPixelDataToFloatData<int16_t>(pixelData, bytes, floatData);
     }
     else if(type == UshortType){
-        convertPixelDataToFloatData<uint16_t>(pixelData, floatData);
+        convertPixelDataToFloatData<uint16_t>(pixelData, bytes, floatData);
     }
     else if(type == IntType || type == LongType){
-        convertPixelDataToFloatData<int32_t>(pixelData, floatData);
+        convertPixelDataToFloatData<int32_t>(pixelData, bytes, floatData);
     }
     else if(type == UintType || type == UlongType){
-        convertPixelDataToFloatData<uint32_t>(pixelData, floatData);
+        convertPixelDataToFloatData<uint32_t>(pixelData, bytes, floatData);
     }
     else if(type == LongLongType){
-        convertPixelDataToFloatData<int64_t>(pixelData, floatData);
+        convertPixelDataToFloatData<int64_t>(pixelData, bytes, floatData);
     }
     else if(type == UlongLongType){
-        convertPixelDataToFloatData<uint64_t>(pixelData, floatData);
+        convertPixelDataToFloatData<uint64_t>(pixelData, bytes, floatData);
     }
     else if(type == FloatType){
-        convertPixelDataToFloatData<float>(pixelData, floatData);
+        convertPixelDataToFloatData<float>(pixelData, bytes, floatData);
     }
     else if(type == DoubleType){
-        convertPixelDataToFloatData<double>(pixelData, floatData);
+        convertPixelDataToFloatData<double>(pixelData, bytes, floatData);
+    }
+
+    return ImageData(std::move(floatData), header.size, header.offset, header.spacing);
+}
+
+size_t pixelDataBytes(const MetaImageHeader& header){
+    return static_cast<size_t>(header.size.frames) * header.size.rows * header.size.columns * header.typeBytesSize;
+}
+
+ImageData readMetaImagePixelData(const std::string& filepath, size_t localDataOffset, const MetaImageHeader& header){
+    // read pixel data
+    const size_t bytes = pixelDataBytes(header);
+    std::vector<char> pixelData(bytes);
+    std::vector<PixelDataPart> parts = getPixelDataParts(filepath, localDataOffset, header, pixelData.data(), bytes);
+    if(!header.compressed){
+        parts = splitRawPixelDataParts(parts);
+    }
+    readPixelDataParts(parts, header.compressed);
+
+    swapPixelDataToSystemEndianness(pixelData, header);
+    return convertPixelDataToImageData(pixelData.data(), pixelData.size(), header);
+}
+
+// reads pixel data stored in stream just after header (stream doesn't have to be seekable)
+ImageData readMetaImagePixelData(std::istream& stream, const MetaImageHeader& header){
+    if(!header.dataFiles.empty()){
+        throw std::runtime_error("MetaImage read from stream or buffer must contain pixel data (ElementDataFile = LOCAL)");
+    }
+
+    const size_t bytes = pixelDataBytes(header);
+    std::vector<char> pixelData(bytes);
+    if(header.compressed){
+        readCompressedPixelData(stream, header.compressedDataSize, pixelData.data(), bytes);
+    }
+    else{
+        stream.read(pixelData.data(), static_cast<std::streamsize>(bytes));
+        if(static_cast<size_t>(stream.gcount()) != bytes){
+            throw std::runtime_error("pixel data doesn't contain " + std::to_string(bytes) + " bytes of data");
+        }
+    }
+
+    swapPixelDataToSystemEndianness(pixelData, header);
+    return convertPixelDataToImageData(pixelData.data(), pixelData.size(), header);
+}
+}
+
+ImageData readMetaImage(const std::string& filepath, bool displayInfo){
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file.is_open()){
+        throw std::runtime_error("cannot read " + filepath + " file");
     }
 
-    return ImageData(std::move(floatData), size, offset, spacing);
+    const MetaImageHeader header = readMetaImageHeader(file, displayInfo);
+    const size_t dataOffset = static_cast<size_t>(file.tellg());
+    file.close();
+
+    return readMetaImagePixelData(filepath, dataOffset, header);
+}
+
+ImageData readMetaImage(std::istream& stream, bool displayInfo){
+    const MetaImageHeader header = readMetaImageHeader(stream, displayInfo);
+    return readMetaImagePixelData(stream, header);
+}
+
+ImageData readMetaImageFromBuffer(const char* data, size_t size, bool displayInfo){
+    MemoryStreamBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    const MetaImageHeader header = readMetaImageHeader(stream, displayInfo);
+
+    // uncompressed pixel data in system byte order is converted directly from buffer
+    if(header.dataFiles.empty() && !header.compressed && header.dataEndianness == systemEndianness()){
+        const std::streamoff position = stream.tellg();  // -1 if header ends at the end of buffer
+        const size_t dataOffset = (position >= 0 ? static_cast<size_t>(position) : size);
+        const size_t bytes = pixelDataBytes(header);
+        if(size - dataOffset < bytes){
+            throw std::runtime_error("pixel data doesn't contain " + std::to_string(bytes) + " bytes of data");
+        }
+        return convertPixelDataToImageData(data + dataOffset, bytes, header);
+    }
+    return readMetaImagePixelData(stream, header);
+}
+
+MappedImage mapMetaImage(const std::string& filepath, bool displayInfo){
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file.is_open()){
+        throw std::runtime_error("cannot read " + filepath + " file");
+    }
+
+    const MetaImageHeader header = readMetaImageHeader(file, displayInfo);
+    const size_t dataOffset = static_cast<size_t>(file.tellg());
+    file.close();
+
+    // only uncompressed floats in system byte order that are aligned in one file can be used without conversion
+    if(!header.compressed && header.type == FloatType && header.dataEndianness == systemEndianness() &&
+       header.dataFiles.size() <= 1){
+        const size_t bytes = pixelDataBytes(header);
+        const PixelDataPart part = getPixelDataParts(filepath, dataOffset, header, nullptr, bytes).front();
+        if(part.fileOffset % alignof(float) == 0){
+            return MappedImage(part.filepath, part.fileOffset, header.size, header.offset, header.spacing);
+        }
+    }
+    return MappedImage(readMetaImagePixelData(filepath, dataOffset, header));
 }
 
 }
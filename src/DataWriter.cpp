@@ -20,12 +20,104 @@
 #include "yagit/DataWriter.hpp"
 
 #include <fstream>
+#include <vector>
+#include <array>
+#include <algorithm>
 
 #include <gdcmByteSwap.h>
+#include <gdcm_zlib.h>
+
+#include "DataIOUtils.hpp"
 
 namespace yagit::DataWriter{
 
-void writeToMetaImage(const ImageData& img, const std::string& filepath){
+namespace{
+// zlib header (RFC 1950) of deflate stream with 32 KiB window and given compression level
+std::array<char, 2> zlibHeader(int compressionLevel){
+    const unsigned cmf = 0x78;
+    const unsigned levelFlags = (compressionLevel < 2 ? 0 : compressionLevel < 6 ? 1 : compressionLevel == 6 ? 2 : 3);
+    unsigned flg = levelFlags << 6;
+    flg += 31 - (cmf * 256 + flg) % 31;  // check bits - header must be a multiple of 31
+    return {static_cast<char>(cmf), static_cast<char>(flg)};
+}
+
+// compresses block to raw deflate data (without zlib header and checksum).
+// Blocks except the last one end with full flush - at byte boundary and without references to previous data,
+// so compressed blocks concatenated one after another form a single deflate stream.
+std::vector<char> compressBlock(const char* data, size_t size, int compressionLevel, bool lastBlock){
+    z_stream stream{};
+    if(deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        throw std::runtime_error("cannot initialize compression of pixel data");
+    }
+
+    // deflateBound assumes Z_FINISH, full flush adds at most 6 bytes (empty stored block)
+    std::vector<char> compressedBlock(deflateBound(&stream, static_cast<uLong>(size)) + 6);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(compressedBlock.data());
+    stream.avail_out = static_cast<uInt>(compressedBlock.size());
+    const int status = deflate(&stream, lastBlock ? Z_FINISH : Z_FULL_FLUSH);
+    const bool compressed = (lastBlock ? status == Z_STREAM_END : status == Z_OK && stream.avail_out > 0);
+    compressedBlock.resize(compressedBlock.size() - stream.avail_out);
+    deflateEnd(&stream);
+
+    if(!compressed){
+        throw std::runtime_error("cannot compress pixel data");
+    }
+    compressedBlock.shrink_to_fit();
+    return compressedBlock;
+}
+
+// zlib stream split into parts, which are written one after another
+struct CompressedData{
+    std::array<char, 2> header;
+    std::vector<std::vector<char>> blocks;
+    std::array<char, 4> checksum;
+
+    size_t size() const{
+        size_t blocksSize = 0;
+        for(const auto& block : blocks){
+            blocksSize += block.size();
+        }
+        return header.size() + blocksSize + checksum.size();
+    }
+};
+
+// compresses data to zlib stream. Data is divided into blocks of CompressedBlockSize bytes compressed independently
+// (in parallel if yagit is built with threads), and the adler32 checksum of whole data is combined from checksums
+// of blocks. Independent blocks make the stream slightly larger (by a few bytes per 1 MiB block).
+// Whole compressed data is kept in memory, because its size is written in header before the data.
+CompressedData compressData(const char* data, size_t size, int compressionLevel){
+    const size_t nrOfBlocks = std::max((size + CompressedBlockSize - 1) / CompressedBlockSize, size_t{1});
+
+    CompressedData compressedData{zlibHeader(compressionLevel), std::vector<std::vector<char>>(nrOfBlocks), {}};
+    std::vector<uLong> blockChecksums(nrOfBlocks);
+    forEachInParallel(nrOfBlocks, [&](size_t i){
+        const size_t begin = i * CompressedBlockSize;
+        const size_t blockSize = std::min(CompressedBlockSize, size - begin);
+        const Bytef* blockData = reinterpret_cast<const Bytef*>(data + begin);
+        compressedData.blocks[i] = compressBlock(data + begin, blockSize, compressionLevel, i == nrOfBlocks - 1);
+        blockChecksums[i] = adler32(adler32(0, Z_NULL, 0), blockData, static_cast<uInt>(blockSize));
+    });
+
+    uLong checksum = adler32(0, Z_NULL, 0);
+    for(size_t i = 0; i < nrOfBlocks; i++){
+        const size_t blockSize = std::min(CompressedBlockSize, size - i * CompressedBlockSize);
+        checksum = adler32_combine(checksum, blockChecksums[i], static_cast<z_off_t>(blockSize));
+    }
+    for(size_t i = 0; i < compressedData.checksum.size(); i++){  // big-endian
+        compressedData.checksum[i] = static_cast<char>((checksum >> (8 * (3 - i))) & 0xff);
+    }
+
+    return compressedData;
+}
+}
+
+void writeToMetaImage(const ImageData& img, const std::string& filepath, int compressionLevel){
+    if(compressionLevel < 0 || compressionLevel > 9){
+        throw std::invalid_argument("compression level is not in range [0, 9]");
+    }
+
     std::ofstream file(filepath, std::ios::binary);
     if(!file){
         throw std::runtime_error("cannot open " + filepath + " file");
@@ -55,13 +147,28 @@ void writeToMetaImage(const ImageData& img, const std::string& filepath){
          << "ElementSpacing = " << spacing.columns << " " << spacing.rows << " " << spacing.frames << "\n"
          << "Orientation = 1 0 0 0 1 0 0 0 1\n"  // TODO: add support for different orientations
          << "BinaryData = True\n"
-         << "BinaryDataByteOrderMSB = " << isBigEndian << "\n"
-         << "CompressedData = False\n"
-         << "ElementType = " << elementType << "\n"
-         << "ElementDataFile = LOCAL\n";
+         << "BinaryDataByteOrderMSB = " << isBigEndian << "\n";
 
     std::streamsize bytes = img.size() * sizeof(ImageData::value_type);
-    file.write(reinterpret_cast<const char*>(img.data()), bytes);
+    if(compressionLevel > 0){
+        const CompressedData compressedData = compressData(reinterpret_cast<const char*>(img.data()), bytes,
+                                                           compressionLevel);
+        file << "CompressedData = True\n"
+             << "CompressedDataSize = " << compressedData.size() << "\n"
+             << "ElementType = " << elementType << "\n"
+             << "ElementDataFile = LOCAL\n";
+        file.write(compressedData.header.data(), compressedData.header.size());
+        for(const auto& block : compressedData.blocks){
+            file.write(block.data(), block.size());
+        }
+        file.write(compressedData.checksum.data(), compressedData.checksum.size());
+    }
+    else{
+        file << "CompressedData = False\n"
+             << "ElementType = " << elementType << "\n"
+             << "ElementDataFile = LOCAL\n";
+        file.write(reinterpret_cast<const char*>(img.data()), bytes);
+    }
 
     file.close();
 }
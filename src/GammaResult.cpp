@@ -19,15 +19,61 @@
 
 #include "yagit/GammaResult.hpp"
 
+#include "StatisticsAccumulator.hpp"
+
 #include <algorithm>
+#include <numeric>
+#include <iterator>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
 
 namespace yagit{
 
+namespace{
+// values at percentiles of data (it is reordered), linearly interpolated between the closest values
+std::vector<float> findPercentiles(std::vector<float>& data, const std::vector<double>& percentiles){
+    std::vector<float> res(percentiles.size(), std::numeric_limits<float>::quiet_NaN());
+    if(data.empty()){
+        return res;
+    }
+
+    // find percentiles in ascending order, so each selection searches only values not less than previous one
+    std::vector<size_t> order(percentiles.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&percentiles](size_t a, size_t b){
+        return percentiles[a] < percentiles[b];
+    });
+
+    auto selectedBegin = data.begin();
+    for(size_t p : order){
+        const double pos = percentiles[p] / 100 * (data.size() - 1);
+        const size_t lowerPos = static_cast<size_t>(pos);
+        const auto lower = data.begin() + lowerPos;
+        std::nth_element(selectedBegin, lower, data.end());
+        selectedBegin = lower;
+
+        const double fraction = pos - lowerPos;
+        if(fraction > 0){
+            const float upper = *std::min_element(lower + 1, data.end());
+            res[p] = static_cast<float>(*lower + fraction * (upper - *lower));
+        }
+        else{
+            res[p] = *lower;
+        }
+    }
+    return res;
+}
+}
+
 double GammaResult::passingRate() const{
-    return static_cast<double>(std::count_if(m_data.begin(), m_data.end(), [](value_type el) {
-        return !std::isnan(el) && el <= 1;
-    })) / nansize();
+    size_t passed = 0;
+    size_t size = 0;
+    for(const auto& el : m_data){
+        passed += el <= 1;  // false for NaN
+        size += !std::isnan(el);
+    }
+    return static_cast<double>(passed) / size;
 }
 
 GammaResult::value_type GammaResult::minGamma() const{
@@ -50,4 +96,34 @@ double GammaResult::varGamma() const{
     return nanvar();
 }
 
+GammaStatistics GammaResult::statistics(const std::vector<float>& thresholds,
+                                        const std::vector<double>& percentiles) const{
+    for(double p : percentiles){
+        if(!(p >= 0 && p <= 100)){
+            throw std::invalid_argument("percentile is outside [0, 100]");
+        }
+    }
+
+    StatisticsAccumulator statistics(thresholds);
+    statistics.add(m_data.data(), m_data.data() + m_data.size());
+
+    std::vector<double> passingRates(thresholds.size());
+    for(size_t t = 0; t < thresholds.size(); t++){
+        passingRates[t] = static_cast<double>(statistics.thresholdCounts()[t]) / statistics.size();
+    }
+
+    std::vector<float> percentileVals;
+    if(!percentiles.empty()){
+        std::vector<float> data;
+        data.reserve(statistics.size());
+        std::copy_if(m_data.begin(), m_data.end(), std::back_inserter(data), [](value_type el){
+            return !std::isnan(el);
+        });
+        percentileVals = findPercentiles(data, percentiles);
+    }
+
+    return {statistics.size(), statistics.sum(), statistics.mean(), statistics.var(),
+            statistics.min(), statistics.max(), std::move(passingRates), std::move(percentileVals)};
+}
+
 }
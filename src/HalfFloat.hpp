@@ -0,0 +1,117 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace yagit{
+
+// Conversions between float and 16-bit floating-point formats (IEEE 754 half precision and bfloat16).
+// Narrowing rounds to nearest even, NaN stays NaN and values too large for half precision become infinity.
+// Widening of half precision has no branches (cases are selected with bit masks),
+// so loops widening arrays are vectorized by compiler. If F16C instructions are enabled
+// (e.g. -march=native), single values are widened with one instruction, because kernels widen voxels
+// of evaluated image one by one when they read them.
+namespace{
+template <typename To, typename From>
+To bitCast(From value){
+    static_assert(sizeof(To) == sizeof(From));
+    To result;
+    std::memcpy(&result, &value, sizeof(To));
+    return result;
+}
+
+inline uint16_t floatToHalf(float value){
+    constexpr uint32_t FloatInfBits = 0x7f800000u;
+    constexpr uint32_t HalfOverflowBits = (127 + 16) << 23;  // 2^16 - the first value rounded to infinity
+    constexpr uint32_t HalfNormalMinBits = (127 - 14) << 23;
+    const float subnormalMagic = bitCast<float>(uint32_t{(127 - 15 + 23 - 10 + 1) << 23});
+
+    uint32_t bits = bitCast<uint32_t>(value);
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if(bits >= HalfOverflowBits){
+        half = bits > FloatInfBits ? 0x7e00u : 0x7c00u;
+    }
+    else if(bits < HalfNormalMinBits){
+        // adding magic number aligns mantissa so that the hardware rounds it to a subnormal half
+        half = bitCast<uint32_t>(bitCast<float>(bits) + subnormalMagic) - bitCast<uint32_t>(subnormalMagic);
+    }
+    else{
+        const uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantissaOdd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+inline float halfToFloat(uint16_t half){
+#ifdef __F16C__
+    return _cvtsh_ss(half);
+#else
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t magnitude = half & 0x7fffu;
+    // rebias exponent from 15 to 127 (infinity and NaN need the maximum exponent)
+    uint32_t bits = (magnitude << 13) + ((127 - 15) << 23);
+    const uint32_t infNanMask = 0u - static_cast<uint32_t>(magnitude >= 0x7c00u);
+    bits += infNanMask & ((128 - 16) << 23);
+    // subnormal half is a normal float
+    const uint32_t subnormalBits = bitCast<uint32_t>(static_cast<float>(magnitude) * 0x1p-24f);
+    const uint32_t subnormalMask = 0u - static_cast<uint32_t>(magnitude < 0x0400u);
+    bits = (subnormalBits & subnormalMask) | (bits & ~subnormalMask);
+    return bitCast<float>(bits | sign);
+#endif
+}
+
+inline uint16_t floatToBFloat16(float value){
+    const uint32_t bits = bitCast<uint32_t>(value);
+    if((bits & 0x7fffffffu) > 0x7f800000u){
+        return static_cast<uint16_t>((bits >> 16) | 0x0040u);  // quiet NaN
+    }
+    const uint32_t lsb = (bits >> 16) & 1;
+    return static_cast<uint16_t>((bits + 0x7fffu + lsb) >> 16);
+}
+
+inline float bfloat16ToFloat(uint16_t value){
+    return bitCast<float>(static_cast<uint32_t>(value) << 16);
+}
+
+inline void halfToFloat(const uint16_t* begin, const uint16_t* end, float* output){
+    for(; begin < end; begin++, output++){
+        *output = halfToFloat(*begin);
+    }
+}
+
+inline void bfloat16ToFloat(const uint16_t* begin, const uint16_t* end, float* output){
+    for(; begin < end; begin++, output++){
+        *output = bfloat16ToFloat(*begin);
+    }
+}
+}
+
+}
@@ -19,6 +19,8 @@
 
 #include "yagit/ImageData.hpp"
 
+#include "StatisticsAccumulator.hpp"
+
 #include <stdexcept>
 #include <algorithm>
 #include <numeric>
@@ -47,8 +49,9 @@ bool nanSensitiveFloatsEqual(value_type val1, value_type val2){
 ImageData::ImageData()
     : m_data{}, m_size{0, 0, 0}, m_offset{0, 0, 0}, m_spacing{1, 1, 1} {}
 
-ImageData::ImageData(const Image2D& image2d, const DataOffset& offset, const DataSpacing& spacing)
-    : m_offset(offset), m_spacing(spacing) {
+ImageData::ImageData(const Image2D& image2d, const DataOffset& offset, const DataSpacing& spacing,
+                     const allocator_type& allocator)
+    : m_data(allocator), m_offset(offset), m_spacing(spacing) {
     if(spacing.frames <= 0 || spacing.rows <= 0 || spacing.columns <= 0){
         throw std::invalid_argument("spacing should be greater than 0");
     }
@@ -77,8 +80,9 @@ ImageData::ImageData(const Image2D& image2d, const DataOffset& offset, const Dat
     m_size = DataSize{1, rows, columns};
 }
 
-ImageData::ImageData(const Image3D& image3d, const DataOffset& offset, const DataSpacing& spacing)
-    : m_offset(offset), m_spacing(spacing) {
+ImageData::ImageData(const Image3D& image3d, const DataOffset& offset, const DataSpacing& spacing,
+                     const allocator_type& allocator)
+    : m_data(allocator), m_offset(offset), m_spacing(spacing) {
     if(spacing.frames <= 0 || spacing.rows <= 0 || spacing.columns <= 0){
         throw std::invalid_argument("spacing should be greater than 0");
     }
@@ -122,7 +126,7 @@ ImageData::ImageData(const Image3D& image3d, const DataOffset& offset, const Dat
     m_size = DataSize{frames, rows, columns};
 }
 
-ImageData::ImageData(std::vector<value_type>&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing) noexcept
+ImageData::ImageData(container_type&& data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing) noexcept
     : m_data(std::move(data)), m_size(size), m_offset(offset), m_spacing(spacing) {}
 
 ImageData::ImageData(ImageData&& other) noexcept
@@ -191,7 +195,7 @@ const_reference ImageData::at(uint32_t z, uint32_t y, uint32_t x) const{
 }
 
 std::vector<value_type> ImageData::getData() const{
-    return m_data;
+    return std::vector<value_type>(m_data.begin(), m_data.end());
 }
 
 Image2D ImageData::getImage2D(uint32_t frame, ImagePlane imgPlane) const{
@@ -277,7 +281,7 @@ ImageData ImageData::getImageData2D(uint32_t frame, ImagePlane imgPlane) const{
         spacing = {1, m_spacing.frames, m_spacing.rows};
     }
 
-    return ImageData(getImage2D(frame, imgPlane), offset, spacing);
+    return ImageData(getImage2D(frame, imgPlane), offset, spacing, getAllocator());
 }
 
 ImageData ImageData::getImageData3D(ImagePlane imgPlane) const{
@@ -297,7 +301,7 @@ ImageData ImageData::getImageData3D(ImagePlane imgPlane) const{
             spacing = {m_spacing.columns, m_spacing.frames, m_spacing.rows};
         }
 
-        return ImageData(getImage3D(imgPlane), offset, spacing);
+        return ImageData(getImage3D(imgPlane), offset, spacing, getAllocator());
     }
 }
 
@@ -350,21 +354,27 @@ double ImageData::nansum() const{
     });
 }
 
+// mean and variance need both sum and size (and variance also squared deviations),
+// so they are calculated with fused statistics
 double ImageData::nanmean() const{
-    return nansum() / nansize();
+    return nanstatistics().mean;
 }
 
 double ImageData::nanvar() const{
-    const double meanVal = nanmean();
-    return std::accumulate(m_data.begin(), m_data.end(), double(), [&meanVal](double a, value_type b){
-        return !std::isnan(b) ? (a + (b - meanVal) * (b - meanVal)) : a;
-    }) / nansize();
+    return nanstatistics().var;
 }
 
 ImageData::size_type ImageData::nansize() const{
     return std::count_if(m_data.begin(), m_data.end(), [](value_type el) { return !std::isnan(el); });
 }
 
+ImageStatistics ImageData::nanstatistics() const{
+    StatisticsAccumulator statistics;
+    statistics.add(m_data.data(), m_data.data() + m_data.size());
+    return {statistics.size(), statistics.sum(), statistics.mean(), statistics.var(),
+            statistics.min(), statistics.max()};
+}
+
 bool ImageData::containsNan() const{
     return std::find_if(m_data.begin(), m_data.end(), [](value_type el) { return std::isnan(el); }) != m_data.end();
 }
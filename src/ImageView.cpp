@@ -0,0 +1,86 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/ImageView.hpp"
+
+#include <stdexcept>
+
+namespace yagit{
+
+namespace{
+// copy elements of image in (frame, row, column) order to empty container
+template <typename Container>
+void copyData(const ImageView& img, Container& data){
+    const DataSize size = img.getSize();
+    if(img.isContiguous() || img.size() == 0){
+        data.assign(img.data(), img.data() + img.size());
+        return;
+    }
+
+    data.reserve(img.size());
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            if(img.getStrides().columns == 1){
+                ImageView::const_pointer row = &img.get(k, j, 0);
+                data.insert(data.end(), row, row + size.columns);
+            }
+            else{
+                for(uint32_t i = 0; i < size.columns; i++){
+                    data.push_back(img.get(k, j, i));
+                }
+            }
+        }
+    }
+}
+}
+
+ImageView::ImageView(const_pointer data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing)
+    : ImageView(data, size, offset, spacing, contiguousStrides(size)) {}
+
+ImageView::ImageView(const_pointer data, const DataSize& size, const DataOffset& offset, const DataSpacing& spacing,
+                     const DataStrides& strides)
+    : m_data(data), m_size(size), m_offset(offset), m_spacing(spacing), m_strides(strides) {
+    if(spacing.frames <= 0 || spacing.rows <= 0 || spacing.columns <= 0){
+        throw std::invalid_argument("spacing should be greater than 0");
+    }
+    if(data == nullptr && size.frames * size.rows * size.columns > 0){
+        throw std::invalid_argument("data is null");
+    }
+}
+
+ImageView::const_reference ImageView::at(uint32_t frame, uint32_t row, uint32_t column) const{
+    if(frame >= m_size.frames || row >= m_size.rows || column >= m_size.columns){
+        throw std::out_of_range("data index out of range");
+    }
+    return get(frame, row, column);
+}
+
+std::vector<ImageView::value_type> ImageView::getData() const{
+    std::vector<value_type> data;
+    copyData(*this, data);
+    return data;
+}
+
+ImageData ImageView::toImageData() const{
+    ImageData::container_type data;
+    copyData(*this, data);
+    return ImageData(std::move(data), m_size, m_offset, m_spacing);
+}
+
+}
@@ -20,7 +20,9 @@
 #include "yagit/Interpolation.hpp"
 
 #include <cmath>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace yagit::Interpolation{
 
@@ -47,7 +49,7 @@ constexpr uint32_t calcNewSize(uint32_t oldSize, float oldSpacing, float offsetR
 }
 }
 
-ImageData linearAlongAxis(const ImageData& img, float spacing, ImageAxis axis){
+ImageData linearAlongAxis(const ImageView& img, float spacing, ImageAxis axis){
     if(axis == ImageAxis::Z){
         return linearAlongAxis(img, img.getOffset().frames, spacing, axis);
     }
@@ -62,7 +64,7 @@ ImageData linearAlongAxis(const ImageData& img, float spacing, ImageAxis axis){
     }
 }
 
-ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing, ImageAxis axis){
+ImageData linearAlongAxis(const ImageView& img, float gridOffset, float spacing, ImageAxis axis){
     if(spacing <= 0){
         throw std::invalid_argument("spacing should be greater than 0");
     }
@@ -74,7 +76,7 @@ ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing,
 
         float oldSpacing = img.getSpacing().frames;
         if(zOffsetRel == 0 && spacing == oldSpacing){
-            return img;
+            return img.toImageData();
         }
 
         uint32_t newSize = calcNewSize(img.getSize().frames, oldSpacing, zOffsetRel, spacing);
@@ -146,7 +148,7 @@ ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing,
 
         float oldSpacing = img.getSpacing().rows;
         if(yOffsetRel == 0 && spacing == oldSpacing){
-            return img;
+            return img.toImageData();
         }
 
         uint32_t newSize = calcNewSize(img.getSize().rows, oldSpacing, yOffsetRel, spacing);
@@ -218,7 +220,7 @@ ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing,
 
         float oldSpacing = img.getSpacing().columns;
         if(xOffsetRel == 0 && spacing == oldSpacing){
-            return img;
+            return img.toImageData();
         }
 
         uint32_t newSize = calcNewSize(img.getSize().columns, oldSpacing, xOffsetRel, spacing);
@@ -288,7 +290,7 @@ ImageData linearAlongAxis(const ImageData& img, float gridOffset, float spacing,
     }
 }
 
-ImageData linearAlongAxis(const ImageData& targetImg, const ImageData& refImg, ImageAxis axis){
+ImageData linearAlongAxis(const ImageView& targetImg, const ImageView& refImg, ImageAxis axis){
     float offset = 0;
     float spacing = 0;
     if(axis == ImageAxis::Z){
@@ -309,7 +311,122 @@ ImageData linearAlongAxis(const ImageData& targetImg, const ImageData& refImg, I
     return linearAlongAxis(targetImg, offset, spacing, axis);
 }
 
-ImageData bilinearOnPlane(const ImageData& img, float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane){
+namespace{
+// index of frame preceding frame at z and weight of the next frame in linear interpolation
+// (nullopt if frame at z is outside of image)
+// position of frame at z between frames ind1 and ind1+1 of image
+struct FrameAtZ{
+    uint32_t ind1;
+    float factor;        // (z - z1) / oldSpacing
+    float dz;            // z - z1
+    float oldSpacing;
+    bool smallSpacing;   // linearAlongAxis uses the version with slope for such spacing
+
+    // same formulas as in linearAlongAxis along Z
+    float interpolate(float val1, float val2) const{
+        if(smallSpacing){
+            const float slope = (val2 - val1) / oldSpacing;
+            return val1 + dz * slope;
+        }
+        return val1 + factor * (val2 - val1);
+    }
+};
+
+std::optional<FrameAtZ> frameAtZ(float z, float newSpacing, float offset, float spacing, uint32_t frames){
+    const float zMaxRel = spacing * (frames - 1);
+    float zRel = z - offset;
+    // Tolerance here is for frames lying on the edges of image (see calcNewOffset and calcNewSize)
+    if(zRel < -Tolerance || zRel > zMaxRel + Tolerance){
+        return std::nullopt;
+    }
+    zRel = std::clamp(zRel, 0.0f, zMaxRel);
+
+    const float temp = zRel / spacing;
+    const uint32_t ind1 = static_cast<uint32_t>(temp);
+    return FrameAtZ{ind1, temp - ind1, zRel - ind1 * spacing, spacing, 2.0 * newSpacing < spacing};
+}
+}
+
+std::optional<ImageData> linearFrameAtZ(const ImageView& img, float z, float spacing){
+    if(img.size() == 0){
+        return std::nullopt;
+    }
+
+    if(spacing <= 0){
+        throw std::invalid_argument("spacing should be greater than 0");
+    }
+    const auto frame = frameAtZ(z, spacing, img.getOffset().frames, img.getSpacing().frames, img.getSize().frames);
+    if(!frame.has_value()){
+        return std::nullopt;
+    }
+    const uint32_t ind1 = frame->ind1;
+
+    const size_t frameSize = static_cast<size_t>(img.getSize().rows) * img.getSize().columns;
+    ImageData::container_type newData(frameSize);
+
+    if(img.isContiguous()){
+        const float* frame1 = img.data() + ind1 * frameSize;
+        if(ind1 + 1 < img.getSize().frames){
+            const float* frame2 = frame1 + frameSize;
+            for(size_t i = 0; i < frameSize; i++){
+                newData[i] = frame->interpolate(frame1[i], frame2[i]);
+            }
+        }
+        else{
+            std::copy(frame1, frame1 + frameSize, newData.begin());
+        }
+    }
+    else{
+        // elements aren't contiguous, so they are accessed with strides
+        const uint32_t rows = img.getSize().rows;
+        const uint32_t columns = img.getSize().columns;
+        const bool hasNextFrame = ind1 + 1 < img.getSize().frames;
+        for(uint32_t j = 0; j < rows; j++){
+            for(uint32_t i = 0; i < columns; i++){
+                const float val1 = img.get(ind1, j, i);
+                newData[static_cast<size_t>(j) * columns + i] =
+                    hasNextFrame ? frame->interpolate(val1, img.get(ind1 + 1, j, i)) : val1;
+            }
+        }
+    }
+
+    const DataSize newSize{1, img.getSize().rows, img.getSize().columns};
+    const DataOffset newOffset{z, img.getOffset().rows, img.getOffset().columns};
+    return ImageData(std::move(newData), newSize, newOffset, img.getSpacing());
+}
+
+std::optional<ImageData> linearFrameAtZ(const CompactImageData& img, float z, float spacing){
+    if(img.size() == 0){
+        return std::nullopt;
+    }
+
+    if(spacing <= 0){
+        throw std::invalid_argument("spacing should be greater than 0");
+    }
+    const auto frame = frameAtZ(z, spacing, img.getOffset().frames, img.getSpacing().frames, img.getSize().frames);
+    if(!frame.has_value()){
+        return std::nullopt;
+    }
+    const uint32_t ind1 = frame->ind1;
+
+    // only frames between which frame at z lies are widened
+    const size_t frameSize = static_cast<size_t>(img.getSize().rows) * img.getSize().columns;
+    const bool hasNextFrame = ind1 + 1 < img.getSize().frames;
+    ImageData::container_type newData = img.readFrames(ind1, hasNextFrame ? 2 : 1);
+    if(hasNextFrame){
+        const float* frame2 = newData.data() + frameSize;
+        for(size_t i = 0; i < frameSize; i++){
+            newData[i] = frame->interpolate(newData[i], frame2[i]);
+        }
+        newData.resize(frameSize);
+    }
+
+    const DataSize newSize{1, img.getSize().rows, img.getSize().columns};
+    const DataOffset newOffset{z, img.getOffset().rows, img.getOffset().columns};
+    return ImageData(std::move(newData), newSize, newOffset, img.getSpacing());
+}
+
+ImageData bilinearOnPlane(const ImageView& img, float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane){
     if(plane == ImagePlane::YX){
         return linearAlongAxis(linearAlongAxis(img, firstAxisSpacing, ImageAxis::Y), secondAxisSpacing, ImageAxis::X);
     }
@@ -324,7 +441,7 @@ ImageData bilinearOnPlane(const ImageData& img, float firstAxisSpacing, float se
     }
 }
 
-ImageData bilinearOnPlane(const ImageData& img, float firstAxisGridOffset, float secondAxisGridOffset,
+ImageData bilinearOnPlane(const ImageView& img, float firstAxisGridOffset, float secondAxisGridOffset,
                          float firstAxisSpacing, float secondAxisSpacing, ImagePlane plane){
     if(plane == ImagePlane::YX){
         return linearAlongAxis(
@@ -349,7 +466,7 @@ ImageData bilinearOnPlane(const ImageData& img, float firstAxisGridOffset, float
     }
 }
 
-ImageData bilinearOnPlane(const ImageData& targetImg, const ImageData& refImg, ImagePlane plane){
+ImageData bilinearOnPlane(const ImageView& targetImg, const ImageView& refImg, ImagePlane plane){
     float offset1 = 0, offset2 = 0;
     float spacing1 = 0, spacing2 = 0;
     if(plane == ImagePlane::YX){
@@ -376,7 +493,7 @@ ImageData bilinearOnPlane(const ImageData& targetImg, const ImageData& refImg, I
     return bilinearOnPlane(targetImg, offset1, offset2, spacing1, spacing2, plane);
 }
 
-ImageData trilinear(const ImageData& img, const DataSpacing& spacing){
+ImageData trilinear(const ImageView& img, const DataSpacing& spacing){
     return linearAlongAxis(
         linearAlongAxis(
             linearAlongAxis(
@@ -385,7 +502,7 @@ ImageData trilinear(const ImageData& img, const DataSpacing& spacing){
         spacing.columns, ImageAxis::X);
 }
 
-ImageData trilinear(const ImageData& img, const DataOffset& gridOffset, const DataSpacing& spacing){
+ImageData trilinear(const ImageView& img, const DataOffset& gridOffset, const DataSpacing& spacing){
     return linearAlongAxis(
         linearAlongAxis(
             linearAlongAxis(
@@ -395,11 +512,11 @@ ImageData trilinear(const ImageData& img, const DataOffset& gridOffset, const Da
 
 }
 
-ImageData trilinear(const ImageData& targetImg, const ImageData& refImg){
+ImageData trilinear(const ImageView& targetImg, const ImageView& refImg){
     return trilinear(targetImg, refImg.getOffset(), refImg.getSpacing());
 }
 
-std::optional<float> bilinearAtPoint(const ImageData& img, uint32_t frame, float y, float x){
+std::optional<float> bilinearAtPoint(const ImageView& img, uint32_t frame, float y, float x){
     if(frame >= img.getSize().frames){
         throw std::out_of_range("frame out of range (frame >= nr of frames)");
     }
@@ -437,7 +554,7 @@ std::optional<float> bilinearAtPoint(const ImageData& img, uint32_t frame, float
     return c0*(1 - yd) + c1*yd;
 }
 
-std::optional<float> trilinearAtPoint(const ImageData& img, float z, float y, float x){
+std::optional<float> trilinearAtPoint(const ImageView& img, float z, float y, float x){
     if(z < img.getOffset().frames || z > img.getOffset().frames + (img.getSize().frames - 1) * img.getSpacing().frames ||
        y < img.getOffset().rows || y > img.getOffset().rows + (img.getSize().rows - 1) * img.getSpacing().rows ||
        x < img.getOffset().columns || x > img.getOffset().columns + (img.getSize().columns - 1) * img.getSpacing().columns){
@@ -0,0 +1,168 @@
+/********************************************************************************************
+ * Copyright (C) 2023-2024 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/MappedImage.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <tuple>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yagit{
+
+namespace{
+// maps the whole file read-only and returns pointer to the mapping and its size
+std::pair<void*, size_t> mapFile(const std::string& filepath){
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE){
+        throw std::runtime_error("cannot read " + filepath + " file");
+    }
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)){
+        CloseHandle(file);
+        throw std::runtime_error("cannot read " + filepath + " file");
+    }
+    if(fileSize.QuadPart == 0){
+        CloseHandle(file);
+        return {nullptr, 0};
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr){
+        throw std::runtime_error("cannot map " + filepath + " file");
+    }
+    // view keeps the mapping alive, so its handle can be closed
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(data == nullptr){
+        throw std::runtime_error("cannot map " + filepath + " file");
+    }
+    return {data, static_cast<size_t>(fileSize.QuadPart)};
+#else
+    const int fd = open(filepath.c_str(), O_RDONLY);
+    if(fd == -1){
+        throw std::runtime_error("cannot read " + filepath + " file");
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) == -1){
+        close(fd);
+        throw std::runtime_error("cannot read " + filepath + " file");
+    }
+    const size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    if(fileSize == 0){
+        close(fd);
+        return {nullptr, 0};
+    }
+    // mapping keeps the file open, so its descriptor can be closed
+    void* data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED){
+        throw std::runtime_error("cannot map " + filepath + " file");
+    }
+    return {data, fileSize};
+#endif
+}
+
+void unmapFile(void* data, [[maybe_unused]] size_t size) noexcept{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+}
+
+MappedImage::MappedImage(const std::string& filepath, size_t dataOffset,
+                         const DataSize& size, const DataOffset& offset, const DataSpacing& spacing)
+    : m_size(size), m_offset(offset), m_spacing(spacing) {
+    if(dataOffset % alignof(value_type) != 0){
+        throw std::invalid_argument("data offset should be a multiple of " + std::to_string(alignof(value_type)));
+    }
+
+    std::tie(m_mapping, m_mappingSize) = mapFile(filepath);
+
+    const size_t bytes = this->size() * sizeof(value_type);
+    if(m_mappingSize < dataOffset || m_mappingSize - dataOffset < bytes){
+        unmap();
+        throw std::runtime_error("pixel data doesn't contain " + std::to_string(bytes) + " bytes of data");
+    }
+    if(m_mapping != nullptr){
+        m_data = reinterpret_cast<const_pointer>(static_cast<const char*>(m_mapping) + dataOffset);
+    }
+}
+
+MappedImage::MappedImage(ImageData&& image) noexcept
+    : m_ownedData(std::move(image)), m_data(m_ownedData.data()),
+      m_size(m_ownedData.getSize()), m_offset(m_ownedData.getOffset()), m_spacing(m_ownedData.getSpacing()) {}
+
+MappedImage::MappedImage(MappedImage&& other) noexcept
+    : m_mapping(std::exchange(other.m_mapping, nullptr)), m_mappingSize(std::exchange(other.m_mappingSize, 0)),
+      m_ownedData(std::move(other.m_ownedData)), m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, {0, 0, 0})), m_offset(std::exchange(other.m_offset, {0, 0, 0})),
+      m_spacing(std::exchange(other.m_spacing, {1, 1, 1})) {
+    if(m_mapping == nullptr){
+        m_data = m_ownedData.data();
+    }
+}
+
+MappedImage& MappedImage::operator=(MappedImage&& other) noexcept{
+    if(this != &other){
+        unmap();
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_mappingSize = std::exchange(other.m_mappingSize, 0);
+        m_ownedData = std::move(other.m_ownedData);
+        m_data = (m_mapping != nullptr ? other.m_data : m_ownedData.data());
+        other.m_data = nullptr;
+        m_size = std::exchange(other.m_size, {0, 0, 0});
+        m_offset = std::exchange(other.m_offset, {0, 0, 0});
+        m_spacing = std::exchange(other.m_spacing, {1, 1, 1});
+    }
+    return *this;
+}
+
+MappedImage::~MappedImage(){
+    unmap();
+}
+
+void MappedImage::unmap() noexcept{
+    if(m_mapping != nullptr){
+        unmapFile(m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+        m_mappingSize = 0;
+        m_data = nullptr;
+    }
+}
+
+ImageData MappedImage::toImageData() const{
+    return view().toImageData();
+}
+
+}
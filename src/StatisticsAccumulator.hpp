@@ -0,0 +1,197 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace yagit{
+
+// Statistics of values (size, sum, mean, variance, min, max, number of values less than or equal to thresholds
+// and optionally histogram) accumulated in a single pass over memory, ignoring NaNs.
+// Values are processed in blocks that fit in L1 cache. Sum, size, min and max of block are accumulated
+// in independent lanes (NaN values are replaced by neutral elements without branches), so consecutive
+// additions don't wait for each other and compiler may vectorize them without reordering floating-point
+// operations. Squared differences from the mean of block are summed while block is still in cache.
+// Blocks are merged with Chan's formula.
+// Accumulators of different parts of data can be merged too, so data can be split between threads.
+class StatisticsAccumulator{
+public:
+    explicit StatisticsAccumulator(std::vector<float> thresholds = {},
+                                   uint32_t histogramBins = 0, float histogramBinWidth = 1)
+        : m_thresholds(std::move(thresholds)), m_thresholdCounts(m_thresholds.size(), 0),
+          m_histogram(histogramBins, 0), m_binWidth(histogramBinWidth) {}
+
+    // add values of [begin, end)
+    void add(const float* begin, const float* end){
+        while(begin < end){
+            const float* blockEnd = begin + std::min(static_cast<size_t>(end - begin), BlockSize);
+            addBlock(begin, blockEnd);
+            begin = blockEnd;
+        }
+    }
+
+    void merge(const StatisticsAccumulator& other){
+        for(size_t t = 0; t < m_thresholdCounts.size(); t++){
+            m_thresholdCounts[t] += other.m_thresholdCounts[t];
+        }
+        for(size_t b = 0; b < m_histogram.size(); b++){
+            m_histogram[b] += other.m_histogram[b];
+        }
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        m_sum += other.m_sum;
+        mergeMoments(other.m_size, other.m_mean, other.m_m2);
+    }
+
+    size_t size() const { return m_size; }
+    double sum() const { return m_sum; }
+    double mean() const { return m_size > 0 ? m_mean : std::numeric_limits<double>::quiet_NaN(); }
+    double var() const { return m_size > 0 ? m_m2 / m_size : std::numeric_limits<double>::quiet_NaN(); }
+    // +inf and -inf if there are no values
+    float min() const { return m_min; }
+    float max() const { return m_max; }
+    // numbers of values less than or equal to consecutive thresholds
+    const std::vector<size_t>& thresholdCounts() const { return m_thresholdCounts; }
+    // the last bin contains all values greater than or equal to its lower bound
+    const std::vector<size_t>& histogram() const { return m_histogram; }
+
+private:
+    static constexpr size_t BlockSize = 2048;
+    static constexpr size_t Lanes = 8;
+
+    void addBlock(const float* begin, const float* end){
+        const size_t n = static_cast<size_t>(end - begin);
+
+        std::array<double, Lanes> sums{};
+        std::array<uint32_t, Lanes> sizes{};
+        std::array<float, Lanes> mins;
+        std::array<float, Lanes> maxs;
+        mins.fill(std::numeric_limits<float>::infinity());
+        maxs.fill(-std::numeric_limits<float>::infinity());
+        // comparisons with NaN are false, so NaNs don't change min and max
+        auto accumulate = [&](size_t l, float val){
+            const bool valid = val == val;
+            sums[l] += valid ? val : 0.0f;
+            sizes[l] += valid;
+            mins[l] = val < mins[l] ? val : mins[l];
+            maxs[l] = val > maxs[l] ? val : maxs[l];
+        };
+        size_t i = 0;
+        for(; i + Lanes <= n; i += Lanes){
+            for(size_t l = 0; l < Lanes; l++){
+                accumulate(l, begin[i + l]);
+            }
+        }
+        for(; i < n; i++){
+            accumulate(0, begin[i]);
+        }
+
+        size_t blockSize = 0;
+        double blockSum = 0;
+        for(size_t l = 0; l < Lanes; l++){
+            blockSize += sizes[l];
+            blockSum += sums[l];
+            m_min = std::min(m_min, mins[l]);
+            m_max = std::max(m_max, maxs[l]);
+        }
+        if(blockSize == 0){
+            return;
+        }
+        m_sum += blockSum;
+
+        const double blockMean = blockSum / blockSize;
+        std::array<double, Lanes> m2s{};
+        auto accumulateM2 = [&](size_t l, float val){
+            const double diff = val - blockMean;
+            m2s[l] += val == val ? diff * diff : 0.0;
+        };
+        i = 0;
+        for(; i + Lanes <= n; i += Lanes){
+            for(size_t l = 0; l < Lanes; l++){
+                accumulateM2(l, begin[i + l]);
+            }
+        }
+        for(; i < n; i++){
+            accumulateM2(0, begin[i]);
+        }
+        double blockM2 = 0;
+        for(size_t l = 0; l < Lanes; l++){
+            blockM2 += m2s[l];
+        }
+
+        for(size_t t = 0; t < m_thresholds.size(); t++){
+            const float threshold = m_thresholds[t];
+            size_t count = 0;
+            for(size_t j = 0; j < n; j++){
+                count += begin[j] <= threshold;
+            }
+            m_thresholdCounts[t] += count;
+        }
+
+        if(!m_histogram.empty()){
+            const size_t lastBin = m_histogram.size() - 1;
+            for(size_t j = 0; j < n; j++){
+                if(!std::isnan(begin[j])){
+                    const float bin = std::floor(begin[j] / m_binWidth);
+                    m_histogram[bin < lastBin ? static_cast<size_t>(bin) : lastBin]++;
+                }
+            }
+        }
+
+        mergeMoments(blockSize, blockMean, blockM2);
+    }
+
+    void mergeMoments(size_t size, double mean, double m2){
+        if(size == 0){
+            return;
+        }
+        if(m_size == 0){
+            m_size = size;
+            m_mean = mean;
+            m_m2 = m2;
+            return;
+        }
+        const size_t totalSize = m_size + size;
+        const double delta = mean - m_mean;
+        m_m2 += m2 + delta * delta * (static_cast<double>(m_size) * size / totalSize);
+        m_mean += delta * size / totalSize;
+        m_size = totalSize;
+    }
+
+    std::vector<float> m_thresholds;
+    std::vector<size_t> m_thresholdCounts;
+    std::vector<size_t> m_histogram;
+    float m_binWidth;
+
+    size_t m_size{0};
+    double m_sum{0};
+    double m_mean{0};
+    double m_m2{0};
+    float m_min{std::numeric_limits<float>::infinity()};
+    float m_max{-std::numeric_limits<float>::infinity()};
+};
+
+}
@@ -0,0 +1,186 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/DataStructs.hpp"
+
+#include "VoxelValues.hpp"
+
+namespace yagit{
+
+namespace{
+// Image stored in bricks of BrickSize x BrickSize x BrickSize voxels.
+// Voxels of one brick are contiguous in memory, so voxels adjacent along any axis
+// (e.g. 8 corners used in trilinear interpolation) mostly lie in the same cache lines and memory pages.
+// Image has a halo - one additional voxel at the end of each axis that replicates the last voxel,
+// so interpolation at the last voxel can read the next voxel without clamping its index (it has zero weight there).
+// Image is also padded with zeros to the multiple of BrickSize along each axis.
+// Values is a policy of stored values (see VoxelValues.hpp).
+template <typename Values = FloatValues>
+class BrickedImage{
+public:
+    using value_type = typename Values::storage_type;
+
+    static constexpr uint32_t BrickShift = 2;
+    static constexpr uint32_t BrickSize = 1 << BrickShift;
+    static constexpr uint32_t BrickMask = BrickSize - 1;
+
+    explicit BrickedImage(const ImageView& image)
+        : m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()){
+        static_assert(std::is_same_v<value_type, float>, "ImageView can be stored only as float");
+        allocate();
+        if(image.size() == 0){
+            return;
+        }
+        for(uint32_t k = 0; k <= m_size.frames; k++){
+            const uint32_t kImg = std::min(k, m_size.frames - 1);
+            copyFrame(k, [&](uint32_t j, uint32_t i){ return image.get(kImg, j, i); });
+        }
+    }
+
+    // with FloatValues image is widened to float frame by frame while it is copied,
+    // with compact values policy (that must match format of image) its raw 16-bit values are copied
+    explicit BrickedImage(const CompactImageData& image)
+        : m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()){
+        allocate();
+        if(image.size() == 0){
+            return;
+        }
+        // halo frame replicates the last frame
+        if constexpr(std::is_same_v<value_type, float>){
+            ImageData::container_type frame;
+            for(uint32_t k = 0; k <= m_size.frames; k++){
+                if(k < m_size.frames){
+                    frame = image.readFrames(k, 1);
+                }
+                copyFrame(k, [&](uint32_t j, uint32_t i){ return frame[static_cast<size_t>(j) * m_size.columns + i]; });
+            }
+        }
+        else{
+            m_values = Values(image);
+            for(uint32_t k = 0; k <= m_size.frames; k++){
+                const size_t kImg = std::min(k, m_size.frames - 1);
+                const value_type* frame = image.data() + kImg * m_size.rows * m_size.columns;
+                copyFrame(k, [&](uint32_t j, uint32_t i){ return frame[static_cast<size_t>(j) * m_size.columns + i]; });
+            }
+        }
+    }
+
+    float get(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_values(m_data[index(frame, row, column)]);
+    }
+
+    // address of voxel (e.g. to prefetch it)
+    const value_type* getAddress(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_data.data() + index(frame, row, column);
+    }
+
+    // Index of voxel is frameOffset(frame) + rowOffset(row) + columnOffset(column).
+    // They are exposed, so that vectorized code can gather voxels from data()
+    // (it has stored values, see widen)
+    const value_type* data() const{
+        return m_data.data();
+    }
+    size_t frameOffset(uint32_t frame) const{
+        return m_frameOffsets[frame];
+    }
+    size_t rowOffset(uint32_t row) const{
+        return m_rowOffsets[row];
+    }
+    // it works also for SIMD vectors of indices
+    template <typename T>
+    static T columnOffset(const T& column){
+        const T columnInBrick = column & T(BrickMask);
+        return (column - columnInBrick) * T(BrickSize * BrickSize) + columnInBrick;
+    }
+
+    DataSize getSize() const{
+        return m_size;
+    }
+    DataOffset getOffset() const{
+        return m_offset;
+    }
+    DataSpacing getSpacing() const{
+        return m_spacing;
+    }
+
+    // stored value widened to float
+    float widen(value_type value) const{
+        return m_values(value);
+    }
+
+private:
+    void allocate(){
+        const DataSize haloSize{m_size.frames + 1, m_size.rows + 1, m_size.columns + 1};
+        const size_t bricksFrames = (haloSize.frames + BrickMask) >> BrickShift;
+        const size_t bricksRows = (haloSize.rows + BrickMask) >> BrickShift;
+        const size_t bricksColumns = (haloSize.columns + BrickMask) >> BrickShift;
+        m_data.resize((bricksFrames * bricksRows * bricksColumns) << (3 * BrickShift), value_type{0});
+
+        // index of voxel is a sum of offsets along each axis, so they are precalculated
+        const size_t brickVolume = static_cast<size_t>(1) << (3 * BrickShift);
+        m_frameOffsets = generateAxisOffsets(haloSize.frames, bricksRows * bricksColumns * brickVolume, 2 * BrickShift);
+        m_rowOffsets = generateAxisOffsets(haloSize.rows, bricksColumns * brickVolume, BrickShift);
+        m_columnOffsets = generateAxisOffsets(haloSize.columns, brickVolume, 0);
+    }
+
+    // copies frame of image (with halo row and column) to frame k of bricked image,
+    // getValue(row, column) returns voxel of the frame
+    template <typename GetValue>
+    void copyFrame(uint32_t k, GetValue&& getValue){
+        for(uint32_t j = 0; j <= m_size.rows; j++){
+            const uint32_t jImg = std::min(j, m_size.rows - 1);
+            for(uint32_t i = 0; i <= m_size.columns; i++){
+                const uint32_t iImg = std::min(i, m_size.columns - 1);
+                m_data[index(k, j, i)] = getValue(jImg, iImg);
+            }
+        }
+    }
+
+    static std::vector<size_t> generateAxisOffsets(uint32_t size, size_t brickStride, uint32_t shiftInBrick){
+        std::vector<size_t> offsets(size);
+        for(uint32_t v = 0; v < size; v++){
+            offsets[v] = (v >> BrickShift) * brickStride + (static_cast<size_t>(v & BrickMask) << shiftInBrick);
+        }
+        return offsets;
+    }
+
+    size_t index(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_frameOffsets[frame] + m_rowOffsets[row] + m_columnOffsets[column];
+    }
+
+    DataSize m_size;
+    DataOffset m_offset;
+    DataSpacing m_spacing;
+    std::vector<size_t> m_frameOffsets;
+    std::vector<size_t> m_rowOffsets;
+    std::vector<size_t> m_columnOffsets;
+    std::vector<value_type> m_data;
+    Values m_values;
+};
+}
+
+}
@@ -0,0 +1,318 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+#include "yagit/GammaParameters.hpp"
+#include "yagit/GammaResult.hpp"
+#include "yagit/Interpolation.hpp"
+
+#include "GammaCommon.hpp"
+#include "BrickedImage.hpp"
+#include "PaddedImage.hpp"
+#include "WendlingSearch.hpp"
+
+namespace yagit{
+
+// Chi method (https://doi.org/10.1088/0031-9155/48/21/006) approximates gamma index in a single local pass:
+// chi = (Deval - Dref) / sqrt(DD^2 + DTA^2 * |grad Dref|^2),
+// where gradient of reference dose is calculated with central differences (one-sided at the borders).
+// Absolute value of chi is returned, so it can be interpreted like gamma index (voxel passes if it is <= 1).
+// Rows of reference image are independent, so Execution policy splits them among threads,
+// and the kernel processing one row (RowKernel) is also a policy, so it can be replaced with the vectorized one.
+namespace{
+// number of rows in one task of ThreadedExecution
+constexpr uint32_t ChiRowsPerTile = 16;
+
+// reference rows and evaluated doses needed to calculate chi in one row of reference image
+struct ChiRow{
+    const float* ref;
+    // gradient along Y is (refYNext[i] - refYPrev[i]) * yFactor (and similarly along Z)
+    const float* refYPrev;
+    const float* refYNext;
+    float yFactor;
+    const float* refZPrev;
+    const float* refZNext;
+    float zFactor;
+    // evaluated doses at positions of reference voxels (NaN outside evaluated image)
+    const float* eval;
+    uint32_t columns;
+    // gradient along X inside the row is (ref[i + 1] - ref[i - 1]) * xFactor
+    float xFactor;
+};
+
+// neighbours used to calculate the central difference at index along axis and its factor
+struct CentralDifference{
+    uint32_t prev;
+    uint32_t next;
+    float factor;
+};
+
+CentralDifference centralDifference(uint32_t index, uint32_t size, float spacing){
+    if(size == 1){
+        return {index, index, 0.0f};
+    }
+    else if(index == 0){
+        return {0, 1, 1 / spacing};
+    }
+    else if(index == size - 1){
+        return {size - 2, size - 1, 1 / spacing};
+    }
+    return {index - 1, index + 1, 1 / (2 * spacing)};
+}
+
+template <typename Normalization>
+float chiValue(const Normalization& normalization, float dtaSq, float doseCutoff,
+               float doseRef, float doseEval, float gradSq){
+    if(doseRef < doseCutoff || Normalization::isDivisionByZero(doseRef)){
+        return NaN;
+    }
+    // chi^2 = (Deval - Dref)^2 / (DD^2 + DTA^2 * |grad|^2), where numerator and denominator are divided by DD^2
+    const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+    return std::sqrt(distSq1D(doseEval, doseRef) * ddNormInvSq / (1 + dtaSq * gradSq * ddNormInvSq));
+}
+
+// gradient of reference dose along X at column i (one-sided at the borders)
+float gradientX(const ChiRow& row, uint32_t i){
+    if(row.columns == 1){
+        return 0.0f;
+    }
+    else if(i == 0){
+        return (row.ref[1] - row.ref[0]) * (2 * row.xFactor);
+    }
+    else if(i == row.columns - 1){
+        return (row.ref[i] - row.ref[i - 1]) * (2 * row.xFactor);
+    }
+    return (row.ref[i + 1] - row.ref[i - 1]) * row.xFactor;
+}
+
+// kernel calculating chi in one row, one voxel at a time
+struct ChiRowKernel{
+    template <typename Normalization>
+    static void calc(const ChiRow& row, const GammaParameters& gammaParams, float* chiRow){
+        calcRange<Normalization>(row, gammaParams, 0, row.columns, chiRow);
+    }
+
+    // calculate chi for columns [iBegin, iEnd) of the row
+    template <typename Normalization>
+    static void calcRange(const ChiRow& row, const GammaParameters& gammaParams,
+                          uint32_t iBegin, uint32_t iEnd, float* chiRow){
+        const Normalization normalization(gammaParams);
+        const float dtaSq = gammaParams.dtaThreshold * gammaParams.dtaThreshold;
+
+        for(uint32_t i = iBegin; i < iEnd; i++){
+            const float gradX = gradientX(row, i);
+            const float gradY = (row.refYNext[i] - row.refYPrev[i]) * row.yFactor;
+            const float gradZ = (row.refZNext[i] - row.refZPrev[i]) * row.zFactor;
+            const float gradSq = gradX * gradX + gradY * gradY + gradZ * gradZ;
+
+            chiRow[i] = chiValue(normalization, dtaSq, gammaParams.doseCutoff, row.ref[i], row.eval[i], gradSq);
+        }
+    }
+};
+
+// evaluated doses linearly interpolated at positions of reference voxels (NaN outside evaluated image).
+// Frame k of reference image corresponds to frame k + kDiff of evaluated image,
+// and only y and x coordinates are used (it's for 2D and 2.5D versions)
+std::vector<float> evalDosesOnRefGrid2D(const ImageView& refImg, const ImageView& evalImg, int kDiff){
+    const DataSize& refSize = refImg.getSize();
+    const DataSize& evalSize = evalImg.getSize();
+    const bool sameGrid = kDiff == 0 && refSize == evalSize &&
+                          refImg.getOffset().rows == evalImg.getOffset().rows &&
+                          refImg.getOffset().columns == evalImg.getOffset().columns &&
+                          refImg.getSpacing().rows == evalImg.getSpacing().rows &&
+                          refImg.getSpacing().columns == evalImg.getSpacing().columns;
+    if(sameGrid){
+        return evalImg.getData();
+    }
+
+    std::vector<float> evalDoses(refImg.size(), NaN);
+    if(evalImg.size() == 0){
+        return evalDoses;
+    }
+    const PaddedImage<> evalImgPadded(evalImg, 1);
+    const EvalGrid evalGrid(evalImgPadded);
+
+    size_t index = 0;
+    for(uint32_t k = 0; k < refSize.frames; k++){
+        const int ke = static_cast<int>(k) + kDiff;
+        if(ke < 0 || ke >= static_cast<int>(evalSize.frames)){
+            index += static_cast<size_t>(refSize.rows) * refSize.columns;
+            continue;
+        }
+        for(uint32_t j = 0; j < refSize.rows; j++){
+            const float y = refImg.getOffset().rows + j * refImg.getSpacing().rows;
+            for(uint32_t i = 0; i < refSize.columns; i++){
+                const float x = refImg.getOffset().columns + i * refImg.getSpacing().columns;
+                if(y >= evalGrid.yMin && y <= evalGrid.yMax && x >= evalGrid.xMin && x <= evalGrid.xMax){
+                    evalDoses[index] = LinearInterpolation::at2D(evalImgPadded, ke, evalGrid, y, x);
+                }
+                index++;
+            }
+        }
+    }
+    return evalDoses;
+}
+
+std::vector<float> evalDosesOnRefGrid3D(const ImageView& refImg, const ImageView& evalImg){
+    const DataSize& refSize = refImg.getSize();
+    if(refSize == evalImg.getSize() && refImg.getOffset() == evalImg.getOffset() &&
+       refImg.getSpacing() == evalImg.getSpacing()){
+        return evalImg.getData();
+    }
+
+    std::vector<float> evalDoses(refImg.size(), NaN);
+    if(evalImg.size() == 0){
+        return evalDoses;
+    }
+    const BrickedImage<> evalImgBricked(evalImg);
+    const EvalGrid evalGrid(evalImgBricked);
+
+    size_t index = 0;
+    for(uint32_t k = 0; k < refSize.frames; k++){
+        const float z = refImg.getOffset().frames + k * refImg.getSpacing().frames;
+        for(uint32_t j = 0; j < refSize.rows; j++){
+            const float y = refImg.getOffset().rows + j * refImg.getSpacing().rows;
+            for(uint32_t i = 0; i < refSize.columns; i++){
+                const float x = refImg.getOffset().columns + i * refImg.getSpacing().columns;
+                if(z >= evalGrid.zMin && z <= evalGrid.zMax &&
+                   y >= evalGrid.yMin && y <= evalGrid.yMax && x >= evalGrid.xMin && x <= evalGrid.xMax){
+                    evalDoses[index] = LinearInterpolation::at3D(evalImgBricked, evalGrid, z, y, x);
+                }
+                index++;
+            }
+        }
+    }
+    return evalDoses;
+}
+
+// calculate chi in tiles [startTile, endTile), where each tile has ChiRowsPerTile rows of reference image
+// (rows are counted through all frames). Gradient along Z is used only if gradientZ is true
+template <typename Normalization, typename RowKernel>
+void gammaIndexChiInternal(const ImageView& refImg, const std::vector<float>& evalDoses,
+                           const GammaParameters& gammaParams, bool gradientZ,
+                           size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const DataSize& size = refImg.getSize();
+    const size_t frameSize = static_cast<size_t>(size.rows) * size.columns;
+    const size_t nrOfRows = static_cast<size_t>(size.frames) * size.rows;
+
+    ChiRow row;
+    row.columns = size.columns;
+    row.xFactor = 1 / (2 * refImg.getSpacing().columns);
+
+    const size_t endRow = std::min(endTile * ChiRowsPerTile, nrOfRows);
+    for(size_t r = startTile * ChiRowsPerTile; r < endRow; r++){
+        const uint32_t k = static_cast<uint32_t>(r / size.rows);
+        const uint32_t j = static_cast<uint32_t>(r % size.rows);
+        const size_t rowOffset = k * frameSize + static_cast<size_t>(j) * size.columns;
+
+        const CentralDifference y = centralDifference(j, size.rows, refImg.getSpacing().rows);
+        const CentralDifference z = gradientZ ? centralDifference(k, size.frames, refImg.getSpacing().frames) :
+                                                CentralDifference{k, k, 0.0f};
+
+        row.ref = refImg.data() + rowOffset;
+        row.refYPrev = refImg.data() + k * frameSize + static_cast<size_t>(y.prev) * size.columns;
+        row.refYNext = refImg.data() + k * frameSize + static_cast<size_t>(y.next) * size.columns;
+        row.yFactor = y.factor;
+        row.refZPrev = refImg.data() + z.prev * frameSize + static_cast<size_t>(j) * size.columns;
+        row.refZNext = refImg.data() + z.next * frameSize + static_cast<size_t>(j) * size.columns;
+        row.zFactor = z.factor;
+        row.eval = evalDoses.data() + rowOffset;
+
+        RowKernel::template calc<Normalization>(row, gammaParams, gammaVals.data() + rowOffset);
+    }
+}
+
+template <typename Execution, typename RowKernel>
+GammaValues gammaIndexChi(const ImageView& refImg, const std::vector<float>& evalDoses,
+                          const GammaParameters& gammaParams, bool gradientZ){
+    const size_t nrOfRows = static_cast<size_t>(refImg.getSize().frames) * refImg.getSize().rows;
+    const size_t nrOfTiles = (nrOfRows + ChiRowsPerTile - 1) / ChiRowsPerTile;
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachTile(refImg.size(), nrOfTiles, gammaIndexChiInternal<Normalization, RowKernel>,
+                                      std::cref(refImg), std::cref(evalDoses), std::cref(gammaParams), std::cref(gradientZ));
+    });
+}
+
+template <typename Execution, typename RowKernel = ChiRowKernel>
+GammaResult gammaIndex2DChiImpl(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                const GammaParameters& gammaParams){
+    if(!refImg2D.isContiguous() || !evalImg2D.isContiguous()){
+        return gammaIndex2DChiImpl<Execution, RowKernel>(ContiguousImage(refImg2D), ContiguousImage(evalImg2D),
+                                                         gammaParams);
+    }
+
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+
+    const std::vector<float> evalDoses = evalDosesOnRefGrid2D(refImg2D, evalImg2D, 0);
+    GammaValues gammaVals = gammaIndexChi<Execution, RowKernel>(refImg2D, evalDoses, gammaParams, false);
+
+    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+}
+
+template <typename Execution, typename RowKernel = ChiRowKernel>
+GammaResult gammaIndex2_5DChiImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                  const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex2_5DChiImpl<Execution, RowKernel>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                           gammaParams);
+    }
+
+    validateGammaParameters(gammaParams);
+
+    // evaluated image is interpolated along Z to have frames at the same positions as reference image
+    // (like in Wendling method)
+    const ImageData evalImgInterpolatedZ = Interpolation::linearAlongAxis(evalImg3D, refImg3D, ImageAxis::Z);
+    const int kDiff = static_cast<int>((refImg3D.getOffset().frames - evalImgInterpolatedZ.getOffset().frames) /
+                                       refImg3D.getSpacing().frames);
+
+    const std::vector<float> evalDoses = evalDosesOnRefGrid2D(refImg3D, evalImgInterpolatedZ, kDiff);
+    GammaValues gammaVals = gammaIndexChi<Execution, RowKernel>(refImg3D, evalDoses, gammaParams, false);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+
+template <typename Execution, typename RowKernel = ChiRowKernel>
+GammaResult gammaIndex3DChiImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex3DChiImpl<Execution, RowKernel>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                         gammaParams);
+    }
+
+    validateGammaParameters(gammaParams);
+
+    const std::vector<float> evalDoses = evalDosesOnRefGrid3D(refImg3D, evalImg3D);
+    GammaValues gammaVals = gammaIndexChi<Execution, RowKernel>(refImg3D, evalDoses, gammaParams, true);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+}
+
+}
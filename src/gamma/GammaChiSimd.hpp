@@ -0,0 +1,85 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+#include "yagit/GammaParameters.hpp"
+
+#include "GammaCommonSimd.hpp"
+#include "GammaChi.hpp"
+
+#include <xsimd/xsimd.hpp>
+
+namespace yagit{
+
+// Vectorized kernel of chi method shared by SIMD and multithreaded SIMD versions (see GammaChi.hpp).
+// Gradients along all axes are calculated from unaligned loads of neighbouring voxels,
+// so only the first and the last voxels of the row (with one-sided differences along X)
+// and the remainder are calculated by the scalar kernel.
+namespace{
+struct ChiRowKernelSimd{
+    template <typename Normalization>
+    static void calc(const ChiRow& row, const GammaParameters& gammaParams, float* chiRow){
+        if(row.columns < SimdElementCount + 2){
+            ChiRowKernel::calcRange<Normalization>(row, gammaParams, 0, row.columns, chiRow);
+            return;
+        }
+
+        const Normalization normalization(gammaParams);
+
+        const xsimd::batch<float> dtaSqVec(gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+        const xsimd::batch<float> doseCutoffVec(gammaParams.doseCutoff);
+        const xsimd::batch<float> xFactorVec(row.xFactor);
+        const xsimd::batch<float> yFactorVec(row.yFactor);
+        const xsimd::batch<float> zFactorVec(row.zFactor);
+        const xsimd::batch<float> oneVec(1.0f);
+        const xsimd::batch<float> zeroVec(0.0f);
+        const xsimd::batch<float> nanVec(NaN);
+
+        // interior columns [1, vecEnd) are processed in vectors
+        const uint32_t vecEnd = 1 + (row.columns - 2) / SimdElementCount * SimdElementCount;
+
+        ChiRowKernel::calcRange<Normalization>(row, gammaParams, 0, 1, chiRow);
+        for(uint32_t i = 1; i < vecEnd; i += SimdElementCount){
+            const auto doseRefVec = xsimd::load_unaligned(&row.ref[i]);
+            const auto doseEvalVec = xsimd::load_unaligned(&row.eval[i]);
+
+            const auto gradXVec = (xsimd::load_unaligned(&row.ref[i + 1]) - xsimd::load_unaligned(&row.ref[i - 1])) * xFactorVec;
+            const auto gradYVec = (xsimd::load_unaligned(&row.refYNext[i]) - xsimd::load_unaligned(&row.refYPrev[i])) * yFactorVec;
+            const auto gradZVec = (xsimd::load_unaligned(&row.refZNext[i]) - xsimd::load_unaligned(&row.refZPrev[i])) * zFactorVec;
+            const auto gradSqVec = gradXVec * gradXVec + gradYVec * gradYVec + gradZVec * gradZVec;
+
+            // see chiValue
+            const auto ddNormInvSqVec = normalization.ddNormInvSq(doseRefVec);
+            const auto ddVec = doseEvalVec - doseRefVec;
+            const auto chiVec = xsimd::sqrt(ddVec * ddVec * ddNormInvSqVec / (oneVec + dtaSqVec * gradSqVec * ddNormInvSqVec));
+
+            auto invalid = doseRefVec < doseCutoffVec;
+            if constexpr(Normalization::isDivisionByZero(0.0f)){
+                invalid = invalid | (doseRefVec == zeroVec);
+            }
+            xsimd::store_unaligned(&chiRow[i], xsimd::select(invalid, nanVec, chiVec));
+        }
+        ChiRowKernel::calcRange<Normalization>(row, gammaParams, vecEnd, row.columns, chiRow);
+    }
+};
+}
+
+}
@@ -0,0 +1,276 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <functional>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/GammaParameters.hpp"
+#include "yagit/GammaResult.hpp"
+
+#include "GammaCommon.hpp"
+
+namespace yagit{
+
+// Kernels of classic method shared by sequential and multithreaded versions.
+// They are specialized at compile time for the type of normalization, and the *Impl functions
+// run them with Execution policy (SequentialExecution or ThreadedExecution).
+namespace{
+template <typename Normalization>
+void gammaIndex2DClassicInternal(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                 const GammaParameters& gammaParams,
+                                 const std::vector<float>& yr, const std::vector<float>& xr,
+                                 const std::vector<float>& ye, const std::vector<float>& xe,
+                                 size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const auto [jStart, iStart] = indexTo2Dindex(startIndex, refImg2D.getSize());
+
+    // iterate over each row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t jr = jStart; jr < refImg2D.getSize().rows && indRef < endIndex; jr++){
+        const uint32_t iStart2 = (jr != jStart ? 0 : iStart);
+
+        for(uint32_t ir = iStart2; ir < refImg2D.getSize().columns && indRef < endIndex; ir++){
+            if(gammaVals[indRef] == Inf){
+                float doseRef = refImg2D.get(indRef);
+
+                float minGammaValSq = Inf;
+                const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+
+                // iterate over each row and column of evaluated image
+                size_t indEval = 0;
+                for(uint32_t je = 0; je < evalImg2D.getSize().rows; je++){
+                    for(uint32_t ie = 0; ie < evalImg2D.getSize().columns; ie++){
+                        float doseEval = evalImg2D.get(indEval);
+                        // calculate squared gamma
+                        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
+                                           distSq2D(xe[ie], ye[je], xr[ir], yr[jr]) * dtaInvSq;
+                        if(gammaValSq < minGammaValSq){
+                            minGammaValSq = gammaValSq;
+                        }
+
+                        indEval++;
+                    }
+                }
+
+                gammaVals[indRef] = std::sqrt(minGammaValSq);
+            }
+
+            indRef++;
+        }
+    }
+}
+
+template <typename Normalization>
+void gammaIndex2_5DClassicInternal(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                   const GammaParameters& gammaParams,
+                                   const std::vector<float>& zr, const std::vector<float>& yr,
+                                   const std::vector<float>& xr, const std::vector<float>& ze,
+                                   const std::vector<float>& ye, const std::vector<float>& xe,
+                                   size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
+
+    // iterate over each frame, row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
+
+        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
+        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
+
+            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
+            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
+                if(gammaVals[indRef] == Inf){
+                    float doseRef = refImg3D.get(indRef);
+
+                    const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+                    float minGammaValSq = Inf;
+
+                    // iterate over each row and column of evaluated image
+                    size_t indEval = kr * evalImg3D.getSize().rows * evalImg3D.getSize().columns;
+                    for(uint32_t je = 0; je < evalImg3D.getSize().rows; je++){
+                        for(uint32_t ie = 0; ie < evalImg3D.getSize().columns; ie++){
+                            float doseEval = evalImg3D.get(indEval);
+                            // calculate squared gamma
+                            float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
+                                               distSq3D(xe[ie], ye[je], ze[kr], xr[ir], yr[jr], zr[kr]) * dtaInvSq;
+                            if(gammaValSq < minGammaValSq){
+                                minGammaValSq = gammaValSq;
+                            }
+                            indEval++;
+                        }
+                    }
+
+                    gammaVals[indRef] = std::sqrt(minGammaValSq);
+                }
+
+                indRef++;
+            }
+        }
+    }
+}
+
+template <typename Normalization>
+void gammaIndex3DClassicInternal(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                 const GammaParameters& gammaParams,
+                                 const std::vector<float>& zr, const std::vector<float>& yr,
+                                 const std::vector<float>& xr, const std::vector<float>& ze,
+                                 const std::vector<float>& ye, const std::vector<float>& xe,
+                                 size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
+
+    // iterate over each frame, row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
+
+        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
+        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
+
+            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
+            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
+                if(gammaVals[indRef] == Inf){
+                    float doseRef = refImg3D.get(indRef);
+
+                    const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+                    float minGammaValSq = Inf;
+
+                    // iterate over each frame, row and column of evaluated image
+                    size_t indEval = 0;
+                    for(uint32_t ke = 0; ke < evalImg3D.getSize().frames; ke++){
+                        for(uint32_t je = 0; je < evalImg3D.getSize().rows; je++){
+                            for(uint32_t ie = 0; ie < evalImg3D.getSize().columns; ie++){
+                                float doseEval = evalImg3D.get(indEval);
+                                // calculate squared gamma
+                                float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
+                                                   distSq3D(xe[ie], ye[je], ze[ke], xr[ir], yr[jr], zr[kr]) * dtaInvSq;
+                                if(gammaValSq < minGammaValSq){
+                                    minGammaValSq = gammaValSq;
+                                }
+
+                                indEval++;
+                            }
+                        }
+                    }
+
+                    gammaVals[indRef] = std::sqrt(minGammaValSq);
+                }
+
+                indRef++;
+            }
+        }
+    }
+}
+
+template <typename Execution>
+GammaResult gammaIndex2DClassicImpl(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                    const GammaParameters& gammaParams){
+    if(!refImg2D.isContiguous() || !evalImg2D.isContiguous()){
+        return gammaIndex2DClassicImpl<Execution>(ContiguousImage(refImg2D), ContiguousImage(evalImg2D),
+                                                  gammaParams);
+    }
+
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+
+    const std::vector<float> yr = generateCoordinates(refImg2D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg2D, ImageAxis::X);
+    const std::vector<float> ye = generateCoordinates(evalImg2D, ImageAxis::Y);
+    const std::vector<float> xe = generateCoordinates(evalImg2D, ImageAxis::X);
+
+    GammaValues gammaVals = dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg2D, gammaParams, gammaIndex2DClassicInternal<Normalization>,
+                                       std::cref(refImg2D), std::cref(evalImg2D), std::cref(gammaParams),
+                                       std::cref(yr), std::cref(xr),
+                                       std::cref(ye), std::cref(xe));
+    });
+
+    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+}
+
+template <typename Execution>
+GammaResult gammaIndex2_5DClassicImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                      const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex2_5DClassicImpl<Execution>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                    gammaParams);
+    }
+
+    if(evalImg3D.getSize().frames < refImg3D.getSize().frames){
+        throw std::invalid_argument("evaluated image must have at least the same number of frames as the reference image");
+    }
+    validateGammaParameters(gammaParams);
+
+    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
+    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
+    const std::vector<float> ze = generateCoordinates(evalImg3D, ImageAxis::Z);
+    const std::vector<float> ye = generateCoordinates(evalImg3D, ImageAxis::Y);
+    const std::vector<float> xe = generateCoordinates(evalImg3D, ImageAxis::X);
+
+    GammaValues gammaVals = dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg3D, gammaParams, gammaIndex2_5DClassicInternal<Normalization>,
+                                       std::cref(refImg3D), std::cref(evalImg3D), std::cref(gammaParams),
+                                       std::cref(zr), std::cref(yr), std::cref(xr),
+                                       std::cref(ze), std::cref(ye), std::cref(xe));
+    });
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+
+template <typename Execution>
+GammaResult gammaIndex3DClassicImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                    const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex3DClassicImpl<Execution>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                  gammaParams);
+    }
+
+    validateGammaParameters(gammaParams);
+
+    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
+    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
+    const std::vector<float> ze = generateCoordinates(evalImg3D, ImageAxis::Z);
+    const std::vector<float> ye = generateCoordinates(evalImg3D, ImageAxis::Y);
+    const std::vector<float> xe = generateCoordinates(evalImg3D, ImageAxis::X);
+
+    GammaValues gammaVals = dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg3D, gammaParams, gammaIndex3DClassicInternal<Normalization>,
+                                       std::cref(refImg3D), std::cref(evalImg3D), std::cref(gammaParams),
+                                       std::cref(zr), std::cref(yr), std::cref(xr),
+                                       std::cref(ze), std::cref(ye), std::cref(xe));
+    });
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+}
+
+}
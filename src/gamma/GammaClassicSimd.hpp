@@ -0,0 +1,440 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <functional>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/GammaParameters.hpp"
+#include "yagit/GammaResult.hpp"
+
+#include "GammaCommonSimd.hpp"
+#include "GammaCompact.hpp"
+#include "PaddedImage.hpp"
+#include "VoxelValues.hpp"
+
+#include <xsimd/xsimd.hpp>
+
+namespace yagit{
+
+// Vectorized kernels of classic method shared by SIMD and multithreaded SIMD versions
+// (see GammaClassic.hpp).
+// Reference voxels are processed in tiles of ClassicRefTileSize voxels of the same row. Each vector of evaluated
+// image is loaded once per tile and compared with all voxels of the tile, which keep separate running minima
+// in registers (like micro-kernels of matrix multiplication), so evaluated image is streamed from memory
+// ClassicRefTileSize times less often.
+// Evaluated image is a padded image of float or of raw 16-bit values of CompactImageData,
+// which are widened in registers when they are loaded (see loadValues).
+namespace{
+constexpr size_t ClassicRefTileSize = 4;
+
+// pending reference voxels of one row, broadcasted to SIMD vectors
+struct ClassicRefTile{
+    std::array<size_t, ClassicRefTileSize> indices;
+    std::array<xsimd::batch<float>, ClassicRefTileSize> doseRef;
+    std::array<xsimd::batch<float>, ClassicRefTileSize> ddNormInvSq;
+    std::array<xsimd::batch<float>, ClassicRefTileSize> xr;
+    size_t count = 0;
+
+    void add(size_t indRef, float dose, float ddNormInvSqVal, float x){
+        indices[count] = indRef;
+        doseRef[count] = xsimd::batch<float>(dose);
+        ddNormInvSq[count] = xsimd::batch<float>(ddNormInvSqVal);
+        xr[count] = xsimd::batch<float>(x);
+        count++;
+    }
+
+    bool isFull() const{
+        return count == ClassicRefTileSize;
+    }
+};
+
+// calculate gamma of all voxels of the tile and empty it,
+// forEachEvalRow must call its argument with each row of evaluated image (stored values of Values policy)
+// and its squared distance from the tile in Y and Z axes
+template <typename Values, typename ForEachEvalRow>
+void calcGammaValsTile(ClassicRefTile& tile, const aligned_vector<float>& xe, uint32_t paddedColumns,
+                       const Values& values, const xsimd::batch<float>& dtaInvSqVec, ForEachEvalRow&& forEachEvalRow,
+                       GammaValues& gammaVals){
+    if(tile.count == 0){
+        return;
+    }
+    // unused slots are filled with copies of the last voxel, so the kernel always processes the whole tile
+    for(size_t t = tile.count; t < ClassicRefTileSize; t++){
+        tile.doseRef[t] = tile.doseRef[tile.count - 1];
+        tile.ddNormInvSq[t] = tile.ddNormInvSq[tile.count - 1];
+        tile.xr[t] = tile.xr[tile.count - 1];
+    }
+
+    std::array<xsimd::batch<float>, ClassicRefTileSize> minGammaValSqVecs;
+    minGammaValSqVecs.fill(xsimd::batch<float>(Inf));
+
+    forEachEvalRow([&](const typename Values::storage_type* evalRow, float yzDistSq){
+        const xsimd::batch<float> yzDistSqVec(yzDistSq);
+
+        for(uint32_t ie = 0; ie < paddedColumns; ie += SimdElementCount){
+            const auto doseEvalVec = loadValues(values, &evalRow[ie]);
+            const auto xeVec = xsimd::load_aligned(&xe[ie]);
+
+            for(size_t t = 0; t < ClassicRefTileSize; t++){
+                // calculate squared gamma
+                // not using distSq1D and distSq2D functions, because this inlined version on simd vectors is faster
+                const auto ddVec = tile.doseRef[t] - doseEvalVec;
+                const auto dxVec = tile.xr[t] - xeVec;
+                const auto gammaValSqVec = ddVec * ddVec * tile.ddNormInvSq[t] + (dxVec * dxVec + yzDistSqVec) * dtaInvSqVec;
+
+                minGammaValSqVecs[t] = xsimd::min(gammaValSqVec, minGammaValSqVecs[t]);
+            }
+        }
+    });
+
+    for(size_t t = 0; t < tile.count; t++){
+        float minGammaValSq = xsimd::reduce_min(minGammaValSqVecs[t]);
+        gammaVals[tile.indices[t]] = std::sqrt(minGammaValSq);
+    }
+    tile.count = 0;
+}
+
+template <typename Normalization, typename EvalImage>
+void gammaIndex2DClassicInternal(const ImageView& refImg2D, const EvalImage& evalImgPadded,
+                                 const GammaParameters& gammaParams,
+                                 const std::vector<float>& yr, const std::vector<float>& xr,
+                                 const std::vector<float>& ye, const aligned_vector<float>& xe,
+                                 size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const xsimd::batch<float> dtaInvSqVec(dtaInvSq);
+
+    const auto [jStart, iStart] = indexTo2Dindex(startIndex, refImg2D.getSize());
+
+    ClassicRefTile tile;
+
+    // iterate over each row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t jr = jStart; jr < refImg2D.getSize().rows && indRef < endIndex; jr++){
+        // iterate over each row of evaluated image
+        auto forEachEvalRow = [&](auto&& func){
+            for(uint32_t je = 0; je < evalImgPadded.getSize().rows; je++){
+                func(evalImgPadded.getRow(0, je), (yr[jr] - ye[je]) * (yr[jr] - ye[je]));
+            }
+        };
+
+        const uint32_t iStart2 = (jr != jStart ? 0 : iStart);
+        for(uint32_t ir = iStart2; ir < refImg2D.getSize().columns && indRef < endIndex; ir++){
+            if(gammaVals[indRef] == Inf){
+                float doseRef = refImg2D.get(indRef);
+                tile.add(indRef, doseRef, normalization.ddNormInvSq(doseRef), xr[ir]);
+                if(tile.isFull()){
+                    calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                                      forEachEvalRow, gammaVals);
+                }
+            }
+
+            indRef++;
+        }
+        calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                          forEachEvalRow, gammaVals);
+    }
+}
+
+// reference frame kr is compared with evaluated frame kr + evalFrameBegin
+template <typename Normalization, typename EvalImage>
+void gammaIndex2_5DClassicInternal(const ImageView& refImg3D, const EvalImage& evalImgPadded,
+                                   const GammaParameters& gammaParams,
+                                   const std::vector<float>& zr, const std::vector<float>& yr,
+                                   const std::vector<float>& xr, const std::vector<float>& ze,
+                                   const std::vector<float>& ye, const aligned_vector<float>& xe,
+                                   uint32_t evalFrameBegin,
+                                   size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const xsimd::batch<float> dtaInvSqVec(dtaInvSq);
+
+    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
+
+    ClassicRefTile tile;
+
+    // iterate over each frame, row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
+        const uint32_t ke = kr + evalFrameBegin;
+        const float zDistSq = (zr[kr] - ze[ke]) * (zr[kr] - ze[ke]);
+
+        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
+        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
+            // iterate over each row of the same frame of evaluated image
+            auto forEachEvalRow = [&](auto&& func){
+                for(uint32_t je = 0; je < evalImgPadded.getSize().rows; je++){
+                    func(evalImgPadded.getRow(ke, je), (yr[jr] - ye[je]) * (yr[jr] - ye[je]) + zDistSq);
+                }
+            };
+
+            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
+            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
+                if(gammaVals[indRef] == Inf){
+                    float doseRef = refImg3D.get(indRef);
+                    tile.add(indRef, doseRef, normalization.ddNormInvSq(doseRef), xr[ir]);
+                    if(tile.isFull()){
+                        calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                                          forEachEvalRow, gammaVals);
+                    }
+                }
+
+                indRef++;
+            }
+            calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                              forEachEvalRow, gammaVals);
+        }
+    }
+}
+
+template <typename Normalization, typename EvalImage>
+void gammaIndex3DClassicInternal(const ImageView& refImg3D, const EvalImage& evalImgPadded,
+                                 const GammaParameters& gammaParams,
+                                 const std::vector<float>& zr, const std::vector<float>& yr,
+                                 const std::vector<float>& xr, const std::vector<float>& ze,
+                                 const std::vector<float>& ye, const aligned_vector<float>& xe,
+                                 size_t startIndex, size_t endIndex, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const xsimd::batch<float> dtaInvSqVec(dtaInvSq);
+
+    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
+
+    ClassicRefTile tile;
+
+    // iterate over each frame, row and column of reference image
+    size_t indRef = startIndex;
+    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
+        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
+        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
+            // iterate over each frame and row of evaluated image
+            auto forEachEvalRow = [&](auto&& func){
+                for(uint32_t ke = 0; ke < evalImgPadded.getSize().frames; ke++){
+                    const float zDistSq = (zr[kr] - ze[ke]) * (zr[kr] - ze[ke]);
+                    for(uint32_t je = 0; je < evalImgPadded.getSize().rows; je++){
+                        func(evalImgPadded.getRow(ke, je), (yr[jr] - ye[je]) * (yr[jr] - ye[je]) + zDistSq);
+                    }
+                }
+            };
+
+            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
+            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
+                if(gammaVals[indRef] == Inf){
+                    float doseRef = refImg3D.get(indRef);
+                    tile.add(indRef, doseRef, normalization.ddNormInvSq(doseRef), xr[ir]);
+                    if(tile.isFull()){
+                        calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                                          forEachEvalRow, gammaVals);
+                    }
+                }
+
+                indRef++;
+            }
+            calcGammaValsTile(tile, xe, evalImgPadded.getPaddedColumns(), evalImgPadded.getValues(), dtaInvSqVec,
+                              forEachEvalRow, gammaVals);
+        }
+    }
+}
+
+// gamma index values of 2D classic method (shared by gammaIndex2DClassicImpl and its compact version),
+// evaluated image is AlignedPaddedImage or AlignedCompactPaddedImage without halo
+template <typename Execution, typename EvalImage>
+GammaValues gammaIndex2DClassicVals(const ImageView& refImg2D, const EvalImage& evalImgPadded,
+                                    const GammaParameters& gammaParams){
+    const std::vector<float> yr = generateCoordinates(refImg2D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg2D, ImageAxis::X);
+    const std::vector<float> ye = generateCoordinates(evalImgPadded, ImageAxis::Y);
+    const aligned_vector<float> xe = generatePaddedCoordinatesAligned(evalImgPadded, evalImgPadded.getPaddedColumns());
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg2D, gammaParams, gammaIndex2DClassicInternal<Normalization, EvalImage>,
+                                       std::cref(refImg2D), std::cref(evalImgPadded), std::cref(gammaParams),
+                                       std::cref(yr), std::cref(xr),
+                                       std::cref(ye), std::cref(xe));
+    });
+}
+
+template <typename Execution>
+GammaResult gammaIndex2DClassicImpl(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                    const GammaParameters& gammaParams){
+    if(!refImg2D.isContiguous() || !evalImg2D.isContiguous()){
+        return gammaIndex2DClassicImpl<Execution>(ContiguousImage(refImg2D), ContiguousImage(evalImg2D),
+                                                  gammaParams);
+    }
+
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+
+    // rows of evaluated image are padded to a multiple of SIMD width, so there is no scalar remainder loop
+    const AlignedPaddedImage evalImgPadded(evalImg2D, 0, SimdElementCount);
+
+    GammaValues gammaVals = gammaIndex2DClassicVals<Execution>(refImg2D, evalImgPadded, gammaParams);
+
+    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+}
+
+// gamma index values of 2.5D classic method (see gammaIndex2DClassicVals),
+// reference frames are compared with evaluated frames starting at evalFrameBegin
+template <typename Execution, typename EvalImage>
+GammaValues gammaIndex2_5DClassicVals(const ImageView& refImg3D, const EvalImage& evalImgPadded,
+                                      const GammaParameters& gammaParams, uint32_t evalFrameBegin = 0){
+    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
+    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
+    const std::vector<float> ze = generateCoordinates(evalImgPadded, ImageAxis::Z);
+    const std::vector<float> ye = generateCoordinates(evalImgPadded, ImageAxis::Y);
+    const aligned_vector<float> xe = generatePaddedCoordinatesAligned(evalImgPadded, evalImgPadded.getPaddedColumns());
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg3D, gammaParams, gammaIndex2_5DClassicInternal<Normalization, EvalImage>,
+                                       std::cref(refImg3D), std::cref(evalImgPadded), std::cref(gammaParams),
+                                       std::cref(zr), std::cref(yr), std::cref(xr),
+                                       std::cref(ze), std::cref(ye), std::cref(xe), evalFrameBegin);
+    });
+}
+
+template <typename Execution>
+GammaResult gammaIndex2_5DClassicImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                      const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex2_5DClassicImpl<Execution>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                    gammaParams);
+    }
+
+    if(evalImg3D.getSize().frames < refImg3D.getSize().frames){
+        throw std::invalid_argument("evaluated image must have at least the same number of frames as the reference image");
+    }
+    validateGammaParameters(gammaParams);
+
+    // rows of evaluated image are padded to a multiple of SIMD width, so there is no scalar remainder loop
+    const AlignedPaddedImage evalImgPadded(evalImg3D, 0, SimdElementCount);
+
+    GammaValues gammaVals = gammaIndex2_5DClassicVals<Execution>(refImg3D, evalImgPadded, gammaParams);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+
+// gamma index values of 3D classic method (see gammaIndex2DClassicVals)
+template <typename Execution, typename EvalImage>
+GammaValues gammaIndex3DClassicVals(const ImageView& refImg3D, const EvalImage& evalImgPadded,
+                                    const GammaParameters& gammaParams){
+    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
+    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
+    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
+    const std::vector<float> ze = generateCoordinates(evalImgPadded, ImageAxis::Z);
+    const std::vector<float> ye = generateCoordinates(evalImgPadded, ImageAxis::Y);
+    const aligned_vector<float> xe = generatePaddedCoordinatesAligned(evalImgPadded, evalImgPadded.getPaddedColumns());
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return Execution::forEachVoxel(refImg3D, gammaParams, gammaIndex3DClassicInternal<Normalization, EvalImage>,
+                                       std::cref(refImg3D), std::cref(evalImgPadded), std::cref(gammaParams),
+                                       std::cref(zr), std::cref(yr), std::cref(xr),
+                                       std::cref(ze), std::cref(ye), std::cref(xe));
+    });
+}
+
+template <typename Execution>
+GammaResult gammaIndex3DClassicImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                    const GammaParameters& gammaParams){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex3DClassicImpl<Execution>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                  gammaParams);
+    }
+
+    validateGammaParameters(gammaParams);
+
+    // rows of evaluated image are padded to a multiple of SIMD width, so there is no scalar remainder loop
+    const AlignedPaddedImage evalImgPadded(evalImg3D, 0, SimdElementCount);
+
+    GammaValues gammaVals = gammaIndex3DClassicVals<Execution>(refImg3D, evalImgPadded, gammaParams);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+}
+
+// Classic method of CompactImageData (replaces gammaIndex*ClassicCompactImpl of GammaCompact.hpp).
+// Reference image is widened in slabs like in GammaCompact.hpp, but evaluated image isn't widened at all -
+// its raw 16-bit values are padded once and the kernel widens them in registers,
+// so each reference slab is compared with the whole evaluated image in one pass.
+namespace{
+template <typename Execution>
+GammaResult gammaIndex2DClassicCompactSimdImpl(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                               const GammaParameters& gammaParams){
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+
+    return dispatchCompactValues(evalImg2D.getFormat(), [&](auto valuesTag){
+        using Values = typename decltype(valuesTag)::type;
+        const AlignedCompactPaddedImage<Values> evalImgPadded(evalImg2D, 0, SimdElementCount);
+
+        return gammaIndexBySlabs(refImg2D, 1, CompactSlabRows2D, [&](const ImageView& refSlab, uint32_t){
+            return gammaIndex2DClassicVals<Execution>(refSlab, evalImgPadded, gammaParams);
+        });
+    });
+}
+
+template <typename Execution>
+GammaResult gammaIndex2_5DClassicCompactSimdImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                                 const GammaParameters& gammaParams){
+    if(evalImg3D.getSize().frames < refImg3D.getSize().frames){
+        throw std::invalid_argument("evaluated image must have at least the same number of frames as the reference image");
+    }
+    validateGammaParameters(gammaParams);
+
+    return dispatchCompactValues(evalImg3D.getFormat(), [&](auto valuesTag){
+        using Values = typename decltype(valuesTag)::type;
+        const AlignedCompactPaddedImage<Values> evalImgPadded(evalImg3D, 0, SimdElementCount);
+
+        // reference frame is compared only with evaluated frame of the same index
+        const uint32_t refRows = refImg3D.getSize().rows;
+        return gammaIndexBySlabs(refImg3D, 1, refRows, [&](const ImageView& refSlab, uint32_t frame){
+            return gammaIndex2_5DClassicVals<Execution>(refSlab, evalImgPadded, gammaParams, frame);
+        });
+    });
+}
+
+template <typename Execution>
+GammaResult gammaIndex3DClassicCompactSimdImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                               const GammaParameters& gammaParams){
+    validateGammaParameters(gammaParams);
+
+    return dispatchCompactValues(evalImg3D.getFormat(), [&](auto valuesTag){
+        using Values = typename decltype(valuesTag)::type;
+        const AlignedCompactPaddedImage<Values> evalImgPadded(evalImg3D, 0, SimdElementCount);
+
+        const uint32_t refRows = refImg3D.getSize().rows;
+        return gammaIndexBySlabs(refImg3D, CompactSlabFrames3D, refRows, [&](const ImageView& refSlab, uint32_t){
+            return gammaIndex3DClassicVals<Execution>(refSlab, evalImgPadded, gammaParams);
+        });
+    });
+}
+}
+
+}
@@ -23,15 +23,29 @@
 #include <algorithm>
 #include <stdexcept>
 #include <limits>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
 
-#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
 #include "yagit/GammaParameters.hpp"
 #include "yagit/Gamma.hpp"
 
+#include "../ContiguousImage.hpp"
+
 namespace yagit{
 
 namespace{
-void validateImages2D(const ImageData& refImg, const ImageData& evalImg){
+// gamma values are calculated directly in the storage type of GammaResult,
+// so they are moved to it at the end without copying
+using GammaValues = ImageData::container_type;
+}
+
+namespace{
+// images are ImageView or CompactImageData
+template <typename RefImage, typename EvalImage>
+void validateImages2D(const RefImage& refImg, const EvalImage& evalImg){
     if(refImg.getSize().frames > 1){
         throw std::invalid_argument("reference image is not 2D (frames=" + std::to_string(refImg.getSize().frames) + " > 1)");
     }
@@ -66,6 +80,14 @@ void validateWendlingGammaParameters(const GammaParameters& gammaParams){
     if(gammaParams.stepSize > gammaParams.maxSearchDistance){
         throw std::invalid_argument("step size is greater than maximum search distance (stepSize > maxSearchDistance)");
     }
+    if(gammaParams.interpolation != GammaInterpolation::Nearest &&
+       gammaParams.interpolation != GammaInterpolation::Linear &&
+       gammaParams.interpolation != GammaInterpolation::Cubic){
+        throw std::invalid_argument("interpolation is neither nearest, linear nor cubic");
+    }
+    if(gammaParams.traversal != GammaTraversal::Raster && gammaParams.traversal != GammaTraversal::Tiled){
+        throw std::invalid_argument("traversal is neither raster nor tiled");
+    }
 }
 }
 
@@ -84,7 +106,9 @@ std::vector<T, A> generateVector(T start, T step, size_t size){
     return result;
 }
 
-std::vector<float> generateCoordinates(const ImageData& image, ImageAxis axis){
+// image is ImageView or other image with size, offset and spacing (e.g. PaddedImage)
+template <typename Image>
+std::vector<float> generateCoordinates(const Image& image, ImageAxis axis){
     if(axis == ImageAxis::Z){
         return generateVector(image.getOffset().frames, image.getSpacing().frames, image.getSize().frames);
     }
@@ -270,4 +294,323 @@ std::vector<Point3D> sortedPointsInSphere(float radius, float stepSize){
 }
 }
 
+namespace{
+// block of reference image voxels that is processed as a whole, ranges are half-open [begin, end)
+struct Tile{
+    uint32_t kBegin;
+    uint32_t kEnd;
+    uint32_t jBegin;
+    uint32_t jEnd;
+    uint32_t iBegin;
+    uint32_t iEnd;
+};
+
+enum class TileOrder{
+    Raster,
+    Morton,
+    MortonByFrame  // frame by frame, and along Z-order curve within a frame
+};
+
+// tile size used by Wendling method with GammaTraversal::Tiled - 2D and 2.5D search only within a frame,
+// so tiles are flat. 3D tile has the size of brick of evaluated image (see BrickedImage)
+const DataSize TileSize2D{1, 16, 16};
+const DataSize TileSize3D{4, 4, 4};
+
+// spread bits of 21-bit value, so that there are two zero bits between each of its bits
+uint64_t spreadBitsBy2(uint32_t value){
+    uint64_t x = value & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+// calculate position of (k, j, i) on Z-order curve
+uint64_t mortonCode3D(uint32_t k, uint32_t j, uint32_t i){
+    return (spreadBitsBy2(k) << 2) | (spreadBitsBy2(j) << 1) | spreadBitsBy2(i);
+}
+
+// split image into tiles of tileSize (tiles at the end of each axis may be smaller).
+// With TileOrder::Morton tiles are sorted along Z-order curve, so consecutive tiles are also close to each other
+// and evaluated image voxels they need are still in cache.
+// TileOrder::MortonByFrame finishes one frame before the next one, so frames can be processed lazily
+std::vector<Tile> generateTiles(const DataSize& imgSize, const DataSize& tileSize, TileOrder order){
+    const uint32_t tilesK = (imgSize.frames + tileSize.frames - 1) / tileSize.frames;
+    const uint32_t tilesJ = (imgSize.rows + tileSize.rows - 1) / tileSize.rows;
+    const uint32_t tilesI = (imgSize.columns + tileSize.columns - 1) / tileSize.columns;
+
+    std::vector<std::pair<uint64_t, Tile>> codedTiles;
+    codedTiles.reserve(static_cast<size_t>(tilesK) * tilesJ * tilesI);
+
+    uint64_t rasterIndex = 0;
+    for(uint32_t tk = 0; tk < tilesK; tk++){
+        for(uint32_t tj = 0; tj < tilesJ; tj++){
+            for(uint32_t ti = 0; ti < tilesI; ti++){
+                Tile tile{tk * tileSize.frames, std::min((tk + 1) * tileSize.frames, imgSize.frames),
+                          tj * tileSize.rows, std::min((tj + 1) * tileSize.rows, imgSize.rows),
+                          ti * tileSize.columns, std::min((ti + 1) * tileSize.columns, imgSize.columns)};
+                const uint64_t code = (order == TileOrder::Morton ? mortonCode3D(tk, tj, ti) :
+                                       order == TileOrder::MortonByFrame ? mortonCode3D(0, tj, ti) : rasterIndex);
+                codedTiles.emplace_back(code, tile);
+                rasterIndex++;
+            }
+        }
+    }
+
+    if(order == TileOrder::Morton){
+        std::sort(codedTiles.begin(), codedTiles.end(), [](const auto& lhs, const auto& rhs){
+            return lhs.first < rhs.first;
+        });
+    }
+    else if(order == TileOrder::MortonByFrame){
+        std::sort(codedTiles.begin(), codedTiles.end(), [](const auto& lhs, const auto& rhs){
+            return std::tie(lhs.second.kBegin, lhs.first) < std::tie(rhs.second.kBegin, rhs.first);
+        });
+    }
+
+    std::vector<Tile> result;
+    result.reserve(codedTiles.size());
+    for(const auto& codedTile : codedTiles){
+        result.push_back(codedTile.second);
+    }
+    return result;
+}
+
+// tiles of Wendling method in the order of gammaParams.traversal (byFrame finishes one frame before the next one).
+// In raster traversal each row of image is a separate tile
+std::vector<Tile> generateWendlingTiles(const DataSize& imgSize, const DataSize& tileSize,
+                                        const GammaParameters& gammaParams, bool byFrame = false){
+    if(gammaParams.traversal == GammaTraversal::Tiled){
+        return generateTiles(imgSize, tileSize, byFrame ? TileOrder::MortonByFrame : TileOrder::Morton);
+    }
+    return generateTiles(imgSize, {1, 1, std::max(imgSize.columns, 1u)}, TileOrder::Raster);
+}
+}
+
+
+namespace{
+// Normalization policies are template parameters of gamma kernels, so the type of normalization
+// is chosen once per call instead of being checked for each reference voxel
+class GlobalNormalization{
+public:
+    explicit GlobalNormalization(const GammaParameters& gammaParams)
+        : m_ddNormInvSq(((100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold)) /
+                        (gammaParams.globalNormDose * gammaParams.globalNormDose)){}
+
+    // global normalization doesn't divide by reference dose
+    static constexpr bool isDivisionByZero(float /*doseRef*/){
+        return false;
+    }
+
+    // squared inversed normalized dose difference (T is float or SIMD vector of floats)
+    template <typename T>
+    T ddNormInvSq(const T& /*doseRef*/) const{
+        return T(m_ddNormInvSq);
+    }
+
+private:
+    float m_ddNormInvSq;
+};
+
+class LocalNormalization{
+public:
+    explicit LocalNormalization(const GammaParameters& gammaParams)
+        : m_ddInvSq((100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold)){}
+
+    static constexpr bool isDivisionByZero(float doseRef){
+        return doseRef == 0;
+    }
+
+    // squared inversed normalized dose difference (T is float or SIMD vector of floats)
+    template <typename T>
+    T ddNormInvSq(const T& doseRef) const{
+        return T(m_ddInvSq) / (doseRef * doseRef);
+    }
+
+private:
+    float m_ddInvSq;
+};
+
+template <typename T>
+struct TypeTag{
+    using type = T;
+};
+
+// call func with TypeTag of normalization policy that matches the type of normalization,
+// so that func can instantiate a kernel specialized for it
+template <typename Function>
+decltype(auto) dispatchNormalization(GammaNormalization normalization, Function&& func){
+    if(normalization == GammaNormalization::Global){
+        return func(TypeTag<GlobalNormalization>{});
+    }
+    else{
+        return func(TypeTag<LocalNormalization>{});
+    }
+}
+}
+
+namespace{
+std::tuple<uint32_t, uint32_t> indexTo2Dindex(size_t index, const DataSize& size){
+    uint32_t j = index / size.columns;
+    uint32_t i = index % size.columns;
+    return {j, i};
+}
+
+std::tuple<uint32_t, uint32_t, uint32_t> indexTo3Dindex(size_t index, const DataSize& size){
+    uint32_t refRcSize = size.rows * size.columns;
+    uint32_t k = index / refRcSize;
+    uint32_t temp = index % refRcSize;
+    uint32_t j = temp / size.columns;
+    uint32_t i = temp % size.columns;
+    return {k, j, i};
+}
+
+// initialize gamma values of reference image - voxels that don't need calculation (dose below cutoff
+// or division by zero in local normalization) get NaN, the rest get Inf
+GammaValues initGammaVals(const ImageView& refImg, const GammaParameters& gammaParams){
+    GammaValues gammaVals;
+    gammaVals.reserve(refImg.size());
+
+    const bool isLocal = gammaParams.normalization == GammaNormalization::Local;
+    for(size_t i = 0; i < refImg.size(); i++){
+        float doseRef = refImg.get(i);
+        bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
+        bool divisionByZero = isLocal && doseRef == 0;
+        gammaVals.emplace_back((doseBelowCutoff || divisionByZero) ? NaN : Inf);
+    }
+    return gammaVals;
+}
+
+// Execution policy that runs gamma kernels in the calling thread.
+// Kernels are called with (args..., start, end, gammaVals), where [start, end) is a range
+// of reference image voxels (forEachVoxel) or of tiles (forEachTile).
+struct SequentialExecution{
+    template <typename Function, typename... Args>
+    static GammaValues forEachVoxel(const ImageView& refImg, const GammaParameters& gammaParams,
+                                    Function&& func, Args&&... args){
+        GammaValues gammaVals = initGammaVals(refImg, gammaParams);
+        func(args..., 0, refImg.size(), gammaVals);
+        return gammaVals;
+    }
+
+    // voxels of tiles that are not processed (see forEachTileMonitored) stay NaN
+    template <typename Function, typename... Args>
+    static GammaValues forEachTile(size_t refImgSize, size_t nrOfTiles, Function&& func, Args&&... args){
+        GammaValues gammaVals(refImgSize, NaN);
+        func(args..., 0, nrOfTiles, gammaVals);
+        return gammaVals;
+    }
+};
+}
+
+namespace{
+// Tracks passing rate while tiles of gamma index are calculated, so that calculation can stop
+// as soon as it is known whether passing rate target is met.
+// Voxels that are still to be calculated may pass, fail, or be NaN (e.g., outside of evaluated image),
+// so the passing rate can end up anywhere in [passed / (passed + failed + remaining),
+// (passed + remaining) / (passed + failed + remaining)].
+class PassingRateMonitor{
+public:
+    PassingRateMonitor(const ImageView& refImg, const GammaParameters& gammaParams,
+                       const GammaPassingRateTarget& target)
+        : m_refImg(refImg), m_doseCutoff(gammaParams.doseCutoff),
+          m_isLocal(gammaParams.normalization == GammaNormalization::Local), m_target(target) {
+        if(!(target.passingRate >= 0 && target.passingRate <= 1)){
+            throw std::invalid_argument("passing rate target is not in range [0, 1]");
+        }
+        for(size_t i = 0; i < refImg.size(); i++){
+            m_remaining += needsCalculation(refImg.get(i));
+        }
+    }
+
+    bool isDecided() const{
+        return m_decided.load(std::memory_order_relaxed);
+    }
+
+    // update counters with calculated gamma values of tile
+    void addTile(const Tile& tile, const GammaValues& gammaVals){
+        const DataSize size = m_refImg.getSize();
+        size_t passed = 0;
+        size_t failed = 0;
+        size_t calculated = 0;
+        for(uint32_t k = tile.kBegin; k < tile.kEnd; k++){
+            for(uint32_t j = tile.jBegin; j < tile.jEnd; j++){
+                const size_t rowIndex = (static_cast<size_t>(k) * size.rows + j) * size.columns;
+                for(uint32_t i = tile.iBegin; i < tile.iEnd; i++){
+                    passed += gammaVals[rowIndex + i] <= 1;
+                    failed += gammaVals[rowIndex + i] > 1;
+                    calculated += needsCalculation(m_refImg.get(rowIndex + i));
+                }
+            }
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_passed += passed;
+        m_failed += failed;
+        m_remaining -= calculated;
+
+        const double maxTotal = static_cast<double>(m_passed + m_failed + m_remaining);
+        if(m_remaining == 0){
+            m_targetMet = m_passed + m_failed > 0 && m_passed >= m_target.passingRate * (m_passed + m_failed);
+            m_decided = true;
+        }
+        else if(m_passed + m_remaining < m_target.passingRate * maxTotal){
+            m_targetMet = false;
+            m_decided = true;
+        }
+        else if(m_target.stopWhenGuaranteed && m_passed >= m_target.passingRate * maxTotal){
+            m_targetMet = true;
+            m_decided = true;
+        }
+    }
+
+    // calculation has been stopped before all voxels were calculated
+    bool isPartial() const{
+        return m_remaining > 0;
+    }
+
+    bool isTargetMet() const{
+        return m_targetMet;
+    }
+
+private:
+    // the same condition as in kernels
+    bool needsCalculation(float doseRef) const{
+        return !(doseRef < m_doseCutoff) && !(m_isLocal && doseRef == 0);
+    }
+
+    const ImageView m_refImg;
+    float m_doseCutoff;
+    bool m_isLocal;
+    GammaPassingRateTarget m_target;
+
+    std::mutex m_mutex;
+    size_t m_passed{0};
+    size_t m_failed{0};
+    size_t m_remaining{0};
+    bool m_targetMet{false};
+    std::atomic<bool> m_decided{false};
+};
+
+// call kernel for tiles with Execution policy. If monitor is given, tiles are calculated one by one
+// and the rest of them is skipped (their voxels stay NaN) as soon as the monitor is decided
+template <typename Execution, typename Kernel, typename... Args>
+GammaValues forEachTileMonitored(size_t refImgSize, const std::vector<Tile>& tiles,
+                                 PassingRateMonitor* monitor, const Kernel& kernel, const Args&... args){
+    if(monitor == nullptr){
+        return Execution::forEachTile(refImgSize, tiles.size(), kernel, std::cref(args)...);
+    }
+
+    const auto monitoredKernel = [&](size_t startTile, size_t endTile, GammaValues& gammaVals){
+        for(size_t t = startTile; t < endTile && !monitor->isDecided(); t++){
+            kernel(args..., t, t + 1, gammaVals);
+            monitor->addTile(tiles[t], gammaVals);
+        }
+    };
+    return Execution::forEachTile(refImgSize, tiles.size(), monitoredKernel);
+}
+}
+
 }
@@ -18,9 +18,11 @@
  ********************************************************************************************/
 #pragma once
 
-#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
 
 #include "GammaCommon.hpp"
+#include "PaddedImage.hpp"
+#include "VoxelValues.hpp"
 
 #include <xsimd/xsimd.hpp>
 
@@ -34,10 +36,57 @@ template <typename T>
 using aligned_vector = std::vector<T, aligned_allocator<T>>;
 
 constexpr size_t SimdElementCount = xsimd::simd_type<float>::size;
+
+// image with rows padded to a multiple of SimdElementCount and aligned to SIMD register size
+// (ImageData is aligned to DataAlignment, so it isn't copied if its rows are a multiple of SimdElementCount)
+using AlignedPaddedImage = PaddedImage<aligned_allocator<float>, xsimd::default_arch::alignment()>;
+
+// the same as AlignedPaddedImage, but keeping raw 16-bit values of CompactImageData (see loadValues)
+template <typename Values>
+using AlignedCompactPaddedImage = PaddedImage<aligned_allocator<uint16_t>, xsimd::default_arch::alignment(), Values>;
+}
+
+namespace{
+// Load SimdElementCount stored values (see VoxelValues.hpp) widened to float.
+// 16-bit values are widened in registers, so kernels read half as many bytes as from float image.
+// Float16 and BFloat16 values are widened exactly like in scalar code, UInt16 values are scaled in float
+// instead of double, so they can differ in the last bit.
+// Values of float image must be aligned to SIMD register size.
+inline xsimd::batch<float> loadValues(const FloatValues&, const float* values){
+    return xsimd::load_aligned(values);
+}
+
+inline xsimd::batch<float> loadValues(const Float16Values&, const uint16_t* values){
+    using UIntBatch = xsimd::batch<uint32_t>;
+    using FloatBatch = xsimd::batch<float>;
+
+    const UIntBatch half = UIntBatch::load_unaligned(values);
+    const UIntBatch sign = (half & UIntBatch(0x8000u)) << 16;
+    const UIntBatch magnitude = half & UIntBatch(0x7fffu);
+    // cases of halfToFloat are selected with comparisons of magnitude converted to float (it's exact)
+    const FloatBatch magnitudeFloat = xsimd::batch_cast<float>(xsimd::bitwise_cast<int32_t>(magnitude));
+    const FloatBatch normal = xsimd::bitwise_cast<float>((magnitude << 13) + UIntBatch((127 - 15) << 23));
+    const FloatBatch infNan = xsimd::bitwise_cast<float>((magnitude << 13) | UIntBatch(0x7f800000u));
+    const FloatBatch subnormal = magnitudeFloat * FloatBatch(0x1p-24f);
+
+    FloatBatch result = xsimd::select(magnitudeFloat >= FloatBatch(0x7c00), infNan, normal);
+    result = xsimd::select(magnitudeFloat < FloatBatch(0x0400), subnormal, result);
+    return xsimd::bitwise_cast<float>(xsimd::bitwise_cast<uint32_t>(result) | sign);
+}
+
+inline xsimd::batch<float> loadValues(const BFloat16Values&, const uint16_t* values){
+    return xsimd::bitwise_cast<float>(xsimd::batch<uint32_t>::load_unaligned(values) << 16);
+}
+
+inline xsimd::batch<float> loadValues(const UInt16Values& policy, const uint16_t* values){
+    const xsimd::batch<int32_t> integers = xsimd::batch<int32_t>::load_unaligned(values);
+    return xsimd::batch_cast<float>(integers) * xsimd::batch<float>(static_cast<float>(policy.scaling));
+}
 }
 
 namespace{
-aligned_vector<float> generateCoordinatesAligned(const ImageData& image, ImageAxis axis){
+template <typename Image>
+aligned_vector<float> generateCoordinatesAligned(const Image& image, ImageAxis axis){
     if(axis == ImageAxis::Z){
         return generateVector<float, aligned_allocator<float>>(image.getOffset().frames, image.getSpacing().frames, image.getSize().frames);
     }
@@ -49,6 +98,15 @@ aligned_vector<float> generateCoordinatesAligned(const ImageData& image, ImageAx
     }
     return {};
 }
+
+// generate X coordinates of image padded to paddedColumns elements, where padding coordinates are infinite,
+// so gamma calculated for padding voxels is also infinite and doesn't affect minimum
+template <typename Image>
+aligned_vector<float> generatePaddedCoordinatesAligned(const Image& image, uint32_t paddedColumns){
+    aligned_vector<float> coords = generateCoordinatesAligned(image, ImageAxis::X);
+    coords.resize(paddedColumns, Inf);
+    return coords;
+}
 }
 
 }
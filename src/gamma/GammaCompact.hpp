@@ -0,0 +1,251 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/GammaParameters.hpp"
+#include "yagit/GammaResult.hpp"
+
+#include "GammaCommon.hpp"
+#include "GammaWendling.hpp"
+
+namespace yagit{
+
+// Gamma index of images stored in CompactImageData.
+// Reference image is widened to float in slabs of whole tiles, which are passed to the kernels as ImageData,
+// so only one slab of reference image is kept as float at a time.
+// Evaluated image of Wendling method is copied to its padded/bricked layout (2D/3D) with its raw 16-bit values,
+// which the scalar kernels widen to float when they read them (see VoxelValues.hpp).
+// Vectorized Wendling kernels gather float values, so for them it is widened while it is copied.
+// In 2.5D method evaluated image is interpolated along Z frame by frame, so its frames are float.
+// Scalar classic method compares each reference voxel with all evaluated voxels, so evaluated image is widened
+// in slabs too and the minimum over slabs is taken (vectorized classic method of GammaClassicSimd.hpp
+// reads raw 16-bit values of evaluated image instead).
+namespace{
+// reference image is widened in bands of rows (2D) or in slabs of frames (2.5D and 3D)
+const uint32_t CompactSlabRows2D{8 * TileSize2D.rows};
+const uint32_t CompactSlabFrames3D{TileSize3D.frames};
+
+// read frames [frameBegin, frameEnd) and rows [rowBegin, rowEnd) of compact image widened to float
+ImageData readCompactPart(const CompactImageData& img, uint32_t frameBegin, uint32_t frameEnd,
+                          uint32_t rowBegin, uint32_t rowEnd){
+    const DataSize size = img.getSize();
+    const DataSize partSize{frameEnd - frameBegin, rowEnd - rowBegin, size.columns};
+
+    ImageData::container_type data;
+    if(rowBegin == 0 && rowEnd == size.rows){
+        data = img.readFrames(frameBegin, partSize.frames);
+    }
+    else{
+        data.reserve(static_cast<size_t>(partSize.frames) * partSize.rows * partSize.columns);
+        for(uint32_t k = frameBegin; k < frameEnd; k++){
+            for(uint32_t j = rowBegin; j < rowEnd; j++){
+                for(uint32_t i = 0; i < size.columns; i++){
+                    data.push_back(img.get(k, j, i));
+                }
+            }
+        }
+    }
+
+    const DataOffset partOffset{img.getOffset().frames + frameBegin * img.getSpacing().frames,
+                                img.getOffset().rows + rowBegin * img.getSpacing().rows,
+                                img.getOffset().columns};
+    return ImageData(std::move(data), partSize, partOffset, img.getSpacing());
+}
+
+// gamma index calculated slab by slab of reference image (slabFrames frames and slabRows rows);
+// calcSlab(refSlab, frameBegin) returns gamma values of the slab (GammaValues or GammaResult)
+template <typename SlabFunction>
+GammaResult gammaIndexBySlabs(const CompactImageData& refImg, uint32_t slabFrames, uint32_t slabRows,
+                              SlabFunction&& calcSlab){
+    const DataSize size = refImg.getSize();
+    GammaValues gammaVals(refImg.size());
+
+    for(uint32_t kBegin = 0; kBegin < size.frames; kBegin += slabFrames){
+        const uint32_t kEnd = std::min(kBegin + slabFrames, size.frames);
+        for(uint32_t jBegin = 0; jBegin < size.rows; jBegin += slabRows){
+            const uint32_t jEnd = std::min(jBegin + slabRows, size.rows);
+
+            const ImageData refSlab = readCompactPart(refImg, kBegin, kEnd, jBegin, jEnd);
+            const auto slabVals = calcSlab(refSlab, kBegin);
+
+            const float* slabRow = slabVals.data();
+            for(uint32_t k = kBegin; k < kEnd; k++){
+                for(uint32_t j = jBegin; j < jEnd; j++){
+                    std::copy(slabRow, slabRow + size.columns,
+                              gammaVals.begin() + (static_cast<size_t>(k) * size.rows + j) * size.columns);
+                    slabRow += size.columns;
+                }
+            }
+        }
+    }
+
+    return GammaResult(std::move(gammaVals), size, refImg.getOffset(), refImg.getSpacing());
+}
+
+// minimum of gamma values of classic method over slabs of evaluated image
+// (slabFrames frames and slabRows rows), NaN values (e.g. below dose cutoff) are kept
+template <typename ClassicImpl>
+GammaValues gammaIndexClassicOverEvalSlabs(const ImageView& refSlab, const CompactImageData& evalImg,
+                                           const GammaParameters& gammaParams,
+                                           uint32_t slabFrames, uint32_t slabRows, ClassicImpl&& classicImpl){
+    const DataSize evalSize = evalImg.getSize();
+    GammaValues gammaVals(refSlab.size(), Inf);
+
+    for(uint32_t kBegin = 0; kBegin < evalSize.frames; kBegin += slabFrames){
+        const uint32_t kEnd = std::min(kBegin + slabFrames, evalSize.frames);
+        for(uint32_t jBegin = 0; jBegin < evalSize.rows; jBegin += slabRows){
+            const uint32_t jEnd = std::min(jBegin + slabRows, evalSize.rows);
+
+            const ImageData evalSlab = readCompactPart(evalImg, kBegin, kEnd, jBegin, jEnd);
+            const GammaResult slabRes = classicImpl(refSlab, evalSlab, gammaParams);
+            for(size_t i = 0; i < gammaVals.size(); i++){
+                const float gammaVal = slabRes.get(i);
+                if(gammaVal < gammaVals[i] || std::isnan(gammaVal)){
+                    gammaVals[i] = gammaVal;
+                }
+            }
+        }
+    }
+
+    return gammaVals;
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex2DWendlingCompactImpl(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                            const GammaParameters& gammaParams){
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    const auto calc = [&](const auto& evalImgPadded){
+        return gammaIndexBySlabs(refImg2D, 1, CompactSlabRows2D, [&](const ImageView& refSlab, uint32_t){
+            return gammaIndex2DWendlingVals<Execution, Kernels>(refSlab, evalImgPadded, gammaParams,
+                                                                sortedPoints, searchExtent);
+        });
+    };
+    if constexpr(Kernels::ReadsCompactValues){
+        return dispatchCompactValues(evalImg2D.getFormat(), [&](auto valuesTag){
+            using Values = typename decltype(valuesTag)::type;
+            return calc(CompactPaddedImage<Values>(evalImg2D, 1));
+        });
+    }
+    else{
+        return calc(PaddedImage<>(evalImg2D, 1));
+    }
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex2_5DWendlingCompactImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                              const GammaParameters& gammaParams){
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    // frames of 2.5D method are independent, so reference image is widened frame by frame
+    const uint32_t refRows = refImg3D.getSize().rows;
+    return gammaIndexBySlabs(refImg3D, 1, refRows, [&](const ImageView& refSlab, uint32_t){
+        return gammaIndex2_5DWendlingVals<Execution, Kernels>(refSlab, evalImg3D, gammaParams,
+                                                              sortedPoints, searchExtent);
+    });
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex3DWendlingCompactImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                            const GammaParameters& gammaParams){
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInSphere(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    const uint32_t refRows = refImg3D.getSize().rows;
+    const auto calc = [&](const auto& evalImgBricked){
+        return gammaIndexBySlabs(refImg3D, CompactSlabFrames3D, refRows, [&](const ImageView& refSlab, uint32_t){
+            return gammaIndex3DWendlingVals<Execution, Kernels>(refSlab, evalImgBricked, gammaParams,
+                                                                sortedPoints, searchExtent);
+        });
+    };
+    if constexpr(Kernels::ReadsCompactValues){
+        return dispatchCompactValues(evalImg3D.getFormat(), [&](auto valuesTag){
+            using Values = typename decltype(valuesTag)::type;
+            return calc(BrickedImage<Values>(evalImg3D));
+        });
+    }
+    else{
+        return calc(BrickedImage<>(evalImg3D));
+    }
+}
+
+// classicImpl is gammaIndex*ClassicImpl of scalar backend
+template <typename ClassicImpl>
+GammaResult gammaIndex2DClassicCompactImpl(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                           const GammaParameters& gammaParams, ClassicImpl&& classicImpl){
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+
+    return gammaIndexBySlabs(refImg2D, 1, CompactSlabRows2D, [&](const ImageView& refSlab, uint32_t){
+        return gammaIndexClassicOverEvalSlabs(refSlab, evalImg2D, gammaParams, 1, CompactSlabRows2D, classicImpl);
+    });
+}
+
+template <typename ClassicImpl>
+GammaResult gammaIndex2_5DClassicCompactImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                             const GammaParameters& gammaParams, ClassicImpl&& classicImpl){
+    if(evalImg3D.getSize().frames < refImg3D.getSize().frames){
+        throw std::invalid_argument("evaluated image must have at least the same number of frames as the reference image");
+    }
+    validateGammaParameters(gammaParams);
+
+    // reference frame is compared only with evaluated frame of the same index
+    const uint32_t refRows = refImg3D.getSize().rows;
+    const uint32_t evalRows = evalImg3D.getSize().rows;
+    return gammaIndexBySlabs(refImg3D, 1, refRows, [&](const ImageView& refSlab, uint32_t frame){
+        const ImageData evalFrame = readCompactPart(evalImg3D, frame, frame + 1, 0, evalRows);
+        return classicImpl(refSlab, evalFrame, gammaParams);
+    });
+}
+
+template <typename ClassicImpl>
+GammaResult gammaIndex3DClassicCompactImpl(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                           const GammaParameters& gammaParams, ClassicImpl&& classicImpl){
+    validateGammaParameters(gammaParams);
+
+    const uint32_t refRows = refImg3D.getSize().rows;
+    const uint32_t evalRows = evalImg3D.getSize().rows;
+    return gammaIndexBySlabs(refImg3D, CompactSlabFrames3D, refRows, [&](const ImageView& refSlab, uint32_t){
+        return gammaIndexClassicOverEvalSlabs(refSlab, evalImg3D, gammaParams,
+                                              CompactSlabFrames3D, evalRows, classicImpl);
+    });
+}
+}
+
+}
@@ -0,0 +1,245 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/Gamma.hpp"
+
+#include <cmath>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace yagit{
+
+namespace{
+// how frames of evaluated image are cropped
+enum class FrameCropping{
+    None,        // 2D images
+    ByPosition,  // frames within maxSearchDistance of reference region (and those needed by interpolation)
+    ByIndex      // frames with the same indices as reference region (2.5D classic method compares frames by index)
+};
+
+// range [begin, end) of voxel indices along frames, rows and columns
+struct VoxelRegion{
+    DataSize begin;
+    DataSize end;
+
+    bool empty() const{
+        return begin.frames >= end.frames || begin.rows >= end.rows || begin.columns >= end.columns;
+    }
+    DataSize size() const{
+        return {end.frames - begin.frames, end.rows - begin.rows, end.columns - begin.columns};
+    }
+};
+
+// bounding box of reference voxels with dose not lower than dose cutoff (and inside of roi, if it is given)
+VoxelRegion doseCutoffBoundingBox(const ImageView& refImg, float doseCutoff, const ImageView* roiMask){
+    const DataSize size = refImg.getSize();
+    VoxelRegion box{size, {0, 0, 0}};
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            for(uint32_t i = 0; i < size.columns; i++){
+                const bool inRoi = roiMask == nullptr ||
+                                   (roiMask->get(k, j, i) != 0 && !std::isnan(roiMask->get(k, j, i)));
+                if(refImg.get(k, j, i) >= doseCutoff && inRoi){
+                    box.begin = {std::min(box.begin.frames, k), std::min(box.begin.rows, j), std::min(box.begin.columns, i)};
+                    box.end = {std::max(box.end.frames, k + 1), std::max(box.end.rows, j + 1), std::max(box.end.columns, i + 1)};
+                }
+            }
+        }
+    }
+    return box;
+}
+
+// expand region by one voxel, so methods using neighbouring reference voxels (chi) give the same results
+VoxelRegion expandByVoxel(const VoxelRegion& region, const DataSize& size){
+    return {{region.begin.frames > 0 ? region.begin.frames - 1 : 0,
+             region.begin.rows > 0 ? region.begin.rows - 1 : 0,
+             region.begin.columns > 0 ? region.begin.columns - 1 : 0},
+            {std::min(region.end.frames + 1, size.frames),
+             std::min(region.end.rows + 1, size.rows),
+             std::min(region.end.columns + 1, size.columns)}};
+}
+
+// range of voxel indices of evalImg along one axis that are within [minPos - margin, maxPos + margin],
+// where margin is extended by two voxels needed by interpolation
+std::pair<uint32_t, uint32_t> evalRange(float minPos, float maxPos, float margin,
+                                        float evalOffset, float evalSpacing, uint32_t evalSize){
+    margin += 2 * evalSpacing;
+    const float first = std::floor((minPos - margin - evalOffset) / evalSpacing);
+    const float last = std::ceil((maxPos + margin - evalOffset) / evalSpacing);
+    const uint32_t begin = first <= 0 ? 0 : static_cast<uint32_t>(std::min<float>(first, evalSize));
+    const uint32_t end = last < 0 ? 0 : static_cast<uint32_t>(std::min<float>(last + 1, evalSize));
+    return {begin, std::max(begin, end)};
+}
+
+VoxelRegion evalRegion(const ImageView& refImg, const VoxelRegion& refRegion, const ImageView& evalImg,
+                       float maxSearchDistance, FrameCropping frameCropping){
+    const DataOffset refOff = refImg.getOffset();
+    const DataSpacing refSp = refImg.getSpacing();
+    const DataOffset evalOff = evalImg.getOffset();
+    const DataSpacing evalSp = evalImg.getSpacing();
+    const DataSize evalSize = evalImg.getSize();
+    const float margin = std::max(maxSearchDistance, 0.0f);
+
+    auto axisRange = [&](float refO, float refS, uint32_t refBegin, uint32_t refEnd,
+                         float evalO, float evalS, uint32_t evalN){
+        return evalRange(refO + refBegin * refS, refO + (refEnd - 1) * refS, margin, evalO, evalS, evalN);
+    };
+    auto [kBegin, kEnd] = std::pair<uint32_t, uint32_t>{0, evalSize.frames};
+    if(frameCropping == FrameCropping::ByPosition){
+        std::tie(kBegin, kEnd) = axisRange(refOff.frames, refSp.frames, refRegion.begin.frames, refRegion.end.frames,
+                                           evalOff.frames, evalSp.frames, evalSize.frames);
+    }
+    else if(frameCropping == FrameCropping::ByIndex){
+        std::tie(kBegin, kEnd) = std::pair{refRegion.begin.frames, refRegion.end.frames};
+    }
+    auto [jBegin, jEnd] = axisRange(refOff.rows, refSp.rows, refRegion.begin.rows, refRegion.end.rows,
+                                    evalOff.rows, evalSp.rows, evalSize.rows);
+    auto [iBegin, iEnd] = axisRange(refOff.columns, refSp.columns, refRegion.begin.columns, refRegion.end.columns,
+                                    evalOff.columns, evalSp.columns, evalSize.columns);
+    return {{kBegin, jBegin, iBegin}, {kEnd, jEnd, iEnd}};
+}
+
+ImageData crop(const ImageView& img, const VoxelRegion& region){
+    const DataOffset offset = img.getOffset();
+    const DataSpacing spacing = img.getSpacing();
+    const DataOffset croppedOffset{offset.frames + region.begin.frames * spacing.frames,
+                                   offset.rows + region.begin.rows * spacing.rows,
+                                   offset.columns + region.begin.columns * spacing.columns};
+    const ImageView croppedView(&img.get(region.begin.frames, region.begin.rows, region.begin.columns),
+                                region.size(), croppedOffset, spacing, img.getStrides());
+    return croppedView.toImageData();
+}
+
+GammaResult embed(const GammaResult& croppedResult, const VoxelRegion& region, const ImageView& refImg){
+    const DataSize size = refImg.getSize();
+    ImageData::container_type data(static_cast<size_t>(size.frames) * size.rows * size.columns,
+                                   std::numeric_limits<float>::quiet_NaN());
+    size_t index = 0;
+    for(uint32_t k = region.begin.frames; k < region.end.frames; k++){
+        for(uint32_t j = region.begin.rows; j < region.end.rows; j++){
+            const auto rowBegin = croppedResult.data() + index;
+            const auto rowSize = region.end.columns - region.begin.columns;
+            std::copy(rowBegin, rowBegin + rowSize,
+                      data.begin() + (static_cast<size_t>(k) * size.rows + j) * size.columns + region.begin.columns);
+            index += rowSize;
+        }
+    }
+    return GammaResult(std::move(data), size, refImg.getOffset(), refImg.getSpacing());
+}
+
+// classic method compares reference frame with evaluated frame of the same index,
+// other methods interpolate evaluated image at positions of reference frames
+FrameCropping frameCropping2_5D(GammaMethod method){
+    return method == GammaMethod::Classic ? FrameCropping::ByIndex : FrameCropping::ByPosition;
+}
+
+template <typename GammaFunc>
+GammaResult gammaIndexCroppedImpl(const ImageView& refImg, const ImageView& evalImg, const ImageView* roiMask,
+                                  const GammaParameters& gammaParams, GammaCropResult resultSize,
+                                  FrameCropping frameCropping, GammaFunc gammaFunc){
+    if(resultSize != GammaCropResult::FullSize && resultSize != GammaCropResult::Cropped){
+        throw std::invalid_argument("invalid result size");
+    }
+    if(roiMask != nullptr && roiMask->getSize() != refImg.getSize()){
+        throw std::invalid_argument("ROI mask has different size than reference image");
+    }
+
+    if(frameCropping == FrameCropping::None && (refImg.getSize().frames > 1 || evalImg.getSize().frames > 1)){
+        // images are not 2D - gamma index function will throw an exception
+        return gammaFunc(refImg, evalImg);
+    }
+    if(frameCropping == FrameCropping::ByIndex && evalImg.getSize().frames < refImg.getSize().frames){
+        // evaluated image has too few frames - gamma index function will throw an exception
+        return gammaFunc(refImg, evalImg);
+    }
+
+    const VoxelRegion box = doseCutoffBoundingBox(refImg, gammaParams.doseCutoff, roiMask);
+    if(box.empty()){
+        // there are no voxels for which gamma index can be calculated
+        if(resultSize == GammaCropResult::Cropped){
+            return GammaResult();
+        }
+        return embed(GammaResult(), VoxelRegion{{0, 0, 0}, {0, 0, 0}}, refImg);
+    }
+
+    const VoxelRegion refRegion = expandByVoxel(box, refImg.getSize());
+    VoxelRegion evalBox = evalRegion(refImg, refRegion, evalImg, gammaParams.maxSearchDistance, frameCropping);
+    if(evalBox.empty()){
+        // images don't overlap, so evaluated image is not cropped to get the same result as for uncropped images
+        // (except for frames compared by index)
+        const DataSize evalSize = evalImg.getSize();
+        evalBox = frameCropping == FrameCropping::ByIndex ?
+                  VoxelRegion{{refRegion.begin.frames, 0, 0}, {refRegion.end.frames, evalSize.rows, evalSize.columns}} :
+                  VoxelRegion{{0, 0, 0}, evalSize};
+    }
+    const ImageData croppedEval = evalBox.empty() ? ImageData() : crop(evalImg, evalBox);
+
+    GammaResult croppedResult = gammaFunc(crop(refImg, refRegion), evalBox.empty() ? evalImg : ImageView(croppedEval));
+    if(resultSize == GammaCropResult::Cropped){
+        return croppedResult;
+    }
+    return embed(croppedResult, refRegion, refImg);
+}
+}
+
+GammaResult gammaIndex2DCropped(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                const GammaParameters& gammaParams, GammaMethod method,
+                                GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg2D, evalImg2D, nullptr, gammaParams, resultSize, FrameCropping::None,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2D(ref, eval, gammaParams, method); });
+}
+
+GammaResult gammaIndex2DCropped(const ImageView& refImg2D, const ImageView& evalImg2D, const ImageView& roiMask,
+                                const GammaParameters& gammaParams, GammaMethod method,
+                                GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg2D, evalImg2D, &roiMask, gammaParams, resultSize, FrameCropping::None,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2D(ref, eval, gammaParams, method); });
+}
+
+GammaResult gammaIndex2_5DCropped(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                  const GammaParameters& gammaParams, GammaMethod method,
+                                  GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg3D, evalImg3D, nullptr, gammaParams, resultSize, frameCropping2_5D(method),
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2_5D(ref, eval, gammaParams, method); });
+}
+
+GammaResult gammaIndex2_5DCropped(const ImageView& refImg3D, const ImageView& evalImg3D, const ImageView& roiMask,
+                                  const GammaParameters& gammaParams, GammaMethod method,
+                                  GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg3D, evalImg3D, &roiMask, gammaParams, resultSize, frameCropping2_5D(method),
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2_5D(ref, eval, gammaParams, method); });
+}
+
+GammaResult gammaIndex3DCropped(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                const GammaParameters& gammaParams, GammaMethod method,
+                                GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg3D, evalImg3D, nullptr, gammaParams, resultSize, FrameCropping::ByPosition,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex3D(ref, eval, gammaParams, method); });
+}
+
+GammaResult gammaIndex3DCropped(const ImageView& refImg3D, const ImageView& evalImg3D, const ImageView& roiMask,
+                                const GammaParameters& gammaParams, GammaMethod method,
+                                GammaCropResult resultSize){
+    return gammaIndexCroppedImpl(refImg3D, evalImg3D, &roiMask, gammaParams, resultSize, FrameCropping::ByPosition,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex3D(ref, eval, gammaParams, method); });
+}
+
+}
@@ -0,0 +1,162 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/Gamma.hpp"
+
+#include "../StatisticsAccumulator.hpp"
+#include "../ContiguousImage.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace yagit{
+
+namespace{
+// number of reference voxels processed at once (if frames/rows are not larger)
+constexpr size_t ChunkVoxels = 1 << 20;
+// the smallest chunks - tiles of Wendling method shouldn't be cut too much
+constexpr uint32_t TileSize2DRows = 16;
+constexpr uint32_t TileSize3DFrames = 4;
+
+// copy of frames [frameBegin, frameEnd) and rows [rowBegin, rowEnd) of image
+ImageData subImage(const ImageView& img, uint32_t frameBegin, uint32_t frameEnd, uint32_t rowBegin, uint32_t rowEnd){
+    const DataSize size{frameEnd - frameBegin, rowEnd - rowBegin, img.getSize().columns};
+    const DataOffset offset{img.getOffset().frames + frameBegin * img.getSpacing().frames,
+                            img.getOffset().rows + rowBegin * img.getSpacing().rows,
+                            img.getOffset().columns};
+    return ImageView(&img.get(frameBegin, rowBegin, 0), size, offset, img.getSpacing(), img.getStrides()).toImageData();
+}
+
+bool haveSameGrid(const ImageView& img1, const ImageView& img2){
+    return img1.getSize() == img2.getSize() && img1.getOffset() == img2.getOffset() &&
+           img1.getSpacing() == img2.getSpacing();
+}
+
+// calculate gamma index of reference image chunk by chunk along frames (alongFrames) or rows,
+// and accumulate statistics of each chunk, so only one chunk of gamma index is stored at once.
+// Chunks are calculated with gammaFunc(refChunk, evalImg) or croppedGammaFunc(refChunk, evalImg), which crops
+// evaluated image to the neighbourhood of chunk - classic method searches the whole evaluated image,
+// so it gets it without cropping, except for frames compared by index (evalFramesByIndex, 2.5D),
+// where it gets frames of evaluated image with the same indices as chunk.
+// Chi method uses neighbouring reference voxels to calculate gradients, so its chunks have one additional
+// frame/row on each side (halo), and it needs evaluated image only at voxels of chunk,
+// so if images have the same grid, it gets the same chunk of evaluated image
+template <typename GammaFunc, typename CroppedGammaFunc>
+GammaSummary gammaIndexSummaryImpl(const ImageView& refImg, const ImageView& evalImg, GammaMethod method,
+                                   bool alongFrames, bool evalFramesByIndex, uint32_t minChunkLength,
+                                   uint32_t histogramBins, float histogramMax,
+                                   GammaFunc gammaFunc, CroppedGammaFunc croppedGammaFunc){
+    if(histogramBins < 2){
+        throw std::invalid_argument("number of histogram bins is less than 2");
+    }
+    if(!(histogramMax > 0)){
+        throw std::invalid_argument("histogram max is not positive (histogramMax <= 0)");
+    }
+
+    if(method == GammaMethod::Classic && !evalImg.isContiguous()){
+        // classic method gets the whole evaluated image for each chunk, so it is copied only once
+        return gammaIndexSummaryImpl(refImg, ContiguousImage(evalImg), method, alongFrames, evalFramesByIndex,
+                                     minChunkLength,
+                                     histogramBins, histogramMax, gammaFunc, croppedGammaFunc);
+    }
+
+    const bool classicByFrame = method == GammaMethod::Classic && evalFramesByIndex;
+    if(classicByFrame && evalImg.getSize().frames < refImg.getSize().frames){
+        // evaluated image has too few frames - gamma index function will throw an exception
+        gammaFunc(refImg, evalImg);
+    }
+
+    const DataSize size = refImg.getSize();
+    const uint32_t length = alongFrames ? size.frames : size.rows;
+    const size_t sliceSize = alongFrames ? static_cast<size_t>(size.rows) * size.columns : size.columns;
+    const uint32_t chunkLength = static_cast<uint32_t>(
+        std::max(ChunkVoxels / std::max(sliceSize, size_t(1)), static_cast<size_t>(minChunkLength)));
+    const uint32_t halo = method == GammaMethod::Chi ? 1 : 0;
+    const bool chunkEvalImg = method == GammaMethod::Chi && haveSameGrid(refImg, evalImg);
+
+    auto chunkOf = [&](const ImageView& img, uint32_t begin, uint32_t end){
+        return alongFrames ? subImage(img, begin, end, 0, size.rows) : subImage(img, 0, size.frames, begin, end);
+    };
+
+    const float binWidth = histogramMax / (histogramBins - 1);
+    StatisticsAccumulator statistics({1}, histogramBins, binWidth);
+    for(uint32_t begin = 0; begin < length; begin += chunkLength){
+        const uint32_t end = std::min(begin + chunkLength, length);
+        const uint32_t haloBegin = begin >= halo ? begin - halo : 0;
+        const uint32_t haloEnd = std::min(end + halo, length);
+
+        const ImageData refChunk = chunkOf(refImg, haloBegin, haloEnd);
+        GammaResult gammaRes;
+        if(chunkEvalImg){
+            gammaRes = gammaFunc(refChunk, chunkOf(evalImg, haloBegin, haloEnd));
+        }
+        else if(classicByFrame){
+            gammaRes = gammaFunc(refChunk, subImage(evalImg, haloBegin, haloEnd, 0, evalImg.getSize().rows));
+        }
+        else if(method == GammaMethod::Classic){
+            gammaRes = gammaFunc(refChunk, evalImg);
+        }
+        else{
+            gammaRes = croppedGammaFunc(refChunk, evalImg);
+        }
+        const size_t valsBegin = (begin - haloBegin) * sliceSize;
+        const size_t valsEnd = valsBegin + (end - begin) * sliceSize;
+        statistics.add(gammaRes.data() + valsBegin, gammaRes.data() + valsEnd);
+    }
+    if(statistics.size() == 0){
+        const float NaN = std::numeric_limits<float>::quiet_NaN();
+        return {NaN, NaN, NaN, NaN, NaN, 0, statistics.histogram(), binWidth};
+    }
+    return {static_cast<double>(statistics.thresholdCounts()[0]) / statistics.size(),
+            statistics.min(), statistics.max(), statistics.mean(), statistics.var(), statistics.size(),
+            statistics.histogram(), binWidth};
+}
+}
+
+GammaSummary gammaIndex2DSummary(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                 const GammaParameters& gammaParams, GammaMethod method,
+                                 uint32_t histogramBins, float histogramMax){
+    if(refImg2D.getSize().frames > 1){
+        // image is not 2D - gamma index function will throw an exception
+        gammaIndex2D(refImg2D, evalImg2D, gammaParams, method);
+    }
+    return gammaIndexSummaryImpl(refImg2D, evalImg2D, method, false, false, TileSize2DRows, histogramBins, histogramMax,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2D(ref, eval, gammaParams, method); },
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2DCropped(ref, eval, gammaParams, method); });
+}
+
+GammaSummary gammaIndex2_5DSummary(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                   const GammaParameters& gammaParams, GammaMethod method,
+                                   uint32_t histogramBins, float histogramMax){
+    return gammaIndexSummaryImpl(refImg3D, evalImg3D, method, true, true, 1, histogramBins, histogramMax,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2_5D(ref, eval, gammaParams, method); },
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex2_5DCropped(ref, eval, gammaParams, method); });
+}
+
+GammaSummary gammaIndex3DSummary(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                 const GammaParameters& gammaParams, GammaMethod method,
+                                 uint32_t histogramBins, float histogramMax){
+    return gammaIndexSummaryImpl(refImg3D, evalImg3D, method, true, false, 2 * TileSize3DFrames, histogramBins, histogramMax,
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex3D(ref, eval, gammaParams, method); },
+        [&](const ImageView& ref, const ImageView& eval){ return gammaIndex3DCropped(ref, eval, gammaParams, method); });
+}
+
+}
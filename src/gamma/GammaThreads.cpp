@@ -18,20 +18,17 @@
  ********************************************************************************************/
 
 #include "yagit/Gamma.hpp"
+#include "yagit/CompactImageData.hpp"
 
-#include <thread>
-#include <tuple>
-#include <cmath>
-#include <algorithm>
-#include <functional>
-
-#include "yagit/Interpolation.hpp"
-#include "GammaCommon.hpp"
+#include "GammaClassic.hpp"
+#include "GammaChi.hpp"
+#include "GammaWendling.hpp"
+#include "GammaCompact.hpp"
 #include "GammaThreadsUtils.hpp"
 
 namespace yagit{
 
-GammaResult gammaIndex2D(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2D(const ImageView& refImg2D, const ImageView& evalImg2D,
                          const GammaParameters& gammaParams, GammaMethod method){
     if(method == GammaMethod::Wendling){
         return gammaIndex2DWendling(refImg2D, evalImg2D, gammaParams);
@@ -39,12 +36,15 @@ GammaResult gammaIndex2D(const ImageData& refImg2D, const ImageData& evalImg2D,
     else if(method == GammaMethod::Classic){
         return gammaIndex2DClassic(refImg2D, evalImg2D, gammaParams);
     }
+    else if(method == GammaMethod::Chi){
+        return gammaIndex2DChi(refImg2D, evalImg2D, gammaParams);
+    }
     else{
         throw std::invalid_argument("invalid method");
     }
 }
 
-GammaResult gammaIndex2_5D(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5D(const ImageView& refImg3D, const ImageView& evalImg3D,
                            const GammaParameters& gammaParams, GammaMethod method){
     if(method == GammaMethod::Wendling){
         return gammaIndex2_5DWendling(refImg3D, evalImg3D, gammaParams);
@@ -52,12 +52,15 @@ GammaResult gammaIndex2_5D(const ImageData& refImg3D, const ImageData& evalImg3D
     else if(method == GammaMethod::Classic){
         return gammaIndex2_5DClassic(refImg3D, evalImg3D, gammaParams);
     }
+    else if(method == GammaMethod::Chi){
+        return gammaIndex2_5DChi(refImg3D, evalImg3D, gammaParams);
+    }
     else{
         throw std::invalid_argument("invalid method");
     }
 }
 
-GammaResult gammaIndex3D(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3D(const ImageView& refImg3D, const ImageView& evalImg3D,
                          const GammaParameters& gammaParams, GammaMethod method){
     if(method == GammaMethod::Wendling){
         return gammaIndex3DWendling(refImg3D, evalImg3D, gammaParams);
@@ -65,643 +68,111 @@ GammaResult gammaIndex3D(const ImageData& refImg3D, const ImageData& evalImg3D,
     else if(method == GammaMethod::Classic){
         return gammaIndex3DClassic(refImg3D, evalImg3D, gammaParams);
     }
+    else if(method == GammaMethod::Chi){
+        return gammaIndex3DChi(refImg3D, evalImg3D, gammaParams);
+    }
     else{
         throw std::invalid_argument("invalid method");
     }
 }
 
-namespace{
-void gammaIndex2DClassicInternal(const ImageData& refImg2D, const ImageData& evalImg2D,
-                                 const GammaParameters& gammaParams,
-                                 const std::vector<float>& yr, const std::vector<float>& xr,
-                                 const std::vector<float>& ye, const std::vector<float>& xe,
-                                 size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const auto [jStart, iStart] = indexTo2Dindex(startIndex, refImg2D.getSize());
-
-    // iterate over each row and column of reference image
-    size_t indRef = startIndex;
-    for(uint32_t jr = jStart; jr < refImg2D.getSize().rows && indRef < endIndex; jr++){
-        const uint32_t iStart2 = (jr != jStart ? 0 : iStart);
-
-        for(uint32_t ir = iStart2; ir < refImg2D.getSize().columns && indRef < endIndex; ir++){
-            if(gammaVals[indRef] == Inf){
-                float doseRef = refImg2D.get(indRef);
-
-                float minGammaValSq = Inf;
-                // set squared inversed normalized dd based on the type of normalization (global or local)
-                float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-
-                // iterate over each row and column of evaluated image
-                size_t indEval = 0;
-                for(uint32_t je = 0; je < evalImg2D.getSize().rows; je++){
-                    for(uint32_t ie = 0; ie < evalImg2D.getSize().columns; ie++){
-                        float doseEval = evalImg2D.get(indEval);
-                        // calculate squared gamma
-                        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
-                                           distSq2D(xe[ie], ye[je], xr[ir], yr[jr]) * dtaInvSq;
-                        if(gammaValSq < minGammaValSq){
-                            minGammaValSq = gammaValSq;
-                        }
-
-                        indEval++;
-                    }
-                }
-
-                gammaVals[indRef] = std::sqrt(minGammaValSq);
-            }
-
-            indRef++;
-        }
-    }
-}
-
-void gammaIndex2_5DClassicInternal(const ImageData& refImg3D, const ImageData& evalImg3D,
-                                   const GammaParameters& gammaParams,
-                                   const std::vector<float>& zr, const std::vector<float>& yr,
-                                   const std::vector<float>& xr, const std::vector<float>& ze,
-                                   const std::vector<float>& ye, const std::vector<float>& xe,
-                                   size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
-
-    // iterate over each frame, row and column of reference image
-    size_t indRef = startIndex;
-    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
-
-        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
-        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
-
-            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
-            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
-                if(gammaVals[indRef] == Inf){
-                    float doseRef = refImg3D.get(indRef);
-
-                    // set squared inversed normalized dd based on the type of normalization (global or local)
-                    float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-                    float minGammaValSq = Inf;
-
-                    // iterate over each row and column of evaluated image
-                    size_t indEval = kr * evalImg3D.getSize().rows * refImg3D.getSize().columns;
-                    for(uint32_t je = 0; je < evalImg3D.getSize().rows; je++){
-                        for(uint32_t ie = 0; ie < evalImg3D.getSize().columns; ie++){
-                            float doseEval = evalImg3D.get(indEval);
-                            // calculate squared gamma
-                            float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
-                                               distSq3D(xe[ie], ye[je], ze[kr], xr[ir], yr[jr], zr[kr]) * dtaInvSq;
-                            if(gammaValSq < minGammaValSq){
-                                minGammaValSq = gammaValSq;
-                            }
-                            indEval++;
-                        }
-                    }
-
-                    gammaVals[indRef] = std::sqrt(minGammaValSq);
-                }
-
-                indRef++;
-            }
-        }
-    }
-}
-
-void gammaIndex3DClassicInternal(const ImageData& refImg3D, const ImageData& evalImg3D,
-                                 const GammaParameters& gammaParams,
-                                 const std::vector<float>& zr, const std::vector<float>& yr,
-                                 const std::vector<float>& xr, const std::vector<float>& ze,
-                                 const std::vector<float>& ye, const std::vector<float>& xe,
-                                 size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
-
-    // iterate over each frame, row and column of reference image
-    size_t indRef = startIndex;
-    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
-
-        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
-        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
-
-            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
-            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
-                if(gammaVals[indRef] == Inf){
-                    float doseRef = refImg3D.get(indRef);
-
-                    // set squared inversed normalized dd based on the type of normalization (global or local)
-                    float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-                    float minGammaValSq = Inf;
-
-                    // iterate over each frame, row and column of evaluated image
-                    size_t indEval = 0;
-                    for(uint32_t ke = 0; ke < evalImg3D.getSize().frames; ke++){
-                        for(uint32_t je = 0; je < evalImg3D.getSize().rows; je++){
-                            for(uint32_t ie = 0; ie < evalImg3D.getSize().columns; ie++){
-                                float doseEval = evalImg3D.get(indEval);
-                                // calculate squared gamma
-                                float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq +
-                                                   distSq3D(xe[ie], ye[je], ze[ke], xr[ir], yr[jr], zr[kr]) * dtaInvSq;
-                                if(gammaValSq < minGammaValSq){
-                                    minGammaValSq = gammaValSq;
-                                }
-
-                                indEval++;
-                            }
-                        }
-                    }
-
-                    gammaVals[indRef] = std::sqrt(minGammaValSq);
-                }
-
-                indRef++;
-            }
-        }
-    }
-}
-}
-
-GammaResult gammaIndex2DClassic(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2DClassic(const ImageView& refImg2D, const ImageView& evalImg2D,
                                 const GammaParameters& gammaParams){
-    validateImages2D(refImg2D, evalImg2D);
-    validateGammaParameters(gammaParams);
-
-    const std::vector<float> yr = generateCoordinates(refImg2D, ImageAxis::Y);
-    const std::vector<float> xr = generateCoordinates(refImg2D, ImageAxis::X);
-    const std::vector<float> ye = generateCoordinates(evalImg2D, ImageAxis::Y);
-    const std::vector<float> xe = generateCoordinates(evalImg2D, ImageAxis::X);
-
-    std::vector<float> gammaVals =
-        multithreadedGammaIndex(refImg2D, gammaParams, gammaIndex2DClassicInternal,
-                                std::cref(refImg2D), std::cref(evalImg2D), std::cref(gammaParams),
-                                std::cref(yr), std::cref(xr),
-                                std::cref(ye), std::cref(xe));
-
-    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+    return gammaIndex2DClassicImpl<ThreadedExecution>(refImg2D, evalImg2D, gammaParams);
 }
 
-GammaResult gammaIndex2_5DClassic(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5DClassic(const ImageView& refImg3D, const ImageView& evalImg3D,
                                   const GammaParameters& gammaParams){
-    if(evalImg3D.getSize().frames < refImg3D.getSize().frames){
-        throw std::invalid_argument("evaluated image must have at least the same number of frames as the reference image");
-    }
-    validateGammaParameters(gammaParams);
-
-    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
-    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
-    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
-    const std::vector<float> ze = generateCoordinates(evalImg3D, ImageAxis::Z);
-    const std::vector<float> ye = generateCoordinates(evalImg3D, ImageAxis::Y);
-    const std::vector<float> xe = generateCoordinates(evalImg3D, ImageAxis::X);
-
-    std::vector<float> gammaVals =
-        multithreadedGammaIndex(refImg3D, gammaParams, gammaIndex2_5DClassicInternal,
-                                std::cref(refImg3D), std::cref(evalImg3D), std::cref(gammaParams),
-                                std::cref(zr), std::cref(yr), std::cref(xr),
-                                std::cref(ze), std::cref(ye), std::cref(xe));
-
-    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+    return gammaIndex2_5DClassicImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
 }
 
-GammaResult gammaIndex3DClassic(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3DClassic(const ImageView& refImg3D, const ImageView& evalImg3D,
                                 const GammaParameters& gammaParams){
-    validateGammaParameters(gammaParams);
-
-    const std::vector<float> zr = generateCoordinates(refImg3D, ImageAxis::Z);
-    const std::vector<float> yr = generateCoordinates(refImg3D, ImageAxis::Y);
-    const std::vector<float> xr = generateCoordinates(refImg3D, ImageAxis::X);
-    const std::vector<float> ze = generateCoordinates(evalImg3D, ImageAxis::Z);
-    const std::vector<float> ye = generateCoordinates(evalImg3D, ImageAxis::Y);
-    const std::vector<float> xe = generateCoordinates(evalImg3D, ImageAxis::X);
-
-    std::vector<float> gammaVals =
-        multithreadedGammaIndex(refImg3D, gammaParams, gammaIndex3DClassicInternal,
-                                std::cref(refImg3D), std::cref(evalImg3D), std::cref(gammaParams),
-                                std::cref(zr), std::cref(yr), std::cref(xr),
-                                std::cref(ze), std::cref(ye), std::cref(xe));
-
-    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+    return gammaIndex3DClassicImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
 }
 
-namespace{
-void gammaIndex2DWendlingInternal(const ImageData& refImg2D, const ImageData& evalImg2D,
-                                  const GammaParameters& gammaParams,
-                                  const std::vector<Point2D>& sortedPoints,
-                                  size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const float rowsSpInv = 1 / evalImg2D.getSpacing().rows;
-    const float columnsSpInv = 1 / evalImg2D.getSpacing().columns;
-
-    const float yeMin = evalImg2D.getOffset().rows - Tolerance;
-    const float xeMin = evalImg2D.getOffset().columns - Tolerance;
-    const float yeMax = evalImg2D.getOffset().rows + (evalImg2D.getSize().rows - 1) * evalImg2D.getSpacing().rows + Tolerance;
-    const float xeMax = evalImg2D.getOffset().columns + (evalImg2D.getSize().columns - 1) * evalImg2D.getSpacing().columns + Tolerance;
-
-    const auto [jStart, iStart] = indexTo2Dindex(startIndex, refImg2D.getSize());
-
-    // iterate over each row and column of reference image
-    size_t indRef = startIndex;
-    float yr = refImg2D.getOffset().rows + jStart * refImg2D.getSpacing().rows;
-    for(uint32_t jr = jStart; jr < refImg2D.getSize().rows && indRef < endIndex; jr++){
-        const uint32_t iStart2 = (jr != jStart ? 0 : iStart);
-        float xr = refImg2D.getOffset().columns + iStart2 * refImg2D.getSpacing().columns;
-
-        for(uint32_t ir = iStart2; ir < refImg2D.getSize().columns && indRef < endIndex; ir++){
-            float doseRef = refImg2D.get(indRef);
-
-            bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
-            bool divisionByZero = !isGlobal && doseRef == 0;
-            if(doseBelowCutoff || divisionByZero){
-                gammaVals[indRef] = NaN;
-            }
-            else{
-                // set squared inversed normalized dd based on the type of normalization (global or local)
-                float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-
-                float minGammaValSq = Inf;
-
-                for(const auto& point : sortedPoints){
-                    const float normalizedDistSq = point.distSq * dtaInvSq;
-                    if(normalizedDistSq >= minGammaValSq){
-                        break;
-                    }
-
-                    float ye = yr + point.y;
-                    float xe = xr + point.x;
-
-                    // instead of calling Interpolate::bilinearAtPoint function,
-                    // here is an inlined, optimized version. It gives 5-10% speedup
-
-                    if(ye < yeMin || ye > yeMax ||
-                       xe < xeMin || xe > xeMax){
-                        continue;
-                    }
-
-                    float tempy = (ye - evalImg2D.getOffset().rows) * rowsSpInv;
-                    float tempx = (xe - evalImg2D.getOffset().columns) * columnsSpInv;
-
-                    const uint32_t indy0 = static_cast<uint32_t>(tempy);
-                    const uint32_t indx0 = static_cast<uint32_t>(tempx);
-                    uint32_t indy1 = indy0 + 1;
-                    uint32_t indx1 = indx0 + 1;
-
-                    if(indy1 == evalImg2D.getSize().rows){
-                        indy1 = indy0;
-                    }
-                    if(indx1 == evalImg2D.getSize().columns){
-                        indx1 = indx0;
-                    }
-
-                    float yd = tempy - static_cast<float>(indy0);
-                    float xd = tempx - static_cast<float>(indx0);
-
-                    float c00 = evalImg2D.get(0, indy0, indx0);
-                    float c01 = evalImg2D.get(0, indy1, indx0);
-                    float c10 = evalImg2D.get(0, indy0, indx1);
-                    float c11 = evalImg2D.get(0, indy1, indx1);
-
-                    float c0 = c00*(1 - xd) + c10*xd;
-                    float c1 = c01*(1 - xd) + c11*xd;
-
-                    float doseEval = c0*(1 - yd) + c1*yd;
-
-                    // calculate squared gamma
-                    float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq + normalizedDistSq;
-                    if(gammaValSq < minGammaValSq){
-                        minGammaValSq = gammaValSq;
-                    }
-                }
-
-                if(minGammaValSq != Inf){
-                    gammaVals[indRef] = std::sqrt(minGammaValSq);
-                }
-                else{
-                    gammaVals[indRef] = NaN;
-                }
-            }
-            xr += refImg2D.getSpacing().columns;
-            indRef++;
-        }
-        yr += refImg2D.getSpacing().rows;
-    }
+GammaResult gammaIndex2DWendling(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                 const GammaParameters& gammaParams){
+    return gammaIndex2DWendlingImpl<ThreadedExecution>(refImg2D, evalImg2D, gammaParams);
 }
 
-void gammaIndex2_5DWendlingInternal(const ImageData& refImg3D, const ImageData& evalImg3D,
-                                    const GammaParameters& gammaParams,
-                                    const std::vector<Point2D>& sortedPoints,
-                                    size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const float rowsSpInv = 1 / evalImg3D.getSpacing().rows;
-    const float columnsSpInv = 1 / evalImg3D.getSpacing().columns;
-
-    const float yeMin = evalImg3D.getOffset().rows - Tolerance;
-    const float xeMin = evalImg3D.getOffset().columns - Tolerance;
-    const float yeMax = evalImg3D.getOffset().rows + (evalImg3D.getSize().rows - 1) * evalImg3D.getSpacing().rows + Tolerance;
-    const float xeMax = evalImg3D.getOffset().columns + (evalImg3D.getSize().columns - 1) * evalImg3D.getSpacing().columns + Tolerance;
-
-    const int kDiff = static_cast<int>((refImg3D.getOffset().frames - evalImg3D.getOffset().frames) / refImg3D.getSpacing().frames);
-
-    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
-
-    // iterate over each frame, row and column of reference image
-    size_t indRef = startIndex;
-    int ke = kStart + kDiff;
-    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
-        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
-        float yr = refImg3D.getOffset().rows + jStart2 * refImg3D.getSpacing().rows;
-
-        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
-
-            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
-            float xr = refImg3D.getOffset().columns + iStart2 * refImg3D.getSpacing().columns;
-
-            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
-                float doseRef = refImg3D.get(indRef);
-
-                bool evalFrameOutsideImage = ke < 0 || ke >= static_cast<int>(evalImg3D.getSize().frames);
-                bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
-                bool divisionByZero = !isGlobal && doseRef == 0;
-                if(evalFrameOutsideImage || doseBelowCutoff || divisionByZero){
-                    gammaVals[indRef] = NaN;
-                }
-                else{
-                    // set squared inversed normalized dd based on the type of normalization (global or local)
-                    float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-
-                    float minGammaValSq = Inf;
-
-                    for(const auto& point : sortedPoints){
-                        const float normalizedDistSq = point.distSq * dtaInvSq;
-                        if(normalizedDistSq >= minGammaValSq){
-                            break;
-                        }
-
-                        float ye = yr + point.y;
-                        float xe = xr + point.x;
-
-                        // instead of calling Interpolate::bilinearAtPoint function,
-                        // here is an inlined, optimized version. It gives 5-10% speedup
-
-                        if(ye < yeMin || ye > yeMax ||
-                            xe < xeMin || xe > xeMax){
-                            continue;
-                        }
-
-                        float tempy = (ye - evalImg3D.getOffset().rows) * rowsSpInv;
-                        float tempx = (xe - evalImg3D.getOffset().columns) * columnsSpInv;
-
-                        const uint32_t indy0 = static_cast<uint32_t>(tempy);
-                        const uint32_t indx0 = static_cast<uint32_t>(tempx);
-                        uint32_t indy1 = indy0 + 1;
-                        uint32_t indx1 = indx0 + 1;
-
-                        if(indy1 == evalImg3D.getSize().rows){
-                            indy1 = indy0;
-                        }
-                        if(indx1 == evalImg3D.getSize().columns){
-                            indx1 = indx0;
-                        }
-
-                        float yd = tempy - static_cast<float>(indy0);
-                        float xd = tempx - static_cast<float>(indx0);
-
-                        float c00 = evalImg3D.get(ke, indy0, indx0);
-                        float c01 = evalImg3D.get(ke, indy1, indx0);
-                        float c10 = evalImg3D.get(ke, indy0, indx1);
-                        float c11 = evalImg3D.get(ke, indy1, indx1);
-
-                        float c0 = c00*(1 - xd) + c10*xd;
-                        float c1 = c01*(1 - xd) + c11*xd;
-
-                        float doseEval = c0*(1 - yd) + c1*yd;
-
-                        // calculate squared gamma
-                        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq + normalizedDistSq;
-                        if(gammaValSq < minGammaValSq){
-                            minGammaValSq = gammaValSq;
-                        }
-                    }
-
-                    if(minGammaValSq != Inf){
-                        gammaVals[indRef] = std::sqrt(minGammaValSq);
-                    }
-                    else{
-                        gammaVals[indRef] = NaN;
-                    }
-                }
-                xr += refImg3D.getSpacing().columns;
-                indRef++;
-            }
-            yr += refImg3D.getSpacing().rows;
-        }
-        ke++;
-    }
+GammaResult gammaIndex2_5DWendling(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                   const GammaParameters& gammaParams){
+    return gammaIndex2_5DWendlingImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
 }
 
-void gammaIndex3DWendlingInternal(const ImageData& refImg3D, const ImageData& evalImg3D,
-                                  const GammaParameters& gammaParams,
-                                  const std::vector<Point3D>& sortedPoints,
-                                  size_t startIndex, size_t endIndex, std::vector<float>& gammaVals){
-    const float ddInvSq = (100 * 100) / (gammaParams.ddThreshold * gammaParams.ddThreshold);
-    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
-    const float ddGlobalNormInvSq = ddInvSq / (gammaParams.globalNormDose * gammaParams.globalNormDose);
-
-    const bool isGlobal = gammaParams.normalization == GammaNormalization::Global;
-
-    const float framesSpInv = 1 / evalImg3D.getSpacing().frames;
-    const float rowsSpInv = 1 / evalImg3D.getSpacing().rows;
-    const float columnsSpInv = 1 / evalImg3D.getSpacing().columns;
-
-    const float zeMin = evalImg3D.getOffset().frames - Tolerance;
-    const float yeMin = evalImg3D.getOffset().rows - Tolerance;
-    const float xeMin = evalImg3D.getOffset().columns - Tolerance;
-    const float zeMax = evalImg3D.getOffset().frames + (evalImg3D.getSize().frames - 1) * evalImg3D.getSpacing().frames + Tolerance;
-    const float yeMax = evalImg3D.getOffset().rows + (evalImg3D.getSize().rows - 1) * evalImg3D.getSpacing().rows + Tolerance;
-    const float xeMax = evalImg3D.getOffset().columns + (evalImg3D.getSize().columns - 1) * evalImg3D.getSpacing().columns + Tolerance;
-
-    const auto [kStart, jStart, iStart] = indexTo3Dindex(startIndex, refImg3D.getSize());
-
-    // iterate over each frame, row and column of reference image
-    size_t indRef = startIndex;
-    float zr = refImg3D.getOffset().frames + kStart * refImg3D.getSpacing().frames;
-    for(uint32_t kr = kStart; kr < refImg3D.getSize().frames && indRef < endIndex; kr++){
-
-        const uint32_t jStart2 = (kr != kStart ? 0 : jStart);
-        float yr = refImg3D.getOffset().rows + jStart2 * refImg3D.getSpacing().rows;
-
-        for(uint32_t jr = jStart2; jr < refImg3D.getSize().rows && indRef < endIndex; jr++){
-
-            const uint32_t iStart2 = (kr != kStart || jr != jStart ? 0 : iStart);
-            float xr = refImg3D.getOffset().columns + iStart2 * refImg3D.getSpacing().columns;
-
-            for(uint32_t ir = iStart2; ir < refImg3D.getSize().columns && indRef < endIndex; ir++){
-                float doseRef = refImg3D.get(indRef);
-
-                bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
-                bool divisionByZero = !isGlobal && doseRef == 0;
-                if(doseBelowCutoff || divisionByZero){
-                    gammaVals[indRef] = NaN;
-                }
-                else{
-                    // set squared inversed normalized dd based on the type of normalization (global or local)
-                    float ddNormInvSq = (isGlobal ? ddGlobalNormInvSq : (ddInvSq / (doseRef * doseRef)));
-
-                    float minGammaValSq = Inf;
-
-                    for(const auto& point : sortedPoints){
-                        const float normalizedDistSq = point.distSq * dtaInvSq;
-                        if(normalizedDistSq >= minGammaValSq){
-                            break;
-                        }
-
-                        float ze = zr + point.z;
-                        float ye = yr + point.y;
-                        float xe = xr + point.x;
-
-                        // instead of calling Interpolate::trilinearAtPoint function,
-                        // here is an inlined, optimized version. It gives 5-10% speedup
-
-                        if(ze < zeMin || ze > zeMax ||
-                           ye < yeMin || ye > yeMax ||
-                           xe < xeMin || xe > xeMax){
-                            continue;
-                        }
-
-                        float tempz = (ze - evalImg3D.getOffset().frames) * framesSpInv;
-                        float tempy = (ye - evalImg3D.getOffset().rows) * rowsSpInv;
-                        float tempx = (xe - evalImg3D.getOffset().columns) * columnsSpInv;
-
-                        const uint32_t indz0 = static_cast<uint32_t>(tempz);
-                        const uint32_t indy0 = static_cast<uint32_t>(tempy);
-                        const uint32_t indx0 = static_cast<uint32_t>(tempx);
-                        uint32_t indz1 = indz0 + 1;
-                        uint32_t indy1 = indy0 + 1;
-                        uint32_t indx1 = indx0 + 1;
-
-                        if(indz1 == evalImg3D.getSize().frames){
-                            indz1 = indz0;
-                        }
-                        if(indy1 == evalImg3D.getSize().rows){
-                            indy1 = indy0;
-                        }
-                        if(indx1 == evalImg3D.getSize().columns){
-                            indx1 = indx0;
-                        }
-
-                        float zd = tempz - static_cast<float>(indz0);
-                        float yd = tempy - static_cast<float>(indy0);
-                        float xd = tempx - static_cast<float>(indx0);
+GammaResult gammaIndex3DWendling(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                 const GammaParameters& gammaParams){
+    return gammaIndex3DWendlingImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
+}
 
-                        float c000 = evalImg3D.get(indz0, indy0, indx0);
-                        float c001 = evalImg3D.get(indz1, indy0, indx0);
-                        float c010 = evalImg3D.get(indz0, indy1, indx0);
-                        float c011 = evalImg3D.get(indz1, indy1, indx0);
-                        float c100 = evalImg3D.get(indz0, indy0, indx1);
-                        float c101 = evalImg3D.get(indz1, indy0, indx1);
-                        float c110 = evalImg3D.get(indz0, indy1, indx1);
-                        float c111 = evalImg3D.get(indz1, indy1, indx1);
+GammaTargetResult gammaIndex2DWendlingWithTarget(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                                 const GammaParameters& gammaParams,
+                                                 const GammaPassingRateTarget& target){
+    return gammaIndex2DWendlingWithTargetImpl<ThreadedExecution>(refImg2D, evalImg2D, gammaParams, target);
+}
 
-                        float c00 = c000*(1 - xd) + c100*xd;
-                        float c01 = c001*(1 - xd) + c101*xd;
-                        float c10 = c010*(1 - xd) + c110*xd;
-                        float c11 = c011*(1 - xd) + c111*xd;
+GammaTargetResult gammaIndex2_5DWendlingWithTarget(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                   const GammaParameters& gammaParams,
+                                                   const GammaPassingRateTarget& target){
+    return gammaIndex2_5DWendlingWithTargetImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams, target);
+}
 
-                        float c0 = c00*(1 - yd) + c10*yd;
-                        float c1 = c01*(1 - yd) + c11*yd;
+GammaTargetResult gammaIndex3DWendlingWithTarget(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                 const GammaParameters& gammaParams,
+                                                 const GammaPassingRateTarget& target){
+    return gammaIndex3DWendlingWithTargetImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams, target);
+}
 
-                        float doseEval = c0*(1 - zd) + c1*zd;
+void gammaIndex3DWendlingStreamed(const StreamedImage& refImg3D, const StreamedImage& evalImg3D,
+                                  const GammaParameters& gammaParams, uint32_t slabFrames,
+                                  const GammaSlabWriter& writeSlab){
+    gammaIndex3DWendlingStreamedImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams, slabFrames, writeSlab);
+}
 
-                        // calculate squared gamma
-                        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq + normalizedDistSq;
-                        if(gammaValSq < minGammaValSq){
-                            minGammaValSq = gammaValSq;
-                        }
-                    }
+GammaResult gammaIndex2DClassic(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
+                                const GammaParameters& gammaParams){
+    return gammaIndex2DClassicCompactImpl(refImg2D, evalImg2D, gammaParams, gammaIndex2DClassicImpl<ThreadedExecution>);
+}
 
-                    if(minGammaValSq != Inf){
-                        gammaVals[indRef] = std::sqrt(minGammaValSq);
-                    }
-                    else{
-                        gammaVals[indRef] = NaN;
-                    }
-                }
-                xr += refImg3D.getSpacing().columns;
-                indRef++;
-            }
-            yr += refImg3D.getSpacing().rows;
-        }
-        zr += refImg3D.getSpacing().frames;
-    }
+GammaResult gammaIndex2_5DClassic(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                  const GammaParameters& gammaParams){
+    return gammaIndex2_5DClassicCompactImpl(refImg3D, evalImg3D, gammaParams, gammaIndex2_5DClassicImpl<ThreadedExecution>);
 }
+
+GammaResult gammaIndex3DClassic(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
+                                const GammaParameters& gammaParams){
+    return gammaIndex3DClassicCompactImpl(refImg3D, evalImg3D, gammaParams, gammaIndex3DClassicImpl<ThreadedExecution>);
 }
 
-GammaResult gammaIndex2DWendling(const ImageData& refImg2D, const ImageData& evalImg2D,
+GammaResult gammaIndex2DWendling(const CompactImageData& refImg2D, const CompactImageData& evalImg2D,
                                  const GammaParameters& gammaParams){
-    validateImages2D(refImg2D, evalImg2D);
-    validateGammaParameters(gammaParams);
-    validateWendlingGammaParameters(gammaParams);
-
-    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
-
-    std::vector<float> gammaVals =
-        loadBalancingMultithreadedGammaIndex(refImg2D.size(), gammaIndex2DWendlingInternal,
-                                             std::cref(refImg2D), std::cref(evalImg2D),
-                                             std::cref(gammaParams), std::cref(sortedPoints));
-
-    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+    return gammaIndex2DWendlingCompactImpl<ThreadedExecution>(refImg2D, evalImg2D, gammaParams);
 }
 
-GammaResult gammaIndex2_5DWendling(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex2_5DWendling(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
                                    const GammaParameters& gammaParams){
-    validateGammaParameters(gammaParams);
-    validateWendlingGammaParameters(gammaParams);
-
-    const ImageData evalImgInterpolatedZ = Interpolation::linearAlongAxis(evalImg3D, refImg3D, ImageAxis::Z);
-    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
-
-    std::vector<float> gammaVals =
-        loadBalancingMultithreadedGammaIndex(refImg3D.size(), gammaIndex2_5DWendlingInternal,
-                                             std::cref(refImg3D), std::cref(evalImgInterpolatedZ),
-                                             std::cref(gammaParams), std::cref(sortedPoints));
-
-    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+    return gammaIndex2_5DWendlingCompactImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
 }
 
-GammaResult gammaIndex3DWendling(const ImageData& refImg3D, const ImageData& evalImg3D,
+GammaResult gammaIndex3DWendling(const CompactImageData& refImg3D, const CompactImageData& evalImg3D,
                                  const GammaParameters& gammaParams){
-    validateGammaParameters(gammaParams);
-    validateWendlingGammaParameters(gammaParams);
+    return gammaIndex3DWendlingCompactImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
+}
 
-    const auto sortedPoints = sortedPointsInSphere(gammaParams.maxSearchDistance, gammaParams.stepSize);
+GammaResult gammaIndex2DChi(const ImageView& refImg2D, const ImageView& evalImg2D,
+                            const GammaParameters& gammaParams){
+    return gammaIndex2DChiImpl<ThreadedExecution>(refImg2D, evalImg2D, gammaParams);
+}
 
-    std::vector<float> gammaVals =
-        loadBalancingMultithreadedGammaIndex(refImg3D.size(), gammaIndex3DWendlingInternal,
-                                             std::cref(refImg3D), std::cref(evalImg3D),
-                                             std::cref(gammaParams), std::cref(sortedPoints));
+GammaResult gammaIndex2_5DChi(const ImageView& refImg3D, const ImageView& evalImg3D,
+                              const GammaParameters& gammaParams){
+    return gammaIndex2_5DChiImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
+}
 
-    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+GammaResult gammaIndex3DChi(const ImageView& refImg3D, const ImageView& evalImg3D,
+                            const GammaParameters& gammaParams){
+    return gammaIndex3DChiImpl<ThreadedExecution>(refImg3D, evalImg3D, gammaParams);
 }
 
 }
@@ -20,8 +20,10 @@
 
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <functional>
 
-#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
 #include "yagit/GammaParameters.hpp"
 
 #include "GammaCommon.hpp"
@@ -32,7 +34,7 @@ namespace yagit{
 
 namespace{
 std::vector<std::pair<size_t, size_t>> generateCalcRanges(uint32_t nrOfRanges, size_t nrOfCalcs,
-                                                          const std::vector<float>& gammaVals){
+                                                          const GammaValues& gammaVals){
     std::vector<std::pair<size_t, size_t>> result;
     result.reserve(nrOfRanges);
 
@@ -70,26 +72,11 @@ std::vector<std::pair<size_t, size_t>> generateCalcRanges(uint32_t nrOfRanges, s
 }
 
 template <typename Function, typename... Args>
-std::vector<float> multithreadedGammaIndex(const ImageData& refImg, const GammaParameters& gammaParams,
-                                           Function&& func, Args&&... args){
-    std::vector<float> gammaVals;
-    gammaVals.reserve(refImg.size());
-
-    size_t nrOfCalcs = 0;
-    const bool isLocal = gammaParams.normalization == GammaNormalization::Local;
+GammaValues multithreadedGammaIndex(const ImageView& refImg, const GammaParameters& gammaParams,
+                                    Function&& func, Args&&... args){
     // preprocess gammaVals
-    for(size_t i = 0; i < refImg.size(); i++){
-        float doseRef = refImg.get(i);
-        bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
-        bool divisionByZero = isLocal && doseRef == 0;
-        if(doseBelowCutoff || divisionByZero){
-            gammaVals.emplace_back(NaN);
-        }
-        else{
-            gammaVals.emplace_back(Inf);
-            nrOfCalcs++;
-        }
-    }
+    GammaValues gammaVals = initGammaVals(refImg, gammaParams);
+    const size_t nrOfCalcs = std::count(gammaVals.begin(), gammaVals.end(), Inf);
 
     const uint32_t nrOfThreads = static_cast<uint32_t>(
         std::min(static_cast<size_t>(std::thread::hardware_concurrency()), refImg.size()));
@@ -114,8 +101,7 @@ std::vector<float> multithreadedGammaIndex(const ImageData& refImg, const GammaP
 }
 
 namespace{
-void addTasksToQueue(LoadBalancingQueue& queue, size_t size, uint32_t nrOfThreads){
-    const size_t maxTaskSize = 256;
+void addTasksToQueue(LoadBalancingQueue& queue, size_t size, uint32_t nrOfThreads, size_t maxTaskSize){
     const size_t taskSize = std::min(maxTaskSize, std::max(size / nrOfThreads, static_cast<size_t>(1)));
 
     for(uint32_t i = 0; i < size; i += taskSize){
@@ -126,7 +112,7 @@ void addTasksToQueue(LoadBalancingQueue& queue, size_t size, uint32_t nrOfThread
 }
 
 template <typename Function, typename... Args>
-void loadBalancingMultithreadedGammaIndexInternal(Function&& func, Args&&... args, std::vector<float>& gammaVals,
+void loadBalancingMultithreadedGammaIndexInternal(Function&& func, Args&&... args, GammaValues& gammaVals,
                                                   LoadBalancingQueue& tasks){
     while(true){
         if(auto task = tasks.safePop(); task.has_value()){
@@ -139,16 +125,18 @@ void loadBalancingMultithreadedGammaIndexInternal(Function&& func, Args&&... arg
     }
 }
 
+// tasks are single tiles, so func is called with range of tile indices.
+// Voxels of tiles that are not processed (see forEachTileMonitored) stay NaN
 template <typename Function, typename... Args>
-std::vector<float> loadBalancingMultithreadedGammaIndex(size_t refImgSize, Function&& func, Args&&... args){
-    std::vector<float> gammaVals(refImgSize, 0.0f);
+GammaValues loadBalancingMultithreadedGammaIndex(size_t refImgSize, size_t nrOfTiles, Function&& func, Args&&... args){
+    GammaValues gammaVals(refImgSize, NaN);
 
     const uint32_t nrOfThreads = static_cast<uint32_t>(
-        std::min(static_cast<size_t>(std::thread::hardware_concurrency()), refImgSize));
+        std::min(static_cast<size_t>(std::thread::hardware_concurrency()), nrOfTiles));
     
     if(nrOfThreads > 1){  // multi-threaded
         LoadBalancingQueue tasks;
-        addTasksToQueue(tasks, gammaVals.size(), nrOfThreads);
+        addTasksToQueue(tasks, nrOfTiles, nrOfThreads, 1);
 
         std::vector<std::thread> threads;
         threads.reserve(nrOfThreads);
@@ -162,7 +150,7 @@ std::vector<float> loadBalancingMultithreadedGammaIndex(size_t refImgSize, Funct
         }
     }
     else{  // single-threaded
-        func(args..., 0, refImgSize, gammaVals);
+        func(args..., 0, nrOfTiles, gammaVals);
     }
 
     return gammaVals;
@@ -170,20 +158,20 @@ std::vector<float> loadBalancingMultithreadedGammaIndex(size_t refImgSize, Funct
 }
 
 namespace{
-std::tuple<uint32_t, uint32_t> indexTo2Dindex(size_t index, const DataSize& size){
-    uint32_t j = index / size.columns;
-    uint32_t i = index % size.columns;
-    return {j, i};
-}
+// Execution policy that runs gamma kernels in multiple threads (see SequentialExecution)
+struct ThreadedExecution{
+    template <typename Function, typename... Args>
+    static GammaValues forEachVoxel(const ImageView& refImg, const GammaParameters& gammaParams,
+                                    Function&& func, Args&&... args){
+        return multithreadedGammaIndex(refImg, gammaParams, std::forward<Function>(func), std::forward<Args>(args)...);
+    }
 
-std::tuple<uint32_t, uint32_t, uint32_t> indexTo3Dindex(size_t index, const DataSize& size){
-    uint32_t refRcSize = size.rows * size.columns;
-    uint32_t k = index / refRcSize;
-    uint32_t temp = index % refRcSize;
-    uint32_t j = temp / size.columns;
-    uint32_t i = temp % size.columns;
-    return {k, j, i};
-}
+    template <typename Function, typename... Args>
+    static GammaValues forEachTile(size_t refImgSize, size_t nrOfTiles, Function&& func, Args&&... args){
+        return loadBalancingMultithreadedGammaIndex(refImgSize, nrOfTiles, std::forward<Function>(func),
+                                                    std::forward<Args>(args)...);
+    }
+};
 }
 
 }
@@ -0,0 +1,488 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include "yagit/ImageData.hpp"
+#include "yagit/ImageView.hpp"
+#include "yagit/GammaParameters.hpp"
+#include "yagit/GammaResult.hpp"
+#include "yagit/Interpolation.hpp"
+
+#include "GammaCommon.hpp"
+#include "BrickedImage.hpp"
+#include "PaddedImage.hpp"
+#include "LazyEvalFrames.hpp"
+#include "WendlingSearch.hpp"
+
+namespace yagit{
+
+// Kernels of Wendling method shared by all versions of gamma index.
+// They are specialized at compile time for the type of normalization and interpolation,
+// and the *Impl functions run them with Execution policy (SequentialExecution or ThreadedExecution).
+// Set of kernels is also a policy (Kernels), so the vectorized versions can replace the scalar ones.
+namespace{
+template <typename Normalization, typename Interpolation, typename EvalImage = PaddedImage<>>
+void gammaIndex2DWendlingInternal(const ImageView& refImg2D, const EvalImage& evalImg2D,
+                                  const GammaParameters& gammaParams,
+                                  const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                  const std::vector<Tile>& tiles,
+                                  size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const EvalGrid evalGrid(evalImg2D);
+
+    // iterate over each row and column of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        float yr = refImg2D.getOffset().rows + tile.jBegin * refImg2D.getSpacing().rows;
+        for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+            size_t indRef = static_cast<size_t>(jr) * refImg2D.getSize().columns + tile.iBegin;
+            float xr = refImg2D.getOffset().columns + tile.iBegin * refImg2D.getSpacing().columns;
+
+            for(uint32_t ir = tile.iBegin; ir < tile.iEnd; ir++){
+                if constexpr(WendlingPrefetchNextVoxelPoints > 0){
+                    // the first points of the next voxel are loaded while the search for this voxel is running
+                    const float xrNext = xr + refImg2D.getSpacing().columns;
+                    if(ir + 1 < tile.iEnd && isSearchAreaInside(evalGrid, searchExtent, yr, xrNext)){
+                        prefetchFirstPoints2D(evalImg2D, 0, evalGrid, sortedPoints, yr, xrNext);
+                    }
+                }
+
+                float doseRef = refImg2D.get(indRef);
+
+                bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
+                bool divisionByZero = Normalization::isDivisionByZero(doseRef);
+                if(doseBelowCutoff || divisionByZero){
+                    gammaVals[indRef] = NaN;
+                }
+                else{
+                    const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+
+                    // interior voxels (with search area inside evaluated image) don't need bounds checks
+                    const float minGammaValSq = isSearchAreaInside(evalGrid, searchExtent, yr, xr) ?
+                        minGammaValSqWendling2D<Interpolation, false>(evalImg2D, 0, evalGrid, sortedPoints, dtaInvSq,
+                                                       yr, xr, doseRef, ddNormInvSq) :
+                        minGammaValSqWendling2D<Interpolation, true>(evalImg2D, 0, evalGrid, sortedPoints, dtaInvSq,
+                                                      yr, xr, doseRef, ddNormInvSq);
+
+                    if(minGammaValSq != Inf){
+                        gammaVals[indRef] = std::sqrt(minGammaValSq);
+                    }
+                    else{
+                        gammaVals[indRef] = NaN;
+                    }
+                }
+                xr += refImg2D.getSpacing().columns;
+                indRef++;
+            }
+            yr += refImg2D.getSpacing().rows;
+        }
+    }
+}
+
+template <typename Normalization, typename Interpolation>
+void gammaIndex2_5DWendlingInternal(const ImageView& refImg3D, const LazyEvalFrames& evalFrames,
+                                    const GammaParameters& gammaParams,
+                                    const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                    const std::vector<Tile>& tiles,
+                                    size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    // iterate over each frame, row and column of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        for(uint32_t kr = tile.kBegin; kr < tile.kEnd; kr++){
+            // evaluated frame interpolated at position of reference frame (nullptr if it's outside evaluated image)
+            const PaddedImage<>* evalFrame = evalFrames.acquire(kr);
+            if(evalFrame == nullptr){
+                for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+                    size_t indRef = (static_cast<size_t>(kr) * refImg3D.getSize().rows + jr) * refImg3D.getSize().columns + tile.iBegin;
+                    std::fill_n(gammaVals.begin() + indRef, tile.iEnd - tile.iBegin, NaN);
+                }
+                evalFrames.release(kr);
+                continue;
+            }
+            const EvalGrid evalGrid(*evalFrame);
+            float yr = refImg3D.getOffset().rows + tile.jBegin * refImg3D.getSpacing().rows;
+
+            for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+                size_t indRef = (static_cast<size_t>(kr) * refImg3D.getSize().rows + jr) * refImg3D.getSize().columns + tile.iBegin;
+                float xr = refImg3D.getOffset().columns + tile.iBegin * refImg3D.getSpacing().columns;
+
+                for(uint32_t ir = tile.iBegin; ir < tile.iEnd; ir++){
+                    if constexpr(WendlingPrefetchNextVoxelPoints > 0){
+                        // see gammaIndex2DWendlingInternal
+                        const float xrNext = xr + refImg3D.getSpacing().columns;
+                        if(ir + 1 < tile.iEnd && isSearchAreaInside(evalGrid, searchExtent, yr, xrNext)){
+                            prefetchFirstPoints2D(*evalFrame, 0, evalGrid, sortedPoints, yr, xrNext);
+                        }
+                    }
+
+                    float doseRef = refImg3D.get(indRef);
+
+                    bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
+                    bool divisionByZero = Normalization::isDivisionByZero(doseRef);
+                    if(doseBelowCutoff || divisionByZero){
+                        gammaVals[indRef] = NaN;
+                    }
+                    else{
+                        const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+
+                        // interior voxels (with search area inside evaluated image) don't need bounds checks
+                        const float minGammaValSq = isSearchAreaInside(evalGrid, searchExtent, yr, xr) ?
+                            minGammaValSqWendling2D<Interpolation, false>(*evalFrame, 0, evalGrid, sortedPoints, dtaInvSq,
+                                                           yr, xr, doseRef, ddNormInvSq) :
+                            minGammaValSqWendling2D<Interpolation, true>(*evalFrame, 0, evalGrid, sortedPoints, dtaInvSq,
+                                                          yr, xr, doseRef, ddNormInvSq);
+
+                        if(minGammaValSq != Inf){
+                            gammaVals[indRef] = std::sqrt(minGammaValSq);
+                        }
+                        else{
+                            gammaVals[indRef] = NaN;
+                        }
+                    }
+                    xr += refImg3D.getSpacing().columns;
+                    indRef++;
+                }
+                yr += refImg3D.getSpacing().rows;
+            }
+            evalFrames.release(kr);
+        }
+    }
+}
+
+template <typename Normalization, typename Interpolation, typename EvalImage = BrickedImage<>>
+void gammaIndex3DWendlingInternal(const ImageView& refImg3D, const EvalImage& evalImg3D,
+                                  const GammaParameters& gammaParams,
+                                  const std::vector<Point3D>& sortedPoints, const SearchExtent& searchExtent,
+                                  const std::vector<Tile>& tiles,
+                                  size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const EvalGrid evalGrid(evalImg3D);
+
+    // iterate over each frame, row and column of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        float zr = refImg3D.getOffset().frames + tile.kBegin * refImg3D.getSpacing().frames;
+        for(uint32_t kr = tile.kBegin; kr < tile.kEnd; kr++){
+            float yr = refImg3D.getOffset().rows + tile.jBegin * refImg3D.getSpacing().rows;
+
+            for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+                size_t indRef = (static_cast<size_t>(kr) * refImg3D.getSize().rows + jr) * refImg3D.getSize().columns + tile.iBegin;
+                float xr = refImg3D.getOffset().columns + tile.iBegin * refImg3D.getSpacing().columns;
+
+                for(uint32_t ir = tile.iBegin; ir < tile.iEnd; ir++){
+                    if constexpr(WendlingPrefetchNextVoxelPoints > 0){
+                        // see gammaIndex2DWendlingInternal
+                        const float xrNext = xr + refImg3D.getSpacing().columns;
+                        if(ir + 1 < tile.iEnd && isSearchAreaInside(evalGrid, searchExtent, zr, yr, xrNext)){
+                            prefetchFirstPoints3D(evalImg3D, evalGrid, sortedPoints, zr, yr, xrNext);
+                        }
+                    }
+
+                    float doseRef = refImg3D.get(indRef);
+
+                    bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
+                    bool divisionByZero = Normalization::isDivisionByZero(doseRef);
+                    if(doseBelowCutoff || divisionByZero){
+                        gammaVals[indRef] = NaN;
+                    }
+                    else{
+                        const float ddNormInvSq = normalization.ddNormInvSq(doseRef);
+
+                        // interior voxels (with search area inside evaluated image) don't need bounds checks
+                        const float minGammaValSq = isSearchAreaInside(evalGrid, searchExtent, zr, yr, xr) ?
+                            minGammaValSqWendling3D<Interpolation, false>(evalImg3D, evalGrid, sortedPoints, dtaInvSq,
+                                                           zr, yr, xr, doseRef, ddNormInvSq) :
+                            minGammaValSqWendling3D<Interpolation, true>(evalImg3D, evalGrid, sortedPoints, dtaInvSq,
+                                                          zr, yr, xr, doseRef, ddNormInvSq);
+
+                        if(minGammaValSq != Inf){
+                            gammaVals[indRef] = std::sqrt(minGammaValSq);
+                        }
+                        else{
+                            gammaVals[indRef] = NaN;
+                        }
+                    }
+                    xr += refImg3D.getSpacing().columns;
+                    indRef++;
+                }
+                yr += refImg3D.getSpacing().rows;
+            }
+            zr += refImg3D.getSpacing().frames;
+        }
+    }
+}
+
+// kernels processing one reference voxel at a time.
+// 2D and 3D kernels read evaluated image of type EvalImage - padded/bricked image of float
+// or of raw 16-bit values of CompactImageData (ReadsCompactValues)
+struct WendlingKernels{
+    static constexpr bool ReadsCompactValues = true;
+
+    template <typename Normalization, typename Interpolation, typename EvalImage = PaddedImage<>>
+    static constexpr auto gammaIndex2D = gammaIndex2DWendlingInternal<Normalization, Interpolation, EvalImage>;
+    template <typename Normalization, typename Interpolation>
+    static constexpr auto gammaIndex2_5D = gammaIndex2_5DWendlingInternal<Normalization, Interpolation>;
+    template <typename Normalization, typename Interpolation, typename EvalImage = BrickedImage<>>
+    static constexpr auto gammaIndex3D = gammaIndex3DWendlingInternal<Normalization, Interpolation, EvalImage>;
+};
+
+// gamma index values of 2D Wendling method (shared by gammaIndex2DWendlingImpl and its compact version)
+template <typename Execution, typename Kernels, typename EvalImage>
+GammaValues gammaIndex2DWendlingVals(const ImageView& refImg2D, const EvalImage& evalImgPadded,
+                                     const GammaParameters& gammaParams,
+                                     const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                     PassingRateMonitor* monitor = nullptr){
+    const auto tiles = generateWendlingTiles(refImg2D.getSize(), TileSize2D, gammaParams);
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return dispatchInterpolation(gammaParams.interpolation, [&](auto interpolationTag){
+            using Interpolation = typename decltype(interpolationTag)::type;
+            return forEachTileMonitored<Execution>(refImg2D.size(), tiles, monitor,
+                                                   Kernels::template gammaIndex2D<Normalization, Interpolation, EvalImage>,
+                                                   refImg2D, evalImgPadded, gammaParams, sortedPoints, searchExtent, tiles);
+        });
+    });
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex2DWendlingImpl(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                     const GammaParameters& gammaParams, PassingRateMonitor* monitor = nullptr){
+    if(!refImg2D.isContiguous() || !evalImg2D.isContiguous()){
+        return gammaIndex2DWendlingImpl<Execution, Kernels>(ContiguousImage(refImg2D), ContiguousImage(evalImg2D),
+                                                            gammaParams, monitor);
+    }
+
+    validateImages2D(refImg2D, evalImg2D);
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+    const PaddedImage<> evalImgPadded(evalImg2D, 1);
+
+    GammaValues gammaVals = gammaIndex2DWendlingVals<Execution, Kernels>(refImg2D, evalImgPadded, gammaParams,
+                                                                         sortedPoints, searchExtent, monitor);
+
+    return GammaResult(std::move(gammaVals), refImg2D.getSize(), refImg2D.getOffset(), refImg2D.getSpacing());
+}
+
+// gamma index values of 2.5D Wendling method (shared by gammaIndex2_5DWendlingImpl and its compact version),
+// evaluated image is ImageView or CompactImageData
+template <typename Execution, typename Kernels, typename EvalImage>
+GammaValues gammaIndex2_5DWendlingVals(const ImageView& refImg3D, const EvalImage& evalImg3D,
+                                       const GammaParameters& gammaParams,
+                                       const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                       PassingRateMonitor* monitor = nullptr){
+    // frames are processed one after another, so evaluated image is interpolated along Z frame by frame
+    // when the first tile of the frame is processed, instead of interpolating the whole image up front
+    const auto tiles = generateWendlingTiles(refImg3D.getSize(), TileSize2D, gammaParams, true);
+    const LazyEvalFrames evalFrames(refImg3D, evalImg3D, tiles);
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return dispatchInterpolation(gammaParams.interpolation, [&](auto interpolationTag){
+            using Interpolation = typename decltype(interpolationTag)::type;
+            return forEachTileMonitored<Execution>(refImg3D.size(), tiles, monitor,
+                                                   Kernels::template gammaIndex2_5D<Normalization, Interpolation>,
+                                                   refImg3D, evalFrames, gammaParams, sortedPoints, searchExtent, tiles);
+        });
+    });
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex2_5DWendlingImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                       const GammaParameters& gammaParams, PassingRateMonitor* monitor = nullptr){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex2_5DWendlingImpl<Execution, Kernels>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                              gammaParams, monitor);
+    }
+
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInCircle(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    GammaValues gammaVals = gammaIndex2_5DWendlingVals<Execution, Kernels>(refImg3D, evalImg3D, gammaParams,
+                                                                           sortedPoints, searchExtent, monitor);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+
+// gamma index values of 3D Wendling method (shared by gammaIndex3DWendlingImpl, its streamed and compact versions)
+template <typename Execution, typename Kernels, typename EvalImage>
+GammaValues gammaIndex3DWendlingVals(const ImageView& refImg3D, const EvalImage& evalImgBricked,
+                                     const GammaParameters& gammaParams,
+                                     const std::vector<Point3D>& sortedPoints, const SearchExtent& searchExtent,
+                                     PassingRateMonitor* monitor = nullptr){
+    // TODO: check if interpolating evalImg on the grid of refImg
+    // and precalculating interpolation factors (for on-the-fly interpolation) will be much faster.
+    // note that result will be less accurate due to interpolating twice
+
+    const auto tiles = generateWendlingTiles(refImg3D.getSize(), TileSize3D, gammaParams);
+
+    return dispatchNormalization(gammaParams.normalization, [&](auto normalizationTag){
+        using Normalization = typename decltype(normalizationTag)::type;
+        return dispatchInterpolation(gammaParams.interpolation, [&](auto interpolationTag){
+            using Interpolation = typename decltype(interpolationTag)::type;
+            return forEachTileMonitored<Execution>(refImg3D.size(), tiles, monitor,
+                                                   Kernels::template gammaIndex3D<Normalization, Interpolation, EvalImage>,
+                                                   refImg3D, evalImgBricked, gammaParams, sortedPoints, searchExtent, tiles);
+        });
+    });
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaResult gammaIndex3DWendlingImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                     const GammaParameters& gammaParams, PassingRateMonitor* monitor = nullptr){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex3DWendlingImpl<Execution, Kernels>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                            gammaParams, monitor);
+    }
+
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+
+    const auto sortedPoints = sortedPointsInSphere(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    // trilinear interpolation reads 2 frames and 2 rows, which are close to each other only in bricked layout
+    const BrickedImage<> evalImgBricked(evalImg3D);
+
+    GammaValues gammaVals = gammaIndex3DWendlingVals<Execution, Kernels>(refImg3D, evalImgBricked, gammaParams,
+                                                                         sortedPoints, searchExtent, monitor);
+
+    return GammaResult(std::move(gammaVals), refImg3D.getSize(), refImg3D.getOffset(), refImg3D.getSpacing());
+}
+
+// gamma index of Wendling method that is stopped as soon as it is known whether passing rate target is met
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaTargetResult gammaIndex2DWendlingWithTargetImpl(const ImageView& refImg2D, const ImageView& evalImg2D,
+                                                     const GammaParameters& gammaParams,
+                                                     const GammaPassingRateTarget& target){
+    if(!refImg2D.isContiguous() || !evalImg2D.isContiguous()){
+        return gammaIndex2DWendlingWithTargetImpl<Execution, Kernels>(ContiguousImage(refImg2D), ContiguousImage(evalImg2D),
+                                                                      gammaParams, target);
+    }
+
+    PassingRateMonitor monitor(refImg2D, gammaParams, target);
+    GammaResult gammaRes = gammaIndex2DWendlingImpl<Execution, Kernels>(refImg2D, evalImg2D, gammaParams, &monitor);
+    return {std::move(gammaRes), monitor.isPartial(), monitor.isTargetMet()};
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaTargetResult gammaIndex2_5DWendlingWithTargetImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                       const GammaParameters& gammaParams,
+                                                       const GammaPassingRateTarget& target){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex2_5DWendlingWithTargetImpl<Execution, Kernels>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                                        gammaParams, target);
+    }
+
+    PassingRateMonitor monitor(refImg3D, gammaParams, target);
+    GammaResult gammaRes = gammaIndex2_5DWendlingImpl<Execution, Kernels>(refImg3D, evalImg3D, gammaParams, &monitor);
+    return {std::move(gammaRes), monitor.isPartial(), monitor.isTargetMet()};
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+GammaTargetResult gammaIndex3DWendlingWithTargetImpl(const ImageView& refImg3D, const ImageView& evalImg3D,
+                                                     const GammaParameters& gammaParams,
+                                                     const GammaPassingRateTarget& target){
+    if(!refImg3D.isContiguous() || !evalImg3D.isContiguous()){
+        return gammaIndex3DWendlingWithTargetImpl<Execution, Kernels>(ContiguousImage(refImg3D), ContiguousImage(evalImg3D),
+                                                                      gammaParams, target);
+    }
+
+    PassingRateMonitor monitor(refImg3D, gammaParams, target);
+    GammaResult gammaRes = gammaIndex3DWendlingImpl<Execution, Kernels>(refImg3D, evalImg3D, gammaParams, &monitor);
+    return {std::move(gammaRes), monitor.isPartial(), monitor.isTargetMet()};
+}
+
+// read frames [frameBegin, frameEnd) of streamed image
+ImageData readSlab(const StreamedImage& img, uint32_t frameBegin, uint32_t frameEnd){
+    const DataSize slabSize{frameEnd - frameBegin, img.size.rows, img.size.columns};
+    ImageData::container_type data = img.readFrames(frameBegin, slabSize.frames);
+    if(data.size() != static_cast<size_t>(slabSize.frames) * slabSize.rows * slabSize.columns){
+        throw std::runtime_error("streamed image returned " + std::to_string(data.size()) + " values instead of " +
+                                 std::to_string(static_cast<size_t>(slabSize.frames) * slabSize.rows * slabSize.columns));
+    }
+    const DataOffset slabOffset{img.offset.frames + frameBegin * img.spacing.frames, img.offset.rows, img.offset.columns};
+    return ImageData(std::move(data), slabSize, slabOffset, img.spacing);
+}
+
+template <typename Execution, typename Kernels = WendlingKernels>
+void gammaIndex3DWendlingStreamedImpl(const StreamedImage& refImg3D, const StreamedImage& evalImg3D,
+                                      const GammaParameters& gammaParams, uint32_t slabFrames,
+                                      const GammaSlabWriter& writeSlab){
+    validateGammaParameters(gammaParams);
+    validateWendlingGammaParameters(gammaParams);
+    if(slabFrames == 0){
+        throw std::invalid_argument("slabFrames should be greater than 0");
+    }
+
+    const auto sortedPoints = sortedPointsInSphere(gammaParams.maxSearchDistance, gammaParams.stepSize);
+    const SearchExtent searchExtent = calcSearchExtent(sortedPoints);
+
+    const float evalZOffset = evalImg3D.offset.frames;
+    const float evalZSpacing = evalImg3D.spacing.frames;
+    const int evalFrames = static_cast<int>(evalImg3D.size.frames);
+
+    for(uint32_t kBegin = 0; kBegin < refImg3D.size.frames; kBegin += slabFrames){
+        const uint32_t kEnd = std::min(kBegin + slabFrames, refImg3D.size.frames);
+        const ImageData refSlab = readSlab(refImg3D, kBegin, kEnd);
+
+        // frames of evaluated image within search distance of the slab (halo), their neighbours needed
+        // by the interpolation, and one more frame on each side in case of floating-point errors
+        const float zMin = refSlab.getOffset().frames - searchExtent.z;
+        const float zMax = refSlab.getOffset().frames + (kEnd - 1 - kBegin) * refImg3D.spacing.frames + searchExtent.z;
+        const int keBegin = std::max(static_cast<int>(std::floor((zMin - evalZOffset) / evalZSpacing)) - 1, 0);
+        const int keEnd = std::min(static_cast<int>(std::ceil((zMax - evalZOffset) / evalZSpacing)) + 2, evalFrames);
+
+        GammaValues gammaVals;
+        if(keBegin < keEnd){
+            const BrickedImage<> evalSlab(readSlab(evalImg3D, keBegin, keEnd));
+            gammaVals = gammaIndex3DWendlingVals<Execution, Kernels>(refSlab, evalSlab, gammaParams,
+                                                                     sortedPoints, searchExtent);
+        }
+        else{
+            gammaVals.assign(refSlab.size(), NaN);
+        }
+
+        writeSlab(GammaResult(std::move(gammaVals), refSlab.getSize(), refSlab.getOffset(), refSlab.getSpacing()),
+                  kBegin);
+    }
+}
+}
+
+}
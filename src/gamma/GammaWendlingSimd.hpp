@@ -0,0 +1,433 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/GammaParameters.hpp"
+
+#include "GammaCommonSimd.hpp"
+#include "BrickedImage.hpp"
+#include "PaddedImage.hpp"
+#include "LazyEvalFrames.hpp"
+#include "WendlingSearch.hpp"
+#include "GammaWendling.hpp"
+
+#include <xsimd/xsimd.hpp>
+
+namespace yagit{
+
+// Wendling method vectorized across reference voxels - SimdElementCount adjacent voxels of a row
+// are processed in lockstep on the same search point. Rows and frames of the search point are the same
+// for all lanes, so only columns of evaluated image are gathered. Lanes whose search has already finished
+// are masked out, and the loop over search points stops when all of them are finished.
+// Each lane visits the same points as the scalar version, so the results are the same.
+namespace{
+using FloatBatch = xsimd::batch<float>;
+using IntBatch = xsimd::batch<int32_t>;
+using FloatBatchBool = xsimd::batch_bool<float>;
+
+// reference voxels of one row loaded into SIMD lanes
+struct RefLanes{
+    FloatBatch xr;
+    FloatBatch doseRef;
+    FloatBatch ddNormInvSq;
+    // lanes that need calculation (with dose not below cutoff etc.)
+    std::array<bool, SimdElementCount> valid;
+    // the smallest and the largest xr among valid lanes
+    float xrMin;
+    float xrMax;
+    bool anyValid;
+};
+
+// load nrOfLanes voxels of reference image starting at indRef.
+// xr is advanced in the same way as in the scalar version, so coordinates are the same
+template <typename Normalization>
+RefLanes loadRefLanes(const ImageView& refImg, size_t indRef, uint32_t nrOfLanes, float& xr,
+                      const GammaParameters& gammaParams, const Normalization& normalization){
+    alignas(FloatBatch::arch_type::alignment()) std::array<float, SimdElementCount> xrArr{};
+    alignas(FloatBatch::arch_type::alignment()) std::array<float, SimdElementCount> doseRefArr{};
+    alignas(FloatBatch::arch_type::alignment()) std::array<float, SimdElementCount> ddNormInvSqArr{};
+
+    RefLanes lanes{};
+    lanes.anyValid = false;
+    for(uint32_t lane = 0; lane < SimdElementCount; lane++){
+        lanes.valid[lane] = false;
+        if(lane < nrOfLanes){
+            const float doseRef = refImg.get(indRef + lane);
+            const bool doseBelowCutoff = doseRef < gammaParams.doseCutoff;
+            const bool divisionByZero = Normalization::isDivisionByZero(doseRef);
+            if(!doseBelowCutoff && !divisionByZero){
+                xrArr[lane] = xr;
+                doseRefArr[lane] = doseRef;
+                ddNormInvSqArr[lane] = normalization.ddNormInvSq(doseRef);
+                lanes.xrMin = (lanes.anyValid ? std::min(lanes.xrMin, xr) : xr);
+                lanes.xrMax = (lanes.anyValid ? std::max(lanes.xrMax, xr) : xr);
+                lanes.valid[lane] = true;
+                lanes.anyValid = true;
+            }
+            xr += refImg.getSpacing().columns;
+        }
+    }
+    if(!lanes.anyValid){
+        return lanes;
+    }
+
+    // invalid lanes get coordinates of a valid lane, so they read voxels inside evaluated image
+    for(uint32_t lane = 0; lane < SimdElementCount; lane++){
+        if(!lanes.valid[lane]){
+            xrArr[lane] = lanes.xrMin;
+        }
+    }
+
+    lanes.xr = xsimd::load_aligned(xrArr.data());
+    lanes.doseRef = xsimd::load_aligned(doseRefArr.data());
+    lanes.ddNormInvSq = xsimd::load_aligned(ddNormInvSqArr.data());
+    return lanes;
+}
+
+// initial minimal squared gamma - Inf for valid lanes, 0 for invalid ones, so they are finished from the start
+FloatBatch initMinGammaValSq(const RefLanes& lanes){
+    alignas(FloatBatch::arch_type::alignment()) std::array<float, SimdElementCount> arr{};
+    for(uint32_t lane = 0; lane < SimdElementCount; lane++){
+        arr[lane] = (lanes.valid[lane] ? Inf : 0.0f);
+    }
+    return xsimd::load_aligned(arr.data());
+}
+
+void storeGammaVals(const RefLanes& lanes, const FloatBatch& minGammaValSqVec, size_t indRef, uint32_t nrOfLanes,
+                    GammaValues& gammaVals){
+    alignas(FloatBatch::arch_type::alignment()) std::array<float, SimdElementCount> minGammaValSq{};
+    xsimd::store_aligned(minGammaValSq.data(), minGammaValSqVec);
+    for(uint32_t lane = 0; lane < nrOfLanes; lane++){
+        if(lanes.valid[lane] && minGammaValSq[lane] != Inf){
+            gammaVals[indRef + lane] = std::sqrt(minGammaValSq[lane]);
+        }
+        else{
+            gammaVals[indRef + lane] = NaN;
+        }
+    }
+}
+
+// vectorized version of minGammaValSqWendling2D (see it for requirements)
+template <bool CheckBounds>
+FloatBatch minGammaValSqWendling2DSimd(const PaddedImage<>& evalImg, uint32_t frame, const EvalGrid& grid,
+                                       const std::vector<Point2D>& sortedPoints, float dtaInvSq,
+                                       float yr, const RefLanes& lanes){
+    FloatBatch minGammaValSqVec = initMinGammaValSq(lanes);
+
+    for(const auto& point : sortedPoints){
+        const float normalizedDistSq = point.distSq * dtaInvSq;
+        const FloatBatch normalizedDistSqVec(normalizedDistSq);
+        FloatBatchBool active = normalizedDistSqVec < minGammaValSqVec;
+        if(!xsimd::any(active)){
+            break;
+        }
+
+        float ye = yr + point.y;
+        FloatBatch xeVec = lanes.xr + FloatBatch(point.x);
+
+        if constexpr(CheckBounds){
+            if(ye < grid.yMin || ye > grid.yMax){
+                continue;
+            }
+            const FloatBatchBool inside = (xeVec >= FloatBatch(grid.xMin)) & (xeVec <= FloatBatch(grid.xMax));
+            active = active & inside;
+            if(!xsimd::any(active)){
+                continue;
+            }
+            // lanes outside image read the first column, their results are discarded
+            xeVec = xsimd::select(inside, xeVec, FloatBatch(grid.xOffset));
+        }
+
+        float tempy = (ye - grid.yOffset) * grid.ySpInv;
+        const FloatBatch tempx = (xeVec - FloatBatch(grid.xOffset)) * FloatBatch(grid.xSpInv);
+
+        const uint32_t indy0 = static_cast<uint32_t>(tempy);
+        const uint32_t indy1 = indy0 + 1;
+        const IntBatch indx0 = xsimd::batch_cast<int32_t>(tempx);
+        const IntBatch indx1 = indx0 + IntBatch(1);
+
+        float yd = tempy - static_cast<float>(indy0);
+        const FloatBatch xd = tempx - xsimd::batch_cast<float>(indx0);
+
+        const float* row0 = evalImg.getRow(frame, indy0);
+        const float* row1 = evalImg.getRow(frame, indy1);
+        const FloatBatch c00 = FloatBatch::gather(row0, indx0);
+        const FloatBatch c01 = FloatBatch::gather(row1, indx0);
+        const FloatBatch c10 = FloatBatch::gather(row0, indx1);
+        const FloatBatch c11 = FloatBatch::gather(row1, indx1);
+
+        const FloatBatch c0 = c00*(FloatBatch(1) - xd) + c10*xd;
+        const FloatBatch c1 = c01*(FloatBatch(1) - xd) + c11*xd;
+
+        const FloatBatch doseEval = c0*FloatBatch(1 - yd) + c1*FloatBatch(yd);
+
+        // calculate squared gamma
+        const FloatBatch gammaValSqVec = (lanes.doseRef - doseEval) * (lanes.doseRef - doseEval) * lanes.ddNormInvSq +
+                                         normalizedDistSqVec;
+        minGammaValSqVec = xsimd::select(active & (gammaValSqVec < minGammaValSqVec), gammaValSqVec, minGammaValSqVec);
+    }
+
+    return minGammaValSqVec;
+}
+
+// vectorized version of minGammaValSqWendling3D (see it for requirements)
+template <bool CheckBounds>
+FloatBatch minGammaValSqWendling3DSimd(const BrickedImage<>& evalImg, const EvalGrid& grid,
+                                       const std::vector<Point3D>& sortedPoints, float dtaInvSq,
+                                       float zr, float yr, const RefLanes& lanes){
+    FloatBatch minGammaValSqVec = initMinGammaValSq(lanes);
+
+    for(const auto& point : sortedPoints){
+        const float normalizedDistSq = point.distSq * dtaInvSq;
+        const FloatBatch normalizedDistSqVec(normalizedDistSq);
+        FloatBatchBool active = normalizedDistSqVec < minGammaValSqVec;
+        if(!xsimd::any(active)){
+            break;
+        }
+
+        float ze = zr + point.z;
+        float ye = yr + point.y;
+        FloatBatch xeVec = lanes.xr + FloatBatch(point.x);
+
+        if constexpr(CheckBounds){
+            if(ze < grid.zMin || ze > grid.zMax ||
+               ye < grid.yMin || ye > grid.yMax){
+                continue;
+            }
+            const FloatBatchBool inside = (xeVec >= FloatBatch(grid.xMin)) & (xeVec <= FloatBatch(grid.xMax));
+            active = active & inside;
+            if(!xsimd::any(active)){
+                continue;
+            }
+            // lanes outside image read the first column, their results are discarded
+            xeVec = xsimd::select(inside, xeVec, FloatBatch(grid.xOffset));
+        }
+
+        float tempz = (ze - grid.zOffset) * grid.zSpInv;
+        float tempy = (ye - grid.yOffset) * grid.ySpInv;
+        const FloatBatch tempx = (xeVec - FloatBatch(grid.xOffset)) * FloatBatch(grid.xSpInv);
+
+        const uint32_t indz0 = static_cast<uint32_t>(tempz);
+        const uint32_t indy0 = static_cast<uint32_t>(tempy);
+        const uint32_t indz1 = indz0 + 1;
+        const uint32_t indy1 = indy0 + 1;
+        const IntBatch indx0 = xsimd::batch_cast<int32_t>(tempx);
+
+        float zd = tempz - static_cast<float>(indz0);
+        float yd = tempy - static_cast<float>(indy0);
+        const FloatBatch xd = tempx - xsimd::batch_cast<float>(indx0);
+
+        // 4 rows of bricks with corners, columns are gathered from them
+        const float* z0y0 = evalImg.data() + evalImg.frameOffset(indz0) + evalImg.rowOffset(indy0);
+        const float* z1y0 = evalImg.data() + evalImg.frameOffset(indz1) + evalImg.rowOffset(indy0);
+        const float* z0y1 = evalImg.data() + evalImg.frameOffset(indz0) + evalImg.rowOffset(indy1);
+        const float* z1y1 = evalImg.data() + evalImg.frameOffset(indz1) + evalImg.rowOffset(indy1);
+        const IntBatch x0 = BrickedImage<>::columnOffset(indx0);
+        const IntBatch x1 = BrickedImage<>::columnOffset(indx0 + IntBatch(1));
+
+        const FloatBatch c000 = FloatBatch::gather(z0y0, x0);
+        const FloatBatch c001 = FloatBatch::gather(z1y0, x0);
+        const FloatBatch c010 = FloatBatch::gather(z0y1, x0);
+        const FloatBatch c011 = FloatBatch::gather(z1y1, x0);
+        const FloatBatch c100 = FloatBatch::gather(z0y0, x1);
+        const FloatBatch c101 = FloatBatch::gather(z1y0, x1);
+        const FloatBatch c110 = FloatBatch::gather(z0y1, x1);
+        const FloatBatch c111 = FloatBatch::gather(z1y1, x1);
+
+        const FloatBatch c00 = c000*(FloatBatch(1) - xd) + c100*xd;
+        const FloatBatch c01 = c001*(FloatBatch(1) - xd) + c101*xd;
+        const FloatBatch c10 = c010*(FloatBatch(1) - xd) + c110*xd;
+        const FloatBatch c11 = c011*(FloatBatch(1) - xd) + c111*xd;
+
+        const FloatBatch c0 = c00*FloatBatch(1 - yd) + c10*FloatBatch(yd);
+        const FloatBatch c1 = c01*FloatBatch(1 - yd) + c11*FloatBatch(yd);
+
+        const FloatBatch doseEval = c0*FloatBatch(1 - zd) + c1*FloatBatch(zd);
+
+        // calculate squared gamma
+        const FloatBatch gammaValSqVec = (lanes.doseRef - doseEval) * (lanes.doseRef - doseEval) * lanes.ddNormInvSq +
+                                         normalizedDistSqVec;
+        minGammaValSqVec = xsimd::select(active & (gammaValSqVec < minGammaValSqVec), gammaValSqVec, minGammaValSqVec);
+    }
+
+    return minGammaValSqVec;
+}
+}
+
+namespace{
+// calculate gamma for one row of a tile in 2D/2.5D (frame is the frame of evaluated image)
+template <typename Normalization>
+void gammaIndexRowWendlingSimd(const ImageView& refImg, const PaddedImage<>& evalImg, uint32_t frame,
+                               const GammaParameters& gammaParams, const Normalization& normalization,
+                               const EvalGrid& evalGrid, const std::vector<Point2D>& sortedPoints,
+                               const SearchExtent& searchExtent, float dtaInvSq,
+                               const Tile& tile, size_t indRef, float yr, GammaValues& gammaVals){
+    float xr = refImg.getOffset().columns + tile.iBegin * refImg.getSpacing().columns;
+
+    for(uint32_t ir = tile.iBegin; ir < tile.iEnd; ir += SimdElementCount){
+        const uint32_t nrOfLanes = std::min(static_cast<uint32_t>(SimdElementCount), tile.iEnd - ir);
+        const RefLanes lanes = loadRefLanes(refImg, indRef, nrOfLanes, xr, gammaParams, normalization);
+
+        if(lanes.anyValid){
+            // search areas of lanes between xrMin and xrMax are inside too
+            const bool inside = isSearchAreaInside(evalGrid, searchExtent, yr, lanes.xrMin) &&
+                                isSearchAreaInside(evalGrid, searchExtent, yr, lanes.xrMax);
+            const FloatBatch minGammaValSqVec = inside ?
+                minGammaValSqWendling2DSimd<false>(evalImg, frame, evalGrid, sortedPoints, dtaInvSq, yr, lanes) :
+                minGammaValSqWendling2DSimd<true>(evalImg, frame, evalGrid, sortedPoints, dtaInvSq, yr, lanes);
+            storeGammaVals(lanes, minGammaValSqVec, indRef, nrOfLanes, gammaVals);
+        }
+        else{
+            std::fill_n(gammaVals.begin() + indRef, nrOfLanes, NaN);
+        }
+        indRef += nrOfLanes;
+    }
+}
+
+template <typename Normalization>
+void gammaIndex2DWendlingSimdInternal(const ImageView& refImg2D, const PaddedImage<>& evalImg2D,
+                                      const GammaParameters& gammaParams,
+                                      const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                      const std::vector<Tile>& tiles,
+                                      size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const EvalGrid evalGrid(evalImg2D);
+
+    // iterate over each row of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        float yr = refImg2D.getOffset().rows + tile.jBegin * refImg2D.getSpacing().rows;
+        for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+            size_t indRef = static_cast<size_t>(jr) * refImg2D.getSize().columns + tile.iBegin;
+            gammaIndexRowWendlingSimd(refImg2D, evalImg2D, 0, gammaParams, normalization, evalGrid,
+                                      sortedPoints, searchExtent, dtaInvSq, tile, indRef, yr, gammaVals);
+            yr += refImg2D.getSpacing().rows;
+        }
+    }
+}
+
+template <typename Normalization>
+void gammaIndex2_5DWendlingSimdInternal(const ImageView& refImg3D, const LazyEvalFrames& evalFrames,
+                                        const GammaParameters& gammaParams,
+                                        const std::vector<Point2D>& sortedPoints, const SearchExtent& searchExtent,
+                                        const std::vector<Tile>& tiles,
+                                        size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    // iterate over each frame and row of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        for(uint32_t kr = tile.kBegin; kr < tile.kEnd; kr++){
+            // see gammaIndex2_5DWendlingInternal
+            const PaddedImage<>* evalFrame = evalFrames.acquire(kr);
+            float yr = refImg3D.getOffset().rows + tile.jBegin * refImg3D.getSpacing().rows;
+
+            for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+                size_t indRef = (static_cast<size_t>(kr) * refImg3D.getSize().rows + jr) * refImg3D.getSize().columns + tile.iBegin;
+                if(evalFrame == nullptr){
+                    std::fill_n(gammaVals.begin() + indRef, tile.iEnd - tile.iBegin, NaN);
+                }
+                else{
+                    gammaIndexRowWendlingSimd(refImg3D, *evalFrame, 0, gammaParams, normalization, EvalGrid(*evalFrame),
+                                              sortedPoints, searchExtent, dtaInvSq, tile, indRef, yr, gammaVals);
+                }
+                yr += refImg3D.getSpacing().rows;
+            }
+            evalFrames.release(kr);
+        }
+    }
+}
+
+template <typename Normalization>
+void gammaIndex3DWendlingSimdInternal(const ImageView& refImg3D, const BrickedImage<>& evalImg3D,
+                                      const GammaParameters& gammaParams,
+                                      const std::vector<Point3D>& sortedPoints, const SearchExtent& searchExtent,
+                                      const std::vector<Tile>& tiles,
+                                      size_t startTile, size_t endTile, GammaValues& gammaVals){
+    const Normalization normalization(gammaParams);
+    const float dtaInvSq = 1 / (gammaParams.dtaThreshold * gammaParams.dtaThreshold);
+
+    const EvalGrid evalGrid(evalImg3D);
+
+    // iterate over each frame and row of reference image, tile by tile
+    for(size_t t = startTile; t < endTile; t++){
+        const Tile& tile = tiles[t];
+        float zr = refImg3D.getOffset().frames + tile.kBegin * refImg3D.getSpacing().frames;
+        for(uint32_t kr = tile.kBegin; kr < tile.kEnd; kr++){
+            float yr = refImg3D.getOffset().rows + tile.jBegin * refImg3D.getSpacing().rows;
+
+            for(uint32_t jr = tile.jBegin; jr < tile.jEnd; jr++){
+                size_t indRef = (static_cast<size_t>(kr) * refImg3D.getSize().rows + jr) * refImg3D.getSize().columns + tile.iBegin;
+                float xr = refImg3D.getOffset().columns + tile.iBegin * refImg3D.getSpacing().columns;
+
+                for(uint32_t ir = tile.iBegin; ir < tile.iEnd; ir += SimdElementCount){
+                    const uint32_t nrOfLanes = std::min(static_cast<uint32_t>(SimdElementCount), tile.iEnd - ir);
+                    const RefLanes lanes = loadRefLanes(refImg3D, indRef, nrOfLanes, xr, gammaParams, normalization);
+
+                    if(lanes.anyValid){
+                        // search areas of lanes between xrMin and xrMax are inside too
+                        const bool inside = isSearchAreaInside(evalGrid, searchExtent, zr, yr, lanes.xrMin) &&
+                                            isSearchAreaInside(evalGrid, searchExtent, zr, yr, lanes.xrMax);
+                        const FloatBatch minGammaValSqVec = inside ?
+                            minGammaValSqWendling3DSimd<false>(evalImg3D, evalGrid, sortedPoints, dtaInvSq, zr, yr, lanes) :
+                            minGammaValSqWendling3DSimd<true>(evalImg3D, evalGrid, sortedPoints, dtaInvSq, zr, yr, lanes);
+                        storeGammaVals(lanes, minGammaValSqVec, indRef, nrOfLanes, gammaVals);
+                    }
+                    else{
+                        std::fill_n(gammaVals.begin() + indRef, nrOfLanes, NaN);
+                    }
+                    indRef += nrOfLanes;
+                }
+                yr += refImg3D.getSpacing().rows;
+            }
+            zr += refImg3D.getSpacing().frames;
+        }
+    }
+}
+
+// kernels processing SimdElementCount reference voxels at a time (see WendlingKernels).
+// Only linear interpolation is vectorized, the other interpolations use the scalar kernels.
+// Vectorized kernels gather float values, so evaluated image must be float (EvalImage is the default one)
+struct WendlingSimdKernels{
+    static constexpr bool ReadsCompactValues = false;
+
+    template <typename Normalization, typename Interpolation, typename EvalImage = PaddedImage<>>
+    static constexpr auto gammaIndex2D = std::is_same_v<Interpolation, LinearInterpolation> ?
+        gammaIndex2DWendlingSimdInternal<Normalization> : gammaIndex2DWendlingInternal<Normalization, Interpolation>;
+    template <typename Normalization, typename Interpolation>
+    static constexpr auto gammaIndex2_5D = std::is_same_v<Interpolation, LinearInterpolation> ?
+        gammaIndex2_5DWendlingSimdInternal<Normalization> : gammaIndex2_5DWendlingInternal<Normalization, Interpolation>;
+    template <typename Normalization, typename Interpolation, typename EvalImage = BrickedImage<>>
+    static constexpr auto gammaIndex3D = std::is_same_v<Interpolation, LinearInterpolation> ?
+        gammaIndex3DWendlingSimdInternal<Normalization> : gammaIndex3DWendlingInternal<Normalization, Interpolation>;
+};
+}
+
+}
@@ -0,0 +1,106 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/Interpolation.hpp"
+
+#include "GammaCommon.hpp"
+#include "PaddedImage.hpp"
+
+namespace yagit{
+
+namespace{
+// Frames of evaluated image linearly interpolated along Z at positions of reference image frames.
+// Frame is interpolated when it's needed for the first time (acquire) and released
+// when all tiles of reference image in this frame have been processed (release),
+// so only frames that are in use are kept in memory. Each frame has its own lock,
+// so threads that need different frames don't wait for each other
+// (frames are mutable, because kernels get their arguments by const reference).
+class LazyEvalFrames{
+public:
+    LazyEvalFrames(const ImageView& refImg3D, const ImageView& evalImg3D, const std::vector<Tile>& tiles)
+        : m_refImg(refImg3D), m_evalImg(evalImg3D), m_frames(refImg3D.getSize().frames){
+        countTiles(tiles);
+    }
+
+    // only frames of compact image needed by the interpolation are widened to float
+    LazyEvalFrames(const ImageView& refImg3D, const CompactImageData& evalImg3D, const std::vector<Tile>& tiles)
+        : m_refImg(refImg3D), m_compactEvalImg(&evalImg3D), m_frames(refImg3D.getSize().frames){
+        countTiles(tiles);
+    }
+
+    // evaluated frame at position of reference frame k (nullptr if it's outside evaluated image).
+    // It's valid until release is called for each tile of frame k
+    const PaddedImage<>* acquire(uint32_t k) const{
+        Frame& frame = m_frames[k];
+        std::lock_guard<std::mutex> lock(frame.mutex);
+        if(!frame.created){
+            const float spacing = m_refImg.getSpacing().frames;
+            const float z = m_refImg.getOffset().frames + k * spacing;
+            const auto evalFrame = (m_compactEvalImg != nullptr ?
+                                    Interpolation::linearFrameAtZ(*m_compactEvalImg, z, spacing) :
+                                    Interpolation::linearFrameAtZ(m_evalImg, z, spacing));
+            if(evalFrame.has_value()){
+                frame.image = std::make_unique<PaddedImage<>>(*evalFrame, 1);
+            }
+            frame.created = true;
+        }
+        return frame.image.get();
+    }
+
+    void release(uint32_t k) const{
+        Frame& frame = m_frames[k];
+        std::lock_guard<std::mutex> lock(frame.mutex);
+        frame.remainingTiles--;
+        if(frame.remainingTiles == 0){
+            frame.image.reset();
+        }
+    }
+
+private:
+    void countTiles(const std::vector<Tile>& tiles){
+        for(const Tile& tile : tiles){
+            for(uint32_t k = tile.kBegin; k < tile.kEnd; k++){
+                m_frames[k].remainingTiles++;
+            }
+        }
+    }
+
+    struct Frame{
+        std::mutex mutex;
+        std::unique_ptr<PaddedImage<>> image;
+        bool created{false};
+        uint32_t remainingTiles{0};
+    };
+
+    const ImageView m_refImg;
+    const ImageView m_evalImg;
+    const CompactImageData* m_compactEvalImg{nullptr};  // used instead of m_evalImg if it isn't nullptr
+    mutable std::vector<Frame> m_frames;
+};
+}
+
+}
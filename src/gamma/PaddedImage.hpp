@@ -0,0 +1,169 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#include "yagit/ImageView.hpp"
+#include "yagit/CompactImageData.hpp"
+#include "yagit/DataStructs.hpp"
+
+#include "VoxelValues.hpp"
+
+namespace yagit{
+
+namespace{
+// Image with halo - additional rows and columns at the end of each frame.
+// Halo voxels replicate the closest voxel of image, so interpolation at the last row/column
+// can read the next voxel without clamping its index (it has zero weight there).
+// Rows can also be padded, so that their length is a multiple of columnsMultiple (e.g. number of SIMD lanes).
+// Frames are not padded, because images are interpolated only within a frame.
+// If image already has such layout (no halo, rows are a multiple of columnsMultiple and data is aligned
+// to Alignment bytes, e.g. ImageData with suitable number of columns), it is used without copying.
+// Values is a policy of stored values (see VoxelValues.hpp), Allocator allocates its storage_type.
+template <typename Allocator = std::allocator<float>, size_t Alignment = alignof(float), typename Values = FloatValues>
+class PaddedImage{
+public:
+    using value_type = typename Values::storage_type;
+    static_assert(std::is_same_v<typename Allocator::value_type, value_type>);
+
+    PaddedImage(const ImageView& image, uint32_t halo, uint32_t columnsMultiple = 1)
+        : m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()),
+          m_paddedRows(m_size.rows + halo),
+          m_paddedColumns((m_size.columns + halo + columnsMultiple - 1) / columnsMultiple * columnsMultiple),
+          m_rows(image.data()){
+        static_assert(std::is_same_v<value_type, float>, "ImageView can be stored only as float");
+        if(image.size() == 0){
+            return;
+        }
+        if(halo == 0 && m_paddedColumns == m_size.columns && image.isContiguous() &&
+           reinterpret_cast<std::uintptr_t>(image.data()) % Alignment == 0){
+            return;
+        }
+        m_data.reserve(static_cast<size_t>(m_size.frames) * m_paddedRows * m_paddedColumns);
+
+        for(uint32_t k = 0; k < m_size.frames; k++){
+            appendFrame([&](uint32_t j, uint32_t i){ return image.get(k, j, i); });
+        }
+        m_rows = m_data.data();
+    }
+
+    // with FloatValues image is widened to float frame by frame while it is copied,
+    // with compact values policy (that must match format of image) its raw 16-bit values are copied
+    PaddedImage(const CompactImageData& image, uint32_t halo, uint32_t columnsMultiple = 1)
+        : m_size(image.getSize()), m_offset(image.getOffset()), m_spacing(image.getSpacing()),
+          m_paddedRows(m_size.rows + halo),
+          m_paddedColumns((m_size.columns + halo + columnsMultiple - 1) / columnsMultiple * columnsMultiple),
+          m_rows(nullptr){
+        if(image.size() == 0){
+            return;
+        }
+        m_data.reserve(static_cast<size_t>(m_size.frames) * m_paddedRows * m_paddedColumns);
+
+        if constexpr(std::is_same_v<value_type, float>){
+            for(uint32_t k = 0; k < m_size.frames; k++){
+                const ImageData::container_type frame = image.readFrames(k, 1);
+                appendFrame([&](uint32_t j, uint32_t i){ return frame[static_cast<size_t>(j) * m_size.columns + i]; });
+            }
+        }
+        else{
+            m_values = Values(image);
+            for(uint32_t k = 0; k < m_size.frames; k++){
+                const value_type* frame = image.data() + static_cast<size_t>(k) * m_size.rows * m_size.columns;
+                appendFrame([&](uint32_t j, uint32_t i){ return frame[static_cast<size_t>(j) * m_size.columns + i]; });
+            }
+        }
+        m_rows = m_data.data();
+    }
+
+    // rows point either to m_data or to data of image, so it can't be copied nor moved
+    PaddedImage(const PaddedImage&) = delete;
+    PaddedImage& operator=(const PaddedImage&) = delete;
+
+    float get(uint32_t frame, uint32_t row, uint32_t column) const{
+        return m_values(m_rows[(static_cast<size_t>(frame) * m_paddedRows + row) * m_paddedColumns + column]);
+    }
+
+    // address of voxel (e.g. to prefetch it)
+    const value_type* getAddress(uint32_t frame, uint32_t row, uint32_t column) const{
+        return getRow(frame, row) + column;
+    }
+
+    // pointer to the beginning of row (it has getPaddedColumns() stored values, see widen)
+    const value_type* getRow(uint32_t frame, uint32_t row) const{
+        return m_rows + (static_cast<size_t>(frame) * m_paddedRows + row) * m_paddedColumns;
+    }
+
+    // stored value widened to float
+    float widen(value_type value) const{
+        return m_values(value);
+    }
+
+    const Values& getValues() const{
+        return m_values;
+    }
+
+    uint32_t getPaddedColumns() const{
+        return m_paddedColumns;
+    }
+
+    DataSize getSize() const{
+        return m_size;
+    }
+    DataOffset getOffset() const{
+        return m_offset;
+    }
+    DataSpacing getSpacing() const{
+        return m_spacing;
+    }
+
+private:
+    // appends frame with halo and padding of rows, getValue(row, column) returns voxel of frame
+    template <typename GetValue>
+    void appendFrame(GetValue&& getValue){
+        for(uint32_t j = 0; j < m_paddedRows; j++){
+            const uint32_t jImg = std::min(j, m_size.rows - 1);
+            for(uint32_t i = 0; i < m_paddedColumns; i++){
+                const uint32_t iImg = std::min(i, m_size.columns - 1);
+                m_data.push_back(getValue(jImg, iImg));
+            }
+        }
+    }
+
+    DataSize m_size;
+    DataOffset m_offset;
+    DataSpacing m_spacing;
+    uint32_t m_paddedRows;
+    uint32_t m_paddedColumns;
+    std::vector<value_type, Allocator> m_data;
+    const value_type* m_rows;
+    Values m_values;
+};
+
+// padded image keeping raw 16-bit values of CompactImageData (Values must match its format)
+template <typename Values>
+using CompactPaddedImage = PaddedImage<std::allocator<uint16_t>, alignof(uint16_t), Values>;
+}
+
+}
@@ -0,0 +1,96 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+#include "yagit/CompactImageData.hpp"
+
+#include "GammaCommon.hpp"
+#include "../HalfFloat.hpp"
+
+namespace yagit{
+
+// Policies of voxel values stored in PaddedImage and BrickedImage: type of stored element (storage_type)
+// and its widening to float (operator()).
+// Compact policies keep raw 16-bit values of CompactImageData, which are widened to float
+// only in registers when kernels read them, so kernels read half as many bytes of evaluated image.
+// Widened values are the same as values returned by CompactImageData::get.
+namespace{
+struct FloatValues{
+    using storage_type = float;
+
+    float operator()(float value) const{
+        return value;
+    }
+};
+
+struct Float16Values{
+    using storage_type = uint16_t;
+
+    Float16Values() = default;
+    explicit Float16Values(const CompactImageData&){}
+
+    float operator()(uint16_t value) const{
+        return halfToFloat(value);
+    }
+};
+
+struct BFloat16Values{
+    using storage_type = uint16_t;
+
+    BFloat16Values() = default;
+    explicit BFloat16Values(const CompactImageData&){}
+
+    float operator()(uint16_t value) const{
+        return bfloat16ToFloat(value);
+    }
+};
+
+struct UInt16Values{
+    using storage_type = uint16_t;
+
+    UInt16Values() = default;
+    explicit UInt16Values(const CompactImageData& image)
+        : scaling(image.getScaling()) {}
+
+    float operator()(uint16_t value) const{
+        return static_cast<float>(static_cast<double>(value) * scaling);
+    }
+
+    double scaling{1};
+};
+
+// call func with TypeTag of values policy that matches the format of compact image,
+// so that func can instantiate a kernel reading its raw values
+template <typename Function>
+decltype(auto) dispatchCompactValues(CompactFormat format, Function&& func){
+    if(format == CompactFormat::Float16){
+        return func(TypeTag<Float16Values>{});
+    }
+    else if(format == CompactFormat::BFloat16){
+        return func(TypeTag<BFloat16Values>{});
+    }
+    else{
+        return func(TypeTag<UInt16Values>{});
+    }
+}
+}
+
+}
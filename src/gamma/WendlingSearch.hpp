@@ -0,0 +1,458 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+#include "GammaCommon.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Number of sorted points ahead, whose voxels of evaluated image are prefetched
+// during the search (0 disables prefetching)
+#ifndef WENDLING_PREFETCH_DISTANCE
+#define WENDLING_PREFETCH_DISTANCE 0
+#endif
+
+// Number of the first sorted points of the next reference voxel, whose voxels of evaluated image
+// are prefetched before the search for the current voxel (0 disables prefetching)
+#ifndef WENDLING_PREFETCH_NEXT_VOXEL_POINTS
+#define WENDLING_PREFETCH_NEXT_VOXEL_POINTS 0
+#endif
+
+namespace yagit{
+
+namespace{
+// parameters of evaluated image needed to find voxels surrounding a point
+struct EvalGrid{
+    float zOffset;
+    float yOffset;
+    float xOffset;
+    float zSpInv;
+    float ySpInv;
+    float xSpInv;
+    // coordinates of the first and the last voxel with tolerance - points outside them are skipped
+    float zMin;
+    float yMin;
+    float xMin;
+    float zMax;
+    float yMax;
+    float xMax;
+
+    template <typename Image>
+    explicit EvalGrid(const Image& evalImg)
+        : zOffset(evalImg.getOffset().frames),
+          yOffset(evalImg.getOffset().rows),
+          xOffset(evalImg.getOffset().columns),
+          zSpInv(1 / evalImg.getSpacing().frames),
+          ySpInv(1 / evalImg.getSpacing().rows),
+          xSpInv(1 / evalImg.getSpacing().columns),
+          zMin(zOffset - Tolerance),
+          yMin(yOffset - Tolerance),
+          xMin(xOffset - Tolerance),
+          zMax(zOffset + (evalImg.getSize().frames - 1) * evalImg.getSpacing().frames + Tolerance),
+          yMax(yOffset + (evalImg.getSize().rows - 1) * evalImg.getSpacing().rows + Tolerance),
+          xMax(xOffset + (evalImg.getSize().columns - 1) * evalImg.getSpacing().columns + Tolerance) {}
+};
+
+// the farthest search point from the reference point along each axis
+// (sorted points are symmetric, so it is the same in both directions)
+struct SearchExtent{
+    float z;
+    float y;
+    float x;
+};
+
+SearchExtent calcSearchExtent(const std::vector<Point2D>& sortedPoints){
+    SearchExtent extent{0, 0, 0};
+    for(const auto& point : sortedPoints){
+        extent.y = std::max(extent.y, point.y);
+        extent.x = std::max(extent.x, point.x);
+    }
+    return extent;
+}
+
+SearchExtent calcSearchExtent(const std::vector<Point3D>& sortedPoints){
+    SearchExtent extent{0, 0, 0};
+    for(const auto& point : sortedPoints){
+        extent.z = std::max(extent.z, point.z);
+        extent.y = std::max(extent.y, point.y);
+        extent.x = std::max(extent.x, point.x);
+    }
+    return extent;
+}
+
+// check if all search points around the reference point pass the bounds test of evaluated image.
+// coordinates of points are calculated in the same way in the search,
+// so the result is exact and voxels that pass the check can skip bounds tests for each point
+bool isSearchAreaInside(const EvalGrid& grid, const SearchExtent& extent, float yr, float xr){
+    return yr - extent.y >= grid.yMin && yr + extent.y <= grid.yMax &&
+           xr - extent.x >= grid.xMin && xr + extent.x <= grid.xMax;
+}
+
+bool isSearchAreaInside(const EvalGrid& grid, const SearchExtent& extent, float zr, float yr, float xr){
+    return zr - extent.z >= grid.zMin && zr + extent.z <= grid.zMax &&
+           isSearchAreaInside(grid, extent, yr, xr);
+}
+}
+
+namespace{
+constexpr uint32_t WendlingPrefetchDistance = WENDLING_PREFETCH_DISTANCE;
+constexpr uint32_t WendlingPrefetchNextVoxelPoints = WENDLING_PREFETCH_NEXT_VOXEL_POINTS;
+
+// hint the processor to load cache line with the address (it's a no-op if compiler doesn't support it)
+inline void prefetch(const void* address){
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+// prefetch voxels of evaluated image used to interpolate dose at (ye, xe) in the given frame.
+// Point must be inside evaluated image
+template <typename EvalImage>
+void prefetchPoint2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid, float ye, float xe){
+    const uint32_t indy0 = static_cast<uint32_t>((ye - grid.yOffset) * grid.ySpInv);
+    const uint32_t indx0 = static_cast<uint32_t>((xe - grid.xOffset) * grid.xSpInv);
+    // 2 adjacent columns are mostly in the same cache line
+    prefetch(evalImg.getAddress(frame, indy0, indx0));
+    prefetch(evalImg.getAddress(frame, indy0 + 1, indx0));
+}
+
+// prefetch voxels of evaluated image used to interpolate dose at (ze, ye, xe).
+// Point must be inside evaluated image
+template <typename EvalImage>
+void prefetchPoint3D(const EvalImage& evalImg, const EvalGrid& grid, float ze, float ye, float xe){
+    const uint32_t indz0 = static_cast<uint32_t>((ze - grid.zOffset) * grid.zSpInv);
+    const uint32_t indy0 = static_cast<uint32_t>((ye - grid.yOffset) * grid.ySpInv);
+    const uint32_t indx0 = static_cast<uint32_t>((xe - grid.xOffset) * grid.xSpInv);
+    // in bricked image the 8 corners are mostly in the same brick, so the opposite corners are enough
+    prefetch(evalImg.getAddress(indz0, indy0, indx0));
+    prefetch(evalImg.getAddress(indz0 + 1, indy0 + 1, indx0 + 1));
+}
+
+// prefetch voxels of the first sorted points around reference point (yr, xr),
+// whose search area must be inside evaluated image
+template <typename EvalImage>
+void prefetchFirstPoints2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid,
+                           const std::vector<Point2D>& sortedPoints, float yr, float xr){
+    const size_t nrOfPoints = std::min<size_t>(WendlingPrefetchNextVoxelPoints, sortedPoints.size());
+    for(size_t p = 0; p < nrOfPoints; p++){
+        prefetchPoint2D(evalImg, frame, grid, yr + sortedPoints[p].y, xr + sortedPoints[p].x);
+    }
+}
+
+template <typename EvalImage>
+void prefetchFirstPoints3D(const EvalImage& evalImg, const EvalGrid& grid,
+                           const std::vector<Point3D>& sortedPoints, float zr, float yr, float xr){
+    const size_t nrOfPoints = std::min<size_t>(WendlingPrefetchNextVoxelPoints, sortedPoints.size());
+    for(size_t p = 0; p < nrOfPoints; p++){
+        prefetchPoint3D(evalImg, grid, zr + sortedPoints[p].z, yr + sortedPoints[p].y, xr + sortedPoints[p].x);
+    }
+}
+}
+
+namespace{
+// Interpolation policies of evaluated dose at search points (see GammaInterpolation).
+// Points must pass the bounds test of EvalGrid, and evaluated image must have a halo of at least 1 voxel.
+
+struct NearestInterpolation{
+    template <typename EvalImage>
+    static float at2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid, float ye, float xe){
+        const uint32_t indy = static_cast<uint32_t>((ye - grid.yOffset) * grid.ySpInv + 0.5f);
+        const uint32_t indx = static_cast<uint32_t>((xe - grid.xOffset) * grid.xSpInv + 0.5f);
+        return evalImg.get(frame, indy, indx);
+    }
+
+    template <typename EvalImage>
+    static float at3D(const EvalImage& evalImg, const EvalGrid& grid, float ze, float ye, float xe){
+        const uint32_t indz = static_cast<uint32_t>((ze - grid.zOffset) * grid.zSpInv + 0.5f);
+        const uint32_t indy = static_cast<uint32_t>((ye - grid.yOffset) * grid.ySpInv + 0.5f);
+        const uint32_t indx = static_cast<uint32_t>((xe - grid.xOffset) * grid.xSpInv + 0.5f);
+        return evalImg.get(indz, indy, indx);
+    }
+};
+
+// instead of calling Interpolate::bilinearAtPoint and Interpolate::trilinearAtPoint functions,
+// here are inlined, optimized versions. They give 5-10% speedup
+struct LinearInterpolation{
+    template <typename EvalImage>
+    static float at2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid, float ye, float xe){
+        float tempy = (ye - grid.yOffset) * grid.ySpInv;
+        float tempx = (xe - grid.xOffset) * grid.xSpInv;
+
+        const uint32_t indy0 = static_cast<uint32_t>(tempy);
+        const uint32_t indx0 = static_cast<uint32_t>(tempx);
+        const uint32_t indy1 = indy0 + 1;
+        const uint32_t indx1 = indx0 + 1;
+
+        float yd = tempy - static_cast<float>(indy0);
+        float xd = tempx - static_cast<float>(indx0);
+
+        float c00 = evalImg.get(frame, indy0, indx0);
+        float c01 = evalImg.get(frame, indy1, indx0);
+        float c10 = evalImg.get(frame, indy0, indx1);
+        float c11 = evalImg.get(frame, indy1, indx1);
+
+        float c0 = c00*(1 - xd) + c10*xd;
+        float c1 = c01*(1 - xd) + c11*xd;
+
+        return c0*(1 - yd) + c1*yd;
+    }
+
+    template <typename EvalImage>
+    static float at3D(const EvalImage& evalImg, const EvalGrid& grid, float ze, float ye, float xe){
+        float tempz = (ze - grid.zOffset) * grid.zSpInv;
+        float tempy = (ye - grid.yOffset) * grid.ySpInv;
+        float tempx = (xe - grid.xOffset) * grid.xSpInv;
+
+        const uint32_t indz0 = static_cast<uint32_t>(tempz);
+        const uint32_t indy0 = static_cast<uint32_t>(tempy);
+        const uint32_t indx0 = static_cast<uint32_t>(tempx);
+        const uint32_t indz1 = indz0 + 1;
+        const uint32_t indy1 = indy0 + 1;
+        const uint32_t indx1 = indx0 + 1;
+
+        float zd = tempz - static_cast<float>(indz0);
+        float yd = tempy - static_cast<float>(indy0);
+        float xd = tempx - static_cast<float>(indx0);
+
+        float c000 = evalImg.get(indz0, indy0, indx0);
+        float c001 = evalImg.get(indz1, indy0, indx0);
+        float c010 = evalImg.get(indz0, indy1, indx0);
+        float c011 = evalImg.get(indz1, indy1, indx0);
+        float c100 = evalImg.get(indz0, indy0, indx1);
+        float c101 = evalImg.get(indz1, indy0, indx1);
+        float c110 = evalImg.get(indz0, indy1, indx1);
+        float c111 = evalImg.get(indz1, indy1, indx1);
+
+        float c00 = c000*(1 - xd) + c100*xd;
+        float c01 = c001*(1 - xd) + c101*xd;
+        float c10 = c010*(1 - xd) + c110*xd;
+        float c11 = c011*(1 - xd) + c111*xd;
+
+        float c0 = c00*(1 - yd) + c10*yd;
+        float c1 = c01*(1 - yd) + c11*yd;
+
+        return c0*(1 - zd) + c1*zd;
+    }
+};
+
+// Catmull-Rom spline - it passes through voxel values and reproduces quadratic doses exactly.
+// Interpolation is separable, so 4 weights and 4 offsets are calculated once per axis
+// (at2D needs PaddedImage and at3D needs BrickedImage, their stored values are widened with widen).
+// It reads 1 voxel before and 2 voxels after the point, so indices are clamped to the image
+// (it is equivalent to replicating the border voxels)
+struct CubicInterpolation{
+    template <typename EvalImage>
+    static float at2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid, float ye, float xe){
+        const Axis y((ye - grid.yOffset) * grid.ySpInv, evalImg.getSize().rows);
+        const Axis x((xe - grid.xOffset) * grid.xSpInv, evalImg.getSize().columns);
+
+        float result = 0;
+        for(int j = 0; j < 4; j++){
+            const auto* evalRow = evalImg.getRow(frame, y.indices[j]);
+            float row = 0;
+            for(int i = 0; i < 4; i++){
+                row += x.weights[i] * evalImg.widen(evalRow[x.indices[i]]);
+            }
+            result += y.weights[j] * row;
+        }
+        return result;
+    }
+
+    template <typename EvalImage>
+    static float at3D(const EvalImage& evalImg, const EvalGrid& grid, float ze, float ye, float xe){
+        const Axis z((ze - grid.zOffset) * grid.zSpInv, evalImg.getSize().frames);
+        const Axis y((ye - grid.yOffset) * grid.ySpInv, evalImg.getSize().rows);
+        const Axis x((xe - grid.xOffset) * grid.xSpInv, evalImg.getSize().columns);
+
+        // offsets of voxels along each axis in bricked image
+        std::array<size_t, 4> frameOffsets, rowOffsets, columnOffsets;
+        for(int v = 0; v < 4; v++){
+            frameOffsets[v] = evalImg.frameOffset(z.indices[v]);
+            rowOffsets[v] = evalImg.rowOffset(y.indices[v]);
+            columnOffsets[v] = EvalImage::columnOffset(static_cast<size_t>(x.indices[v]));
+        }
+
+        const auto* data = evalImg.data();
+        float result = 0;
+        for(int k = 0; k < 4; k++){
+            float frame = 0;
+            for(int j = 0; j < 4; j++){
+                const auto* evalRow = data + frameOffsets[k] + rowOffsets[j];
+                float row = 0;
+                for(int i = 0; i < 4; i++){
+                    row += x.weights[i] * evalImg.widen(evalRow[columnOffsets[i]]);
+                }
+                frame += y.weights[j] * row;
+            }
+            result += z.weights[k] * frame;
+        }
+        return result;
+    }
+
+private:
+    // weights and clamped indices of 4 voxels around position (in voxels) along one axis
+    struct Axis{
+        std::array<float, 4> weights;
+        std::array<uint32_t, 4> indices;
+
+        Axis(float position, uint32_t size){
+            const uint32_t ind0 = std::min(static_cast<uint32_t>(position), size - 1);
+            const float t = position - static_cast<float>(ind0);
+            const float t2 = t * t;
+            const float t3 = t2 * t;
+            weights = {0.5f * (-t3 + 2 * t2 - t),
+                       0.5f * (3 * t3 - 5 * t2 + 2),
+                       0.5f * (-3 * t3 + 4 * t2 + t),
+                       0.5f * (t3 - t2)};
+            indices = {ind0 > 0 ? ind0 - 1 : 0,
+                       ind0,
+                       std::min(ind0 + 1, size - 1),
+                       std::min(ind0 + 2, size - 1)};
+        }
+    };
+};
+
+// call func with TypeTag of interpolation policy that matches the type of interpolation,
+// so that func can instantiate a kernel specialized for it
+template <typename Function>
+decltype(auto) dispatchInterpolation(GammaInterpolation interpolation, Function&& func){
+    if(interpolation == GammaInterpolation::Nearest){
+        return func(TypeTag<NearestInterpolation>{});
+    }
+    else if(interpolation == GammaInterpolation::Cubic){
+        return func(TypeTag<CubicInterpolation>{});
+    }
+    else{
+        return func(TypeTag<LinearInterpolation>{});
+    }
+}
+}
+
+namespace{
+// find minimal squared gamma among points around (yr, xr) in the given frame of evaluated image,
+// where evaluated dose is interpolated with Interpolation policy.
+// evalImg must have a halo, because indices of next voxels are not clamped.
+// With CheckBounds=false points outside evaluated image are not skipped, so it can be used only when
+// isSearchAreaInside returns true
+template <typename Interpolation, bool CheckBounds, typename EvalImage>
+float minGammaValSqWendling2D(const EvalImage& evalImg, uint32_t frame, const EvalGrid& grid,
+                              const std::vector<Point2D>& sortedPoints, float dtaInvSq,
+                              float yr, float xr, float doseRef, float ddNormInvSq){
+    float minGammaValSq = Inf;
+
+    const size_t nrOfPoints = sortedPoints.size();
+    for(size_t p = 0; p < nrOfPoints; p++){
+        const Point2D& point = sortedPoints[p];
+        const float normalizedDistSq = point.distSq * dtaInvSq;
+        if(normalizedDistSq >= minGammaValSq){
+            break;
+        }
+
+        // indices of points ahead are known, so their voxels can be loaded while this point is interpolated
+        // (only inside evaluated image, because addresses of points outside it are invalid)
+        if constexpr(!CheckBounds && WendlingPrefetchDistance > 0){
+            if(p + WendlingPrefetchDistance < nrOfPoints){
+                const Point2D& nextPoint = sortedPoints[p + WendlingPrefetchDistance];
+                prefetchPoint2D(evalImg, frame, grid, yr + nextPoint.y, xr + nextPoint.x);
+            }
+        }
+
+        float ye = yr + point.y;
+        float xe = xr + point.x;
+
+        if constexpr(CheckBounds){
+            if(ye < grid.yMin || ye > grid.yMax ||
+               xe < grid.xMin || xe > grid.xMax){
+                continue;
+            }
+        }
+
+        float doseEval = Interpolation::at2D(evalImg, frame, grid, ye, xe);
+
+        // calculate squared gamma
+        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq + normalizedDistSq;
+        if(gammaValSq < minGammaValSq){
+            minGammaValSq = gammaValSq;
+        }
+    }
+
+    return minGammaValSq;
+}
+
+// find minimal squared gamma among points around (zr, yr, xr) in evaluated image.
+// Requirements are the same as for minGammaValSqWendling2D
+template <typename Interpolation, bool CheckBounds, typename EvalImage>
+float minGammaValSqWendling3D(const EvalImage& evalImg, const EvalGrid& grid,
+                              const std::vector<Point3D>& sortedPoints, float dtaInvSq,
+                              float zr, float yr, float xr, float doseRef, float ddNormInvSq){
+    float minGammaValSq = Inf;
+
+    const size_t nrOfPoints = sortedPoints.size();
+    for(size_t p = 0; p < nrOfPoints; p++){
+        const Point3D& point = sortedPoints[p];
+        const float normalizedDistSq = point.distSq * dtaInvSq;
+        if(normalizedDistSq >= minGammaValSq){
+            break;
+        }
+
+        // see minGammaValSqWendling2D
+        if constexpr(!CheckBounds && WendlingPrefetchDistance > 0){
+            if(p + WendlingPrefetchDistance < nrOfPoints){
+                const Point3D& nextPoint = sortedPoints[p + WendlingPrefetchDistance];
+                prefetchPoint3D(evalImg, grid, zr + nextPoint.z, yr + nextPoint.y, xr + nextPoint.x);
+            }
+        }
+
+        float ze = zr + point.z;
+        float ye = yr + point.y;
+        float xe = xr + point.x;
+
+        if constexpr(CheckBounds){
+            if(ze < grid.zMin || ze > grid.zMax ||
+               ye < grid.yMin || ye > grid.yMax ||
+               xe < grid.xMin || xe > grid.xMax){
+                continue;
+            }
+        }
+
+        float doseEval = Interpolation::at3D(evalImg, grid, ze, ye, xe);
+
+        // calculate squared gamma
+        float gammaValSq = distSq1D(doseEval, doseRef) * ddNormInvSq + normalizedDistSq;
+        if(gammaValSq < minGammaValSq){
+            minGammaValSq = gammaValSq;
+        }
+    }
+
+    return minGammaValSq;
+}
+}
+
+}
@@ -122,38 +122,38 @@ int main(int argc, char** argv){
 
         std::cout << "\n====================================\n";
         std::cout << "LINEAR INTERPOLATION WITH SPACING:\n";
-        yagit::ImageData (&linearAlongAxisPtr)(const yagit::ImageData&, float, yagit::ImageAxis) = yagit::Interpolation::linearAlongAxis;
+        yagit::ImageData (&linearAlongAxisPtr)(const yagit::ImageView&, float, yagit::ImageAxis) = yagit::Interpolation::linearAlongAxis;
         measureInterp(10, linearAlongAxisPtr, img3D, newSpacing, yagit::ImageAxis::Z);
 
         std::cout << "\n====================================\n";
         std::cout << "LINEAR INTERPOLATION WITH OFFSET AND SPACING:\n";
-        yagit::ImageData (&linearAlongAxis2Ptr)(const yagit::ImageData&, float, float, yagit::ImageAxis) = yagit::Interpolation::linearAlongAxis;
+        yagit::ImageData (&linearAlongAxis2Ptr)(const yagit::ImageView&, float, float, yagit::ImageAxis) = yagit::Interpolation::linearAlongAxis;
         measureInterp(10, linearAlongAxis2Ptr, img3D, gridOffsetZ, newSpacing, yagit::ImageAxis::Z);
 
         std::cout << "\n====================================\n";
         std::cout << "BILINEAR INTERPOLATION WITH SPACING:\n";
-        yagit::ImageData (&bilinearOnPlanePtr)(const yagit::ImageData&, float, float, yagit::ImagePlane) = yagit::Interpolation::bilinearOnPlane;
+        yagit::ImageData (&bilinearOnPlanePtr)(const yagit::ImageView&, float, float, yagit::ImagePlane) = yagit::Interpolation::bilinearOnPlane;
         measureInterp(10, bilinearOnPlanePtr, img3D, newSpacing, newSpacing, yagit::ImagePlane::Axial);
 
         std::cout << "\n====================================\n";
         std::cout << "BILINEAR INTERPOLATION WITH OFFSET AND SPACING:\n";
-        yagit::ImageData (&bilinearOnPlane2Ptr)(const yagit::ImageData&, float, float, float, float, yagit::ImagePlane) = yagit::Interpolation::bilinearOnPlane;
+        yagit::ImageData (&bilinearOnPlane2Ptr)(const yagit::ImageView&, float, float, float, float, yagit::ImagePlane) = yagit::Interpolation::bilinearOnPlane;
         measureInterp(10, bilinearOnPlane2Ptr, img3D, gridOffsetY, gridOffsetX, newSpacing, newSpacing, yagit::ImagePlane::Axial);
 
         std::cout << "\n====================================\n";
         std::cout << "TRILINEAR INTERPOLATION WITH SPACING:\n";
-        yagit::ImageData (&trilinearPtr)(const yagit::ImageData&, const yagit::DataSpacing&) = yagit::Interpolation::trilinear;
+        yagit::ImageData (&trilinearPtr)(const yagit::ImageView&, const yagit::DataSpacing&) = yagit::Interpolation::trilinear;
         measureInterp(10, trilinearPtr, img3D, yagit::DataSpacing{newSpacing, newSpacing, newSpacing});
 
         std::cout << "\n====================================\n";
         std::cout << "TRILINEAR INTERPOLATION WITH OFFSET AND SPACING:\n";
-        yagit::ImageData (&trilinear2Ptr)(const yagit::ImageData&, const yagit::DataOffset&, const yagit::DataSpacing&) = yagit::Interpolation::trilinear;
+        yagit::ImageData (&trilinear2Ptr)(const yagit::ImageView&, const yagit::DataOffset&, const yagit::DataSpacing&) = yagit::Interpolation::trilinear;
         measureInterp(10, trilinear2Ptr, img3D, yagit::DataOffset{gridOffsetZ, gridOffsetY, gridOffsetX}, yagit::DataSpacing{newSpacing, newSpacing, newSpacing});
 
 
         std::cout << "\n####################################\n";
         std::cout << "BILINEAR INTERPOLATION AT POINT (x10000):\n";
-        std::optional<float> (&bilinearAtPointPtr)(const yagit::ImageData&, uint32_t, float, float) = yagit::Interpolation::bilinearAtPoint;
+        std::optional<float> (&bilinearAtPointPtr)(const yagit::ImageView&, uint32_t, float, float) = yagit::Interpolation::bilinearAtPoint;
         measureInterpAtPoint(1000, bilinearAtPointPtr, img3D, img3D.getSize().frames / 2, -300.5, 140.4);
 
         std::cout << "\n====================================\n";
@@ -162,7 +162,7 @@ int main(int argc, char** argv){
 
         std::cout << "\n====================================\n";
         std::cout << "TRILINEAR INTERPOLATION AT POINT (x10000):\n";
-        std::optional<float> (&trilinearAtPointPtr)(const yagit::ImageData&, float, float, float) = yagit::Interpolation::trilinearAtPoint;
+        std::optional<float> (&trilinearAtPointPtr)(const yagit::ImageView&, float, float, float) = yagit::Interpolation::trilinearAtPoint;
         measureInterpAtPoint(1000, trilinearAtPointPtr, img3D, 0.1, -300.5, 140.4);
 
         std::cout << "\n====================================\n";
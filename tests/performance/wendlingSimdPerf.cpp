@@ -0,0 +1,182 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+// This program compares scalar Wendling kernels with kernels vectorized across reference voxels
+// (GammaWendlingSimd.hpp) on synthetic images. It shows for which data the vectorized version is faster.
+// Both versions must give the same results, which is also checked here.
+// It is built only when GAMMA_VERSION is SIMD or THREADS_SIMD.
+
+#include <chrono>
+#include <vector>
+#include <random>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+#include <yagit/yagit.hpp>
+
+#include "../../src/gamma/GammaWendling.hpp"
+#include "../../src/gamma/GammaWendlingSimd.hpp"
+
+using GammaFunc = std::function<yagit::GammaResult(const yagit::ImageView&, const yagit::ImageView&,
+                                                   const yagit::GammaParameters&)>;
+
+// gamma index implementations have additional optional parameter (monitor of passing rate)
+template <typename Kernels>
+yagit::GammaResult wendling2D(const yagit::ImageView& refImg, const yagit::ImageView& evalImg,
+                              const yagit::GammaParameters& gammaParams){
+    return yagit::gammaIndex2DWendlingImpl<yagit::SequentialExecution, Kernels>(refImg, evalImg, gammaParams);
+}
+
+template <typename Kernels>
+yagit::GammaResult wendling2_5D(const yagit::ImageView& refImg, const yagit::ImageView& evalImg,
+                                const yagit::GammaParameters& gammaParams){
+    return yagit::gammaIndex2_5DWendlingImpl<yagit::SequentialExecution, Kernels>(refImg, evalImg, gammaParams);
+}
+
+template <typename Kernels>
+yagit::GammaResult wendling3D(const yagit::ImageView& refImg, const yagit::ImageView& evalImg,
+                              const yagit::GammaParameters& gammaParams){
+    return yagit::gammaIndex3DWendlingImpl<yagit::SequentialExecution, Kernels>(refImg, evalImg, gammaParams);
+}
+
+struct Scenario{
+    std::string name;
+    float shiftMm;          // shift of evaluated image
+    float doseScale;        // evaluated dose = reference dose * doseScale
+    float noise;            // relative noise of evaluated dose
+};
+
+// in the first scenario search ends after a few points for most voxels,
+// in the second one it is long for all voxels, and in the third one its length differs between adjacent voxels
+const std::vector<Scenario> scenarios = {
+    {"similar doses",         0.5f, 1.00f, 0.00f},
+    {"uniformly far doses",   1.5f, 1.04f, 0.00f},
+    {"noisy evaluated image", 0.5f, 1.00f, 0.03f}
+};
+
+const yagit::DataSize SIZE_3D{60, 80, 80};
+const yagit::DataSpacing SPACING_3D{2.5f, 2.5f, 2.5f};
+const uint32_t NR_OF_TESTS = 3;
+
+yagit::ImageData generateDose(const yagit::DataSize& size, const yagit::DataOffset& offset,
+                              const yagit::DataSpacing& spacing, float scale, float noise, std::mt19937& gen){
+    std::uniform_real_distribution<float> noiseDist(1 - noise, 1 + noise);
+    yagit::ImageData::container_type data;
+    data.reserve(static_cast<size_t>(size.frames) * size.rows * size.columns);
+    for(uint32_t k = 0; k < size.frames; k++){
+        const float z = offset.frames + k * spacing.frames - 75;
+        for(uint32_t j = 0; j < size.rows; j++){
+            const float y = offset.rows + j * spacing.rows - 100;
+            for(uint32_t i = 0; i < size.columns; i++){
+                const float x = offset.columns + i * spacing.columns - 100;
+                // two overlapping fields with steep edges
+                const float field1 = std::exp(-(x * x + y * y) / 3000) * std::exp(-z * z / 2000);
+                const float field2 = 0.5f / (1 + std::exp((std::abs(x - 20) - 40) / 3));
+                float dose = 60 * (field1 + field2) * scale;
+                if(noise > 0){
+                    dose *= noiseDist(gen);
+                }
+                data.push_back(dose);
+            }
+        }
+    }
+    return yagit::ImageData(std::move(data), size, offset, spacing);
+}
+
+double measureGamma(const GammaFunc& gammaFunc, const yagit::ImageData& refImg, const yagit::ImageData& evalImg,
+                    const yagit::GammaParameters& gammaParams, yagit::GammaResult& gammaRes){
+    double minTimeMs = std::numeric_limits<double>::max();
+    for(uint32_t i = 0; i < NR_OF_TESTS; i++){
+        auto begin = std::chrono::steady_clock::now();
+
+        gammaRes = gammaFunc(refImg, evalImg, gammaParams);
+
+        auto end = std::chrono::steady_clock::now();
+        auto timeMs = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0;
+        minTimeMs = std::min(minTimeMs, timeMs);
+    }
+    return minTimeMs;
+}
+
+bool equalResults(const yagit::GammaResult& lhs, const yagit::GammaResult& rhs){
+    if(lhs.size() != rhs.size()){
+        return false;
+    }
+    for(size_t i = 0; i < lhs.size(); i++){
+        const float l = lhs.get(i);
+        const float r = rhs.get(i);
+        if(l != r && !(std::isnan(l) && std::isnan(r))){
+            return false;
+        }
+    }
+    return true;
+}
+
+void compare(const std::string& dims, const GammaFunc& scalarFunc, const GammaFunc& simdFunc,
+             const yagit::ImageData& refImg, const yagit::ImageData& evalImg, const yagit::GammaParameters& gammaParams){
+    yagit::GammaResult scalarRes;
+    yagit::GammaResult simdRes;
+    const double scalarTimeMs = measureGamma(scalarFunc, refImg, evalImg, gammaParams, scalarRes);
+    const double simdTimeMs = measureGamma(simdFunc, refImg, evalImg, gammaParams, simdRes);
+
+    std::cout << "  " << std::setw(5) << dims
+              << " | scalar: " << std::setw(10) << scalarTimeMs << " ms"
+              << " | simd: " << std::setw(10) << simdTimeMs << " ms"
+              << " | speedup: " << std::setw(6) << scalarTimeMs / simdTimeMs
+              << " | GIPR: " << scalarRes.passingRate() * 100 << "%"
+              << (equalResults(scalarRes, simdRes) ? "" : " | RESULTS DIFFER") << "\n";
+}
+
+int main(){
+    using namespace yagit;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "SIMD width: " << SimdElementCount << " floats\n";
+
+    for(const auto& scenario : scenarios){
+        std::mt19937 gen(1234);
+        const DataOffset refOffset{0, 0, 0};
+        const DataOffset evalOffset{scenario.shiftMm, scenario.shiftMm, scenario.shiftMm};
+        const ImageData refImg3D = generateDose(SIZE_3D, refOffset, SPACING_3D, 1, 0, gen);
+        const ImageData evalImg3D = generateDose(SIZE_3D, evalOffset, SPACING_3D, scenario.doseScale, scenario.noise, gen);
+
+        const uint32_t frame = SIZE_3D.frames / 2;
+        const ImageData refImg2D = refImg3D.getImageData2D(frame, ImagePlane::Axial);
+        const ImageData evalImg2D = evalImg3D.getImageData2D(frame, ImagePlane::Axial);
+
+        const GammaParameters gammaParams{3, 3, GammaNormalization::Global, refImg3D.max(),
+                                          0.05f * refImg3D.max(), 9, 0.3f};
+
+        std::cout << scenario.name << ":\n";
+        compare("2D", wendling2D<WendlingKernels>,
+                wendling2D<WendlingSimdKernels>,
+                refImg2D, evalImg2D, gammaParams);
+        compare("2.5D", wendling2_5D<WendlingKernels>,
+                wendling2_5D<WendlingSimdKernels>,
+                refImg3D, evalImg3D, gammaParams);
+        compare("3D", wendling3D<WendlingKernels>,
+                wendling3D<WendlingSimdKernels>,
+                refImg3D, evalImg3D, gammaParams);
+    }
+}
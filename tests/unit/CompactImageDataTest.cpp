@@ -0,0 +1,305 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/CompactImageData.hpp"
+#include "yagit/Gamma.hpp"
+#include "yagit/Interpolation.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "TestUtils.hpp"
+
+using ::testing::IsNan, ::testing::ThrowsMessage, ::testing::Pointwise, ::testing::NanSensitiveFloatEq,
+      ::testing::ElementsAre, ::testing::ElementsAreArray, ::testing::IsEmpty;
+
+namespace{
+const float NaN = std::numeric_limits<float>::quiet_NaN();
+const float INF = std::numeric_limits<float>::infinity();
+
+const yagit::DataOffset DATA_OFFSET{0.1, -1.2, 0.0};
+const yagit::DataSpacing DATA_SPACING{1.0, 2.0, 2.5};
+
+// values of data rounded to format and widened back to float
+std::vector<float> roundTrip(const std::vector<float>& data, yagit::CompactFormat format){
+    const yagit::ImageData img(data, {1, 1, static_cast<uint32_t>(data.size())}, DATA_OFFSET, DATA_SPACING);
+    const yagit::CompactImageData compactImg(img, format);
+    std::vector<float> result;
+    for(uint32_t i = 0; i < compactImg.size(); i++){
+        result.push_back(compactImg.get(i));
+    }
+    EXPECT_THAT(compactImg.toImageData().getData(), Pointwise(NanSensitiveFloatEq(), result));
+    return result;
+}
+}
+
+TEST(CompactImageDataTest, float16KeepsRepresentableValues){
+    // the last three values are the smallest subnormal, the largest subnormal and the smallest normal number
+    const std::vector<float> data{0.0f, 1.0f, -2.5f, 0.333251953125f, 1000.5f, 65504.0f, -65504.0f,
+                                  0x1p-24f, 0x1.ff8p-15f, 0x1p-14f};
+    EXPECT_EQ(data, roundTrip(data, yagit::CompactFormat::Float16));
+    EXPECT_TRUE(std::signbit(roundTrip({-0.0f}, yagit::CompactFormat::Float16)[0]));
+}
+
+TEST(CompactImageDataTest, float16RoundsToNearestEven){
+    const std::vector<float> data{1 + 0x1p-11f, 1 + 3 * 0x1p-11f, 1 + 0x1p-11f + 0x1p-20f, 0.1f,
+                                  0x1p-26f, 3 * 0x1p-25f, 65519.0f};
+    const std::vector<float> expected{1.0f, 1 + 0x1p-9f, 1 + 0x1p-10f, 0.0999755859375f,
+                                      0.0f, 0x1p-23f, 65504.0f};
+    EXPECT_EQ(expected, roundTrip(data, yagit::CompactFormat::Float16));
+}
+
+TEST(CompactImageDataTest, float16SpecialValues){
+    const std::vector<float> result = roundTrip({INF, -INF, 65520.0f, -1e10f, NaN}, yagit::CompactFormat::Float16);
+    EXPECT_EQ(INF, result[0]);
+    EXPECT_EQ(-INF, result[1]);
+    EXPECT_EQ(INF, result[2]);
+    EXPECT_EQ(-INF, result[3]);
+    EXPECT_THAT(result[4], IsNan());
+}
+
+TEST(CompactImageDataTest, bfloat16RoundsToNearestEven){
+    const std::vector<float> data{0.0f, 1.0f, -3.140625f, 1 + 0x1p-8f, 1 + 3 * 0x1p-8f, 1e30f, INF, -INF};
+    const std::vector<float> result = roundTrip(data, yagit::CompactFormat::BFloat16);
+    const std::vector<float> expected{0.0f, 1.0f, -3.140625f, 1.0f, 1 + 0x1p-6f, result[5], INF, -INF};
+    EXPECT_EQ(expected, result);
+    EXPECT_NEAR(1e30f, result[5], 1e30f * 0x1p-8f);
+
+    EXPECT_THAT(roundTrip({NaN}, yagit::CompactFormat::BFloat16)[0], IsNan());
+}
+
+TEST(CompactImageDataTest, uint16QuantizesValuesUpToMaximum){
+    const std::vector<float> data{0.0f, 1.0f, 2.5f, 0.001f, 10.0f, 7.77f};
+    const yagit::ImageData img(data, {1, 2, 3}, DATA_OFFSET, DATA_SPACING);
+
+    const yagit::CompactImageData compactImg(img, yagit::CompactFormat::UInt16);
+
+    const double scaling = 10.0 / 65535;
+    EXPECT_DOUBLE_EQ(scaling, compactImg.getScaling());
+    EXPECT_EQ(65535, compactImg.data()[4]);
+    EXPECT_EQ(0, compactImg.data()[0]);
+    for(uint32_t i = 0; i < img.size(); i++){
+        EXPECT_NEAR(img.get(i), compactImg.get(i), scaling / 2 + 1e-6);
+    }
+}
+
+TEST(CompactImageDataTest, uint16ForNegativeOrNanValuesShouldThrow){
+    for(const float value : {-1.0f, NaN, INF}){
+        const yagit::ImageData img(yagit::ImageData::container_type{1.0f, value}, {1, 1, 2}, DATA_OFFSET, DATA_SPACING);
+        const auto constructor = [&img](){ yagit::CompactImageData(img, yagit::CompactFormat::UInt16); };
+        EXPECT_THAT(constructor, ThrowsMessage<std::invalid_argument>("UInt16 format can't store negative, infinite or NaN values"));
+    }
+}
+
+TEST(CompactImageDataTest, uint16DataConstructorAppliesScaling){
+    const double scaling = 0.03125047684443427;
+    yagit::CompactImageData::container_type data{4, 3213, 0, 65535};
+    const yagit::CompactImageData compactImg(std::move(data), yagit::CompactFormat::UInt16,
+                                             {1, 2, 2}, DATA_OFFSET, DATA_SPACING, scaling);
+
+    std::vector<float> expected;
+    for(const double el : {4, 3213, 0, 65535}){
+        expected.push_back(static_cast<float>(el * scaling));
+    }
+    EXPECT_EQ(scaling, compactImg.getScaling());
+    EXPECT_EQ(expected, compactImg.toImageData().getData());
+    EXPECT_THAT(compactImg.readFrames(0, 1), ElementsAreArray(expected));
+    EXPECT_EQ(expected[1], compactImg.get(0, 0, 1));
+
+    const auto incorrectScaling = [](){
+        yagit::CompactImageData({1}, yagit::CompactFormat::UInt16, {1, 1, 1}, DATA_OFFSET, DATA_SPACING, 0);
+    };
+    EXPECT_THAT(incorrectScaling, ThrowsMessage<std::invalid_argument>("scaling should be greater than 0"));
+}
+
+TEST(CompactImageDataTest, constructorFromImage){
+    const std::vector<float> data{1.5, 2.3, 4.4, 0.1, -0.3, 0.0, -2.5, 153.0, -200.4, 12.9, 9.0, 0.0};
+    const yagit::DataSize size{2, 3, 2};
+    const yagit::ImageData img(data, size, DATA_OFFSET, DATA_SPACING);
+
+    for(const auto format : {yagit::CompactFormat::Float16, yagit::CompactFormat::BFloat16}){
+        const yagit::CompactImageData compactImg(img, format);
+        EXPECT_EQ(size, compactImg.getSize());
+        EXPECT_EQ(DATA_OFFSET, compactImg.getOffset());
+        EXPECT_EQ(DATA_SPACING, compactImg.getSpacing());
+        EXPECT_EQ(format, compactImg.getFormat());
+        EXPECT_EQ(img.size(), compactImg.size());
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(compactImg.data()) % yagit::DataAlignment);
+
+        const float maxRelError = format == yagit::CompactFormat::Float16 ? 0x1p-11f : 0x1p-8f;
+        for(uint32_t i = 0; i < img.size(); i++){
+            EXPECT_NEAR(img.get(i), compactImg.get(i), std::abs(img.get(i)) * maxRelError);
+        }
+        EXPECT_THAT(compactImg.toImageData(), matchImageData(img, 200.4f * maxRelError));
+    }
+}
+
+TEST(CompactImageDataTest, constructorFromStridedView){
+    const std::vector<float> data{1, 2, 3, 4, 5, 6};
+    // every second column of 2x3 image
+    const yagit::ImageView view(data.data(), {1, 2, 2}, DATA_OFFSET, DATA_SPACING, {6, 3, 2});
+
+    const yagit::CompactImageData compactImg(view, yagit::CompactFormat::Float16);
+
+    EXPECT_EQ((std::vector<float>{1, 3, 4, 6}), compactImg.toImageData().getData());
+}
+
+TEST(CompactImageDataTest, dataConstructor){
+    // 1, -2 and infinity in half precision
+    yagit::CompactImageData::container_type data{0x3c00, 0xc000, 0x7c00};
+    const yagit::CompactImageData compactImg(std::move(data), yagit::CompactFormat::Float16,
+                                             {1, 1, 3}, DATA_OFFSET, DATA_SPACING);
+    EXPECT_EQ((std::vector<float>{1, -2, INF}), compactImg.toImageData().getData());
+
+    const auto inconsistentSize = [](){
+        yagit::CompactImageData({0x3c00}, yagit::CompactFormat::Float16, {1, 1, 2}, DATA_OFFSET, DATA_SPACING);
+    };
+    EXPECT_THAT(inconsistentSize, ThrowsMessage<std::invalid_argument>("size is inconsistent with data size information"));
+    const auto incorrectSpacing = [](){
+        yagit::CompactImageData({0x3c00}, yagit::CompactFormat::Float16, {1, 1, 1}, DATA_OFFSET, {1, 0, 1});
+    };
+    EXPECT_THAT(incorrectSpacing, ThrowsMessage<std::invalid_argument>("spacing should be greater than 0"));
+}
+
+TEST(CompactImageDataTest, readFrames){
+    const std::vector<float> data{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    const yagit::ImageData img(data, {3, 2, 2}, DATA_OFFSET, DATA_SPACING);
+    const yagit::CompactImageData compactImg(img, yagit::CompactFormat::BFloat16);
+
+    EXPECT_THAT(compactImg.readFrames(1, 2), ElementsAre(5, 6, 7, 8, 9, 10, 11, 12));
+    EXPECT_THAT(compactImg.readFrames(3, 0), IsEmpty());
+    EXPECT_THROW(compactImg.readFrames(2, 2), std::out_of_range);
+    EXPECT_THROW(compactImg.readFrames(4, 0), std::out_of_range);
+
+    const yagit::StreamedImage streamedImg = compactImg.streamed();
+    EXPECT_EQ(img.getSize(), streamedImg.size);
+    EXPECT_EQ(img.getOffset(), streamedImg.offset);
+    EXPECT_EQ(img.getSpacing(), streamedImg.spacing);
+    EXPECT_THAT(streamedImg.readFrames(0, 1), ElementsAre(1, 2, 3, 4));
+}
+
+TEST(CompactImageDataTest, streamedGammaIndexShouldReturnTheSameImageAsGammaIndexOfWidenedImages){
+    const yagit::DataSize size{6, 5, 7};
+    std::vector<float> refData(size.frames * size.rows * size.columns);
+    std::vector<float> evalData(refData.size());
+    for(size_t i = 0; i < refData.size(); i++){
+        refData[i] = 1 + 0.5f * std::sin(0.3f * i);
+        evalData[i] = 1 + 0.5f * std::sin(0.3f * i + 0.2f);
+    }
+    const yagit::CompactImageData refImg(yagit::ImageData(refData, size, {0, 0, 0}, {1, 1, 1}),
+                                         yagit::CompactFormat::Float16);
+    const yagit::CompactImageData evalImg(yagit::ImageData(evalData, size, {0.3, 0.2, -0.1}, {1, 1, 1}),
+                                          yagit::CompactFormat::Float16);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 2, 0.2};
+
+    const yagit::GammaResult expected = yagit::gammaIndex3DWendling(refImg.toImageData(), evalImg.toImageData(),
+                                                                    gammaParams);
+    std::vector<float> gammaVals;
+    yagit::gammaIndex3DWendlingStreamed(refImg.streamed(), evalImg.streamed(), gammaParams, 2,
+        [&](const yagit::GammaResult& slab, uint32_t){
+            gammaVals.insert(gammaVals.end(), slab.data(), slab.data() + slab.size());
+        });
+
+    EXPECT_THAT(expected, matchImageData(gammaVals, size, {0, 0, 0}, {1, 1, 1}, 1e-5));
+}
+
+namespace{
+// smooth dose distribution stored in the given format
+yagit::CompactImageData compactImageData(const yagit::DataSize& size, const yagit::DataOffset& offset, float phase,
+                                         yagit::CompactFormat format = yagit::CompactFormat::Float16){
+    std::vector<float> data(static_cast<size_t>(size.frames) * size.rows * size.columns);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = 1 + 0.5f * std::sin(0.3f * i + phase);
+    }
+    return yagit::CompactImageData(yagit::ImageData(data, size, offset, {1, 1, 1}), format);
+}
+}
+
+class CompactImageDataGammaTest : public ::testing::TestWithParam<yagit::CompactFormat> {};
+
+INSTANTIATE_TEST_SUITE_P(CompactImageDataTest, CompactImageDataGammaTest,
+                         ::testing::Values(yagit::CompactFormat::Float16, yagit::CompactFormat::BFloat16,
+                                           yagit::CompactFormat::UInt16));
+
+TEST_P(CompactImageDataGammaTest, gammaIndexOfCompactImagesShouldReturnTheSameImageAsGammaIndexOfWidenedImages){
+    // images span several slabs of reference and evaluated image (128 rows in 2D, 8 frames in 3D),
+    // evaluated image is read by kernels as raw values of each format
+    const yagit::CompactFormat format = GetParam();
+    const yagit::CompactImageData refImg2D = compactImageData({1, 140, 6}, {0, 0, 0}, 0, format);
+    const yagit::CompactImageData evalImg2D = compactImageData({1, 138, 7}, {0, 0.2, -0.1}, 0.2f, format);
+    const yagit::CompactImageData refImg3D = compactImageData({20, 6, 7}, {0, 0, 0}, 0, format);
+    const yagit::CompactImageData evalImg3D = compactImageData({21, 6, 6}, {0.3, 0.2, -0.1}, 0.2f, format);
+    const yagit::ImageData widenedRef2D = refImg2D.toImageData();
+    const yagit::ImageData widenedEval2D = evalImg2D.toImageData();
+    const yagit::ImageData widenedRef3D = refImg3D.toImageData();
+    const yagit::ImageData widenedEval3D = evalImg3D.toImageData();
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0.6, 2, 0.2};
+
+    // coordinates of slabs are calculated from their first voxel, so they can have different rounding errors
+    // (and vectorized classic method scales UInt16 values in float)
+    const float maxAbsError = 1e-5;
+    EXPECT_THAT(yagit::gammaIndex2DClassic(refImg2D, evalImg2D, gammaParams),
+                matchImageData(yagit::gammaIndex2DClassic(widenedRef2D, widenedEval2D, gammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex2_5DClassic(refImg3D, evalImg3D, gammaParams),
+                matchImageData(yagit::gammaIndex2_5DClassic(widenedRef3D, widenedEval3D, gammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex3DClassic(refImg3D, evalImg3D, gammaParams),
+                matchImageData(yagit::gammaIndex3DClassic(widenedRef3D, widenedEval3D, gammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex2DWendling(refImg2D, evalImg2D, gammaParams),
+                matchImageData(yagit::gammaIndex2DWendling(widenedRef2D, widenedEval2D, gammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex2_5DWendling(refImg3D, evalImg3D, gammaParams),
+                matchImageData(yagit::gammaIndex2_5DWendling(widenedRef3D, widenedEval3D, gammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex3DWendling(refImg3D, evalImg3D, gammaParams),
+                matchImageData(yagit::gammaIndex3DWendling(widenedRef3D, widenedEval3D, gammaParams), maxAbsError));
+
+    // cubic interpolation reads rows of evaluated image directly
+    yagit::GammaParameters cubicGammaParams = gammaParams;
+    cubicGammaParams.interpolation = yagit::GammaInterpolation::Cubic;
+    EXPECT_THAT(yagit::gammaIndex2DWendling(refImg2D, evalImg2D, cubicGammaParams),
+                matchImageData(yagit::gammaIndex2DWendling(widenedRef2D, widenedEval2D, cubicGammaParams), maxAbsError));
+    EXPECT_THAT(yagit::gammaIndex3DWendling(refImg3D, evalImg3D, cubicGammaParams),
+                matchImageData(yagit::gammaIndex3DWendling(widenedRef3D, widenedEval3D, cubicGammaParams), maxAbsError));
+}
+
+TEST(CompactImageDataTest, gammaIndexOfCompactImagesForIncorrectArgumentsShouldThrow){
+    const yagit::CompactImageData img2D = compactImageData({1, 3, 4}, {0, 0, 0}, 0);
+    const yagit::CompactImageData img3D = compactImageData({3, 3, 4}, {0, 0, 0}, 0);
+    const yagit::CompactImageData shorterImg3D = compactImageData({2, 3, 4}, {0, 0, 0}, 0);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 2, 0.2};
+    const yagit::GammaParameters incorrectGammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 0, 0};
+
+    EXPECT_THROW(yagit::gammaIndex2DClassic(img3D, img2D, gammaParams), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2DWendling(img2D, img3D, gammaParams), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2_5DClassic(img3D, shorterImg3D, gammaParams), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendling(img3D, img3D, incorrectGammaParams), std::invalid_argument);
+}
+
+TEST(CompactImageDataTest, linearFrameAtZShouldReturnTheSameFrameAsForWidenedImage){
+    const yagit::CompactImageData img = compactImageData({4, 3, 5}, {0.5, 0, 0}, 0);
+    const yagit::ImageData widenedImg = img.toImageData();
+
+    for(const float z : {0.5f, 1.2f, 2.75f, 3.5f}){
+        EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(img, z, 0.25),
+                    matchImageData(*yagit::Interpolation::linearFrameAtZ(widenedImg, z, 0.25)));
+    }
+    EXPECT_EQ(std::nullopt, yagit::Interpolation::linearFrameAtZ(img, 0.4, 0.25));
+    EXPECT_EQ(std::nullopt, yagit::Interpolation::linearFrameAtZ(img, 3.6, 0.25));
+}
@@ -19,6 +19,9 @@
 
 #include "yagit/DataReader.hpp"
 
+#include <fstream>
+#include <sstream>
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "TestUtils.hpp"
@@ -41,12 +44,25 @@ const std::string DATA_DIR = "data/";
 const std::string DICOM_RTDOSE_FILE = DATA_DIR + "test_dicom_rtdose.dcm";
 const std::string DICOM_RTDOSE_FILE_BIG_ENDIAN = DATA_DIR + "test_dicom_rtdose_big_endian.dcm";
 const std::string DICOM_RTDOSE_FILE_16_BIT = DATA_DIR + "test_dicom_rtdose_16bit.dcm";
+const std::string DICOM_RTDOSE_FILE_NEXT_FRAMES = DATA_DIR + "test_dicom_rtdose_next_frames.dcm";
+const std::string DICOM_RTDOSE_FILE_SINGLE_FRAME = DATA_DIR + "test_dicom_rtdose_single_frame.dcm";
+const std::string DICOM_RTDOSE_FILE_SHIFTED_XY = DATA_DIR + "test_dicom_rtdose_shifted_xy.dcm";
+const std::string DICOM_RTDOSE_FILE_OTHER_PIXEL_SPACING = DATA_DIR + "test_dicom_rtdose_other_pixel_spacing.dcm";
 const std::string DICOM_CT_FILE = DATA_DIR + "test_dicom_ct.dcm";
 const std::string METAIMAGE_FILE = DATA_DIR + "test_metaimage.mha";
 const std::string METAIMAGE_FILE_UNFORMATTED = DATA_DIR + "test_metaimage_unformatted.mha";
 const std::string METAIMAGE_FILE_BIG_ENDIAN = DATA_DIR + "test_metaimage_big_endian.mha";
 const std::string METAIMAGE_FILE_INT = DATA_DIR + "test_metaimage_int.mha";
+const std::string METAIMAGE_FILE_COMPRESSED = DATA_DIR + "test_metaimage_compressed.mha";
+const std::string METAIMAGE_FILE_DETACHED = DATA_DIR + "test_metaimage_detached.mhd";
+const std::string METAIMAGE_FILE_LIST = DATA_DIR + "test_metaimage_list.mhd";
+const std::string METAIMAGE_FILE_PATTERN = DATA_DIR + "test_metaimage_pattern.mhd";
 const std::string NONEXISTENT_FILE = DATA_DIR + "nonexistent_file";
+
+std::vector<char> readFileToBuffer(const std::string& filepath){
+    std::ifstream file(filepath, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
 }
 
 class DataReaderRTDoseTest : public ::testing::Test{
@@ -60,7 +76,7 @@ public:
         const yagit::DataSpacing dataSpacing{1.0, 2.5, 0.5};
         const double doseGridScaling = 0.0001220703125284217;
 
-        std::vector<float> data;
+        yagit::ImageData::container_type data;
         for(const auto& el : rawData){
             data.push_back(static_cast<float>(doseGridScaling * static_cast<double>(el)));
         }
@@ -82,6 +98,25 @@ TEST_F(DataReaderRTDoseTest, readRTDoseDicomBigEndian){
     EXPECT_THAT(imageData, matchImageData(expectedImageData));
 }
 
+TEST_F(DataReaderRTDoseTest, readRTDoseDicomFromStream){
+    std::ifstream file(DICOM_RTDOSE_FILE, std::ios::binary);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicom(file, true));
+    EXPECT_THAT(imageData, matchImageData(expectedImageData));
+}
+
+TEST_F(DataReaderRTDoseTest, readRTDoseDicomFromBuffer){
+    const std::vector<char> buffer = readFileToBuffer(DICOM_RTDOSE_FILE_BIG_ENDIAN);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicomFromBuffer(buffer.data(), buffer.size(), true));
+    EXPECT_THAT(imageData, matchImageData(expectedImageData));
+}
+
+TEST(DataReaderTest, readRTDoseDicomFromEmptyBufferShouldThrow){
+    const auto readRTDoseDicomFromBuffer = [](){ yagit::DataReader::readRTDoseDicomFromBuffer(nullptr, 0); };
+    EXPECT_THAT(readRTDoseDicomFromBuffer, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
+}
+
 TEST(DataReaderTest, readRTDoseDicom16bit){
     const std::vector<uint32_t> rawData{4, 3213, 0, 31, 67, 177, 28581, 14540, 29548, 63999, 65535, 22125};
     const yagit::DataSize dataSize{3, 2, 2};
@@ -89,7 +124,7 @@ TEST(DataReaderTest, readRTDoseDicom16bit){
     const yagit::DataSpacing dataSpacing{1.0, 2.5, 0.5};
     const double doseGridScaling = 0.03125047684443427;
 
-    std::vector<float> data;
+    yagit::ImageData::container_type data;
     for(const auto& el : rawData){
         data.push_back(static_cast<float>(doseGridScaling * static_cast<double>(el)));
     }
@@ -101,6 +136,22 @@ TEST(DataReaderTest, readRTDoseDicom16bit){
     EXPECT_THAT(imageData, matchImageData(expectedImageData));
 }
 
+TEST(DataReaderTest, readRTDoseDicomCompact16bitShouldReturnTheSameValuesAsReadRTDoseDicom){
+    yagit::CompactImageData compactImageData;
+    ASSERT_NO_THROW(compactImageData = yagit::DataReader::readRTDoseDicomCompact(DICOM_RTDOSE_FILE_16_BIT));
+
+    EXPECT_EQ(yagit::CompactFormat::UInt16, compactImageData.getFormat());
+    EXPECT_DOUBLE_EQ(0.03125047684443427, compactImageData.getScaling());
+    EXPECT_EQ(63999, compactImageData.data()[9]);
+    EXPECT_THAT(compactImageData.toImageData(),
+                matchImageData(yagit::DataReader::readRTDoseDicom(DICOM_RTDOSE_FILE_16_BIT)));
+}
+
+TEST(DataReaderTest, readRTDoseDicomCompact32bitShouldThrow){
+    const auto readRTDoseDicomCompact = [](){ yagit::DataReader::readRTDoseDicomCompact(DICOM_RTDOSE_FILE); };
+    EXPECT_THAT(readRTDoseDicomCompact, ThrowsMessage<std::runtime_error>(HasSubstr("can't be stored in 16-bit integers")));
+}
+
 TEST(DataReaderTest, readCTDicom){
     const auto readCTDicom = [](){ yagit::DataReader::readRTDoseDicom(DICOM_CT_FILE); };
     EXPECT_THAT(readCTDicom, ThrowsMessage<std::runtime_error>(HasSubstr("SOP Class UID")));
@@ -111,6 +162,112 @@ TEST(DataReaderTest, readRTDoseDicomForNonexistentFileShouldThrow){
     EXPECT_THAT(readNonexistentDicom, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
 }
 
+TEST(DataReaderTest, readRTDoseDicomSeriesWithOneFileShouldReturnTheSameImageAsReadRTDoseDicom){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicomSeries({DICOM_RTDOSE_FILE}));
+    EXPECT_THAT(imageData, matchImageData(yagit::DataReader::readRTDoseDicom(DICOM_RTDOSE_FILE)));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeries){
+    // frames at z = 2.1, 3.1, 4.1 (32-bit), 5.1, 6.1, 7.1 (16-bit) and 8.1 (32-bit, single frame)
+    const std::vector<uint32_t> rawData32bit{
+        8191, 16383, 0, 8191, 2047, 8191, 10919, 819, 1011155926, 8191918, 4294967295, 3636428
+    };
+    const std::vector<uint32_t> rawData16bit{4, 3213, 0, 31, 67, 177, 28581, 14540, 29548, 63999, 65535, 22125};
+    const double doseGridScaling32bit = 0.0001220703125284217;
+    const double doseGridScaling16bit = 0.03125047684443427;
+
+    yagit::ImageData::container_type data;
+    for(const auto& el : rawData32bit){
+        data.push_back(static_cast<float>(doseGridScaling32bit * static_cast<double>(el)));
+    }
+    for(const auto& el : rawData16bit){
+        data.push_back(static_cast<float>(doseGridScaling16bit * static_cast<double>(el)));
+    }
+    for(size_t i = 0; i < 4; i++){
+        data.push_back(static_cast<float>(doseGridScaling32bit * static_cast<double>(rawData32bit[i])));
+    }
+    const yagit::ImageData expectedImageData(std::move(data), {7, 2, 2}, {2.1, -3.2, 0.0}, {1.0, 2.5, 0.5});
+
+    // files given out of order
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicomSeries(
+        {DICOM_RTDOSE_FILE_SINGLE_FRAME, DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_NEXT_FRAMES}));
+    EXPECT_THAT(imageData, matchImageData(expectedImageData));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeriesWithDifferentPositionInXYShouldThrow){
+    const auto readRTDoseDicomSeries = [](){
+        yagit::DataReader::readRTDoseDicomSeries({DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_SHIFTED_XY});
+    };
+    EXPECT_THAT(readRTDoseDicomSeries, ThrowsMessage<std::runtime_error>(HasSubstr("Image Position Patient")));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeriesWithDifferentPixelSpacingShouldThrow){
+    const auto readRTDoseDicomSeries = [](){
+        yagit::DataReader::readRTDoseDicomSeries({DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_OTHER_PIXEL_SPACING});
+    };
+    EXPECT_THAT(readRTDoseDicomSeries, ThrowsMessage<std::runtime_error>(HasSubstr("Pixel Spacing")));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeriesWithUnevenGapBetweenFilesShouldThrow){
+    // frames at z = 2.1, 3.1, 4.1 and 8.1
+    const auto readRTDoseDicomSeries = [](){
+        yagit::DataReader::readRTDoseDicomSeries({DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_SINGLE_FRAME});
+    };
+    EXPECT_THAT(readRTDoseDicomSeries, ThrowsMessage<std::runtime_error>(HasSubstr("uneven spacing between frames")));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeriesWithFramesAtTheSamePositionShouldThrow){
+    const auto readRTDoseDicomSeries = [](){
+        yagit::DataReader::readRTDoseDicomSeries({DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_16_BIT});
+    };
+    EXPECT_THAT(readRTDoseDicomSeries, ThrowsMessage<std::runtime_error>(HasSubstr("frames at the same position")));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSeriesWithEmptyListShouldThrow){
+    const auto readRTDoseDicomSeries = [](){ yagit::DataReader::readRTDoseDicomSeries({}); };
+    EXPECT_THROW(readRTDoseDicomSeries(), std::invalid_argument);
+}
+
+TEST(DataReaderTest, readRTDoseDicomSum){
+    const std::vector<uint32_t> rawData32bit{
+        8191, 16383, 0, 8191, 2047, 8191, 10919, 819, 1011155926, 8191918, 4294967295, 3636428
+    };
+    const std::vector<uint32_t> rawData16bit{4, 3213, 0, 31, 67, 177, 28581, 14540, 29548, 63999, 65535, 22125};
+    const double doseGridScaling32bit = 0.0001220703125284217;
+    const double doseGridScaling16bit = 0.03125047684443427;
+
+    yagit::ImageData::container_type data;
+    for(size_t i = 0; i < rawData32bit.size(); i++){
+        data.push_back(static_cast<float>(doseGridScaling32bit * static_cast<double>(rawData32bit[i]) +
+                                          doseGridScaling16bit * static_cast<double>(rawData16bit[i]) +
+                                          doseGridScaling16bit * static_cast<double>(rawData16bit[i])));
+    }
+    const yagit::ImageData expectedImageData(std::move(data), {3, 2, 2}, {2.1, -3.2, 0.0}, {1.0, 2.5, 0.5});
+
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicomSum(
+        {DICOM_RTDOSE_FILE, DICOM_RTDOSE_FILE_16_BIT, DICOM_RTDOSE_FILE_16_BIT}));
+    EXPECT_THAT(imageData, matchImageData(expectedImageData));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSumWithOneFileShouldReturnTheSameImageAsReadRTDoseDicom){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readRTDoseDicomSum({DICOM_RTDOSE_FILE_BIG_ENDIAN}));
+    EXPECT_THAT(imageData, matchImageData(yagit::DataReader::readRTDoseDicom(DICOM_RTDOSE_FILE_BIG_ENDIAN)));
+}
+
+TEST(DataReaderTest, readRTDoseDicomSumWithEmptyListShouldThrow){
+    const auto readRTDoseDicomSum = [](){ yagit::DataReader::readRTDoseDicomSum({}); };
+    EXPECT_THROW(readRTDoseDicomSum(), std::invalid_argument);
+}
+
+TEST(DataReaderTest, readRTDoseDicomSumForNonexistentFileShouldThrow){
+    const auto readRTDoseDicomSum = [](){ yagit::DataReader::readRTDoseDicomSum({DICOM_RTDOSE_FILE, NONEXISTENT_FILE}); };
+    EXPECT_THAT(readRTDoseDicomSum, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
+}
+
 TEST(DataReaderTest, readMetaImage){
     yagit::ImageData imageData;
     ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(METAIMAGE_FILE, true));
@@ -142,7 +299,138 @@ TEST(DataReaderTest, readMetaImageWithIntTypeData){
     EXPECT_THAT(imageData, matchImageData(imageDataInt));
 }
 
+TEST(DataReaderTest, readMetaImageCompressed){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(METAIMAGE_FILE_COMPRESSED, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageDetached){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(METAIMAGE_FILE_DETACHED, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageWithListOfDataFiles){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(METAIMAGE_FILE_LIST, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageWithPatternOfDataFiles){
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(METAIMAGE_FILE_PATTERN, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageFromStream){
+    const std::vector<char> buffer = readFileToBuffer(METAIMAGE_FILE_BIG_ENDIAN);
+    std::istringstream stream(std::string(buffer.begin(), buffer.end()));
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(stream, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageCompressedFromStream){
+    std::ifstream file(METAIMAGE_FILE_COMPRESSED, std::ios::binary);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImage(file, true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageDetachedFromStreamShouldThrow){
+    std::ifstream file(METAIMAGE_FILE_DETACHED, std::ios::binary);
+    const auto readMetaImage = [&file](){ yagit::DataReader::readMetaImage(file); };
+    EXPECT_THAT(readMetaImage, ThrowsMessage<std::runtime_error>(HasSubstr("ElementDataFile = LOCAL")));
+}
+
+TEST(DataReaderTest, readMetaImageFromBuffer){
+    const std::vector<char> buffer = readFileToBuffer(METAIMAGE_FILE);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImageFromBuffer(buffer.data(), buffer.size(), true));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageFromUnalignedBuffer){
+    const std::vector<char> file = readFileToBuffer(METAIMAGE_FILE);
+    std::vector<char> buffer(file.size() + 1);
+    std::copy(file.begin(), file.end(), buffer.begin() + 1);
+
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImageFromBuffer(buffer.data() + 1, file.size()));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageBigEndianFromBuffer){
+    const std::vector<char> buffer = readFileToBuffer(METAIMAGE_FILE_BIG_ENDIAN);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImageFromBuffer(buffer.data(), buffer.size()));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageCompressedFromBuffer){
+    const std::vector<char> buffer = readFileToBuffer(METAIMAGE_FILE_COMPRESSED);
+    yagit::ImageData imageData;
+    ASSERT_NO_THROW(imageData = yagit::DataReader::readMetaImageFromBuffer(buffer.data(), buffer.size()));
+    EXPECT_THAT(imageData, matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, readMetaImageFromTruncatedBufferShouldThrow){
+    const std::vector<char> buffer = readFileToBuffer(METAIMAGE_FILE);
+    const auto readMetaImageFromBuffer = [&buffer](){
+        yagit::DataReader::readMetaImageFromBuffer(buffer.data(), buffer.size() - 1);
+    };
+    EXPECT_THAT(readMetaImageFromBuffer, ThrowsMessage<std::runtime_error>(HasSubstr("bytes of data")));
+}
+
 TEST(DataReaderTest, readMetaImageForNonexistentFileShouldThrow){
     const auto readNonexistentMetaImage = [](){ yagit::DataReader::readMetaImage(NONEXISTENT_FILE); };
     EXPECT_THAT(readNonexistentMetaImage, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
 }
+
+TEST(DataReaderTest, mapMetaImage){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE, true));
+    EXPECT_TRUE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, mapMetaImageBigEndianShouldBeRead){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE_BIG_ENDIAN, true));
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, mapMetaImageWithIntTypeDataShouldBeRead){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE_INT, true));
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(yagit::DataReader::readMetaImage(METAIMAGE_FILE_INT)));
+}
+
+TEST(DataReaderTest, mapMetaImageDetached){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE_DETACHED, true));
+    EXPECT_TRUE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, mapMetaImageWithListOfDataFilesShouldBeRead){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE_LIST, true));
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, mapMetaImageCompressedShouldBeRead){
+    yagit::MappedImage image;
+    ASSERT_NO_THROW(image = yagit::DataReader::mapMetaImage(METAIMAGE_FILE_COMPRESSED, true));
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST(DataReaderTest, mapMetaImageForNonexistentFileShouldThrow){
+    const auto mapNonexistentMetaImage = [](){ yagit::DataReader::mapMetaImage(NONEXISTENT_FILE); };
+    EXPECT_THAT(mapNonexistentMetaImage, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
+}
@@ -18,6 +18,7 @@
  ********************************************************************************************/
 
 #include "yagit/DataWriter.hpp"
+#include "yagit/DataReader.hpp"
 
 #include <fstream>
 #include <cstdio>
@@ -25,6 +26,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include "TestUtils.hpp"
 
 using ::testing::ThrowsMessage, ::testing::HasSubstr;
 
@@ -103,6 +105,54 @@ TEST(DataWriterTest, writeToMetaImageForImageData3DShouldSuccess){
     std::remove(METAIMAGE_FILE.c_str());
 }
 
+TEST(DataWriterTest, writeToMetaImageCompressedShouldBeReadable){
+    // image with large area of constant values is compressed several times
+    const yagit::ImageData image(yagit::ImageData::container_type(64 * 64 * 64, 0.5f), {64, 64, 64}, DATA_OFFSET_3D, DATA_SPACING_3D);
+    const size_t bytes = image.size() * sizeof(float);
+
+    for(int compressionLevel : {1, 6, 9}){
+        yagit::DataWriter::writeToMetaImage(image, METAIMAGE_FILE, compressionLevel);
+
+        std::ifstream file(METAIMAGE_FILE, std::ios::binary);
+        ASSERT_FALSE(file.fail());
+        std::stringstream content;
+        content << file.rdbuf();
+        file.close();
+        EXPECT_THAT(content.str(), HasSubstr("CompressedData = True\nCompressedDataSize = "));
+        EXPECT_LT(content.str().size(), bytes / 10);
+
+        EXPECT_THAT(yagit::DataReader::readMetaImage(METAIMAGE_FILE), matchImageData(image));
+    }
+
+    std::remove(METAIMAGE_FILE.c_str());
+}
+
+TEST(DataWriterTest, writeToMetaImageCompressedForImageData3DShouldBeReadable){
+    yagit::DataWriter::writeToMetaImage(IMAGE_DATA_3D, METAIMAGE_FILE, 9);
+    EXPECT_THAT(yagit::DataReader::readMetaImage(METAIMAGE_FILE), matchImageData(IMAGE_DATA_3D));
+
+    std::remove(METAIMAGE_FILE.c_str());
+}
+
+TEST(DataWriterTest, writeToMetaImageCompressedLargerThanCompressedBlockShouldBeReadable){
+    // 2.5 MiB of data is compressed in 3 independent blocks, which must be joined in order
+    yagit::ImageData::container_type data(160 * 64 * 64);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = static_cast<float>(i / 1000);
+    }
+    const yagit::ImageData image(std::move(data), {160, 64, 64}, DATA_OFFSET_3D, DATA_SPACING_3D);
+
+    yagit::DataWriter::writeToMetaImage(image, METAIMAGE_FILE, 6);
+    EXPECT_THAT(yagit::DataReader::readMetaImage(METAIMAGE_FILE), matchImageData(image));
+
+    std::remove(METAIMAGE_FILE.c_str());
+}
+
+TEST(DataWriterTest, writeToMetaImageWithInvalidCompressionLevelShouldThrow){
+    EXPECT_THROW(yagit::DataWriter::writeToMetaImage(IMAGE_DATA_3D, METAIMAGE_FILE, -1), std::invalid_argument);
+    EXPECT_THROW(yagit::DataWriter::writeToMetaImage(IMAGE_DATA_3D, METAIMAGE_FILE, 10), std::invalid_argument);
+}
+
 TEST(DataWriterTest, writeToMetaImageForIncorrectPathShouldThrow){
     const std::string NONEXISTENT_PATH = "nonexistent_directory/" + METAIMAGE_FILE;
     const auto writeToNonexistentPath = [&NONEXISTENT_PATH](){
@@ -17,7 +17,13 @@
  * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
  ********************************************************************************************/
 
+#include "yagit/CompactImageData.hpp"
+
 #include "../src/gamma/GammaCommon.hpp"
+#include "../src/gamma/BrickedImage.hpp"
+#include "../src/gamma/PaddedImage.hpp"
+#include "../src/gamma/LazyEvalFrames.hpp"
+#include "../src/gamma/WendlingSearch.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -200,3 +206,294 @@ TEST(GammaCommonTest, sortedPointsInSphereShouldContainPointsOnEdge){
     EXPECT_THAT(sortedPoints, Contains(matchPoint3D({0, 0, 1, 1})));
     #pragma warning(pop)
 }
+
+TEST(GammaCommonTest, mortonCode3D){
+    EXPECT_EQ(0, yagit::mortonCode3D(0, 0, 0));
+    EXPECT_EQ(1, yagit::mortonCode3D(0, 0, 1));
+    EXPECT_EQ(2, yagit::mortonCode3D(0, 1, 0));
+    EXPECT_EQ(4, yagit::mortonCode3D(1, 0, 0));
+    EXPECT_EQ(7, yagit::mortonCode3D(1, 1, 1));
+    EXPECT_EQ(8, yagit::mortonCode3D(0, 0, 2));
+    EXPECT_EQ(56, yagit::mortonCode3D(2, 2, 2));
+}
+
+TEST(GammaCommonTest, generateTilesInRasterOrder){
+    const auto tiles = yagit::generateTiles({3, 5, 4}, {2, 2, 4}, yagit::TileOrder::Raster);
+
+    ASSERT_EQ(6, tiles.size());
+    EXPECT_THAT(tiles[0], FieldsAre(0, 2, 0, 2, 0, 4));
+    EXPECT_THAT(tiles[1], FieldsAre(0, 2, 2, 4, 0, 4));
+    EXPECT_THAT(tiles[2], FieldsAre(0, 2, 4, 5, 0, 4));
+    EXPECT_THAT(tiles[3], FieldsAre(2, 3, 0, 2, 0, 4));
+    EXPECT_THAT(tiles[4], FieldsAre(2, 3, 2, 4, 0, 4));
+    EXPECT_THAT(tiles[5], FieldsAre(2, 3, 4, 5, 0, 4));
+}
+
+TEST(GammaCommonTest, generateTilesInMortonOrder){
+    const auto tiles = yagit::generateTiles({1, 4, 4}, {1, 2, 2}, yagit::TileOrder::Morton);
+
+    ASSERT_EQ(4, tiles.size());
+    EXPECT_THAT(tiles[0], FieldsAre(0, 1, 0, 2, 0, 2));
+    EXPECT_THAT(tiles[1], FieldsAre(0, 1, 0, 2, 2, 4));
+    EXPECT_THAT(tiles[2], FieldsAre(0, 1, 2, 4, 0, 2));
+    EXPECT_THAT(tiles[3], FieldsAre(0, 1, 2, 4, 2, 4));
+}
+
+TEST(GammaCommonTest, generateTilesInMortonByFrameOrder){
+    const auto tiles = yagit::generateTiles({2, 4, 4}, {1, 2, 2}, yagit::TileOrder::MortonByFrame);
+
+    ASSERT_EQ(8, tiles.size());
+    EXPECT_THAT(tiles[0], FieldsAre(0, 1, 0, 2, 0, 2));
+    EXPECT_THAT(tiles[1], FieldsAre(0, 1, 0, 2, 2, 4));
+    EXPECT_THAT(tiles[2], FieldsAre(0, 1, 2, 4, 0, 2));
+    EXPECT_THAT(tiles[3], FieldsAre(0, 1, 2, 4, 2, 4));
+    EXPECT_THAT(tiles[4], FieldsAre(1, 2, 0, 2, 0, 2));
+    EXPECT_THAT(tiles[5], FieldsAre(1, 2, 0, 2, 2, 4));
+    EXPECT_THAT(tiles[6], FieldsAre(1, 2, 2, 4, 0, 2));
+    EXPECT_THAT(tiles[7], FieldsAre(1, 2, 2, 4, 2, 4));
+}
+
+TEST(GammaCommonTest, generateTilesShouldCoverEachVoxelOnce){
+    const yagit::DataSize size{9, 17, 10};
+    const auto tiles = yagit::generateTiles(size, {8, 8, 8}, yagit::TileOrder::Morton);
+
+    std::vector<int> visits(size.frames * size.rows * size.columns, 0);
+    for(const auto& tile : tiles){
+        for(uint32_t k = tile.kBegin; k < tile.kEnd; k++){
+            for(uint32_t j = tile.jBegin; j < tile.jEnd; j++){
+                for(uint32_t i = tile.iBegin; i < tile.iEnd; i++){
+                    visits[(k * size.rows + j) * size.columns + i]++;
+                }
+            }
+        }
+    }
+
+    EXPECT_EQ(2 * 3 * 2, tiles.size());
+    EXPECT_THAT(visits, ::testing::Each(1));
+}
+
+TEST(GammaCommonTest, brickedImageShouldKeepValuesAndMetadata){
+    const yagit::DataSize size{5, 6, 9};
+    std::vector<float> data(size.frames * size.rows * size.columns);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = static_cast<float>(i);
+    }
+    const yagit::ImageData image(data, size, {1, 2, 3}, {0.5, 1, 1.5});
+
+    const yagit::BrickedImage brickedImage(image);
+
+    EXPECT_EQ(size, brickedImage.getSize());
+    EXPECT_EQ(image.getOffset(), brickedImage.getOffset());
+    EXPECT_EQ(image.getSpacing(), brickedImage.getSpacing());
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            for(uint32_t i = 0; i < size.columns; i++){
+                EXPECT_EQ(image.get(k, j, i), brickedImage.get(k, j, i));
+            }
+        }
+    }
+}
+
+TEST(GammaCommonTest, brickedImageHaloShouldReplicateLastVoxel){
+    const yagit::DataSize size{2, 3, 5};
+    std::vector<float> data(size.frames * size.rows * size.columns);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = static_cast<float>(i);
+    }
+    const yagit::ImageData image(data, size, {0, 0, 0}, {1, 1, 1});
+
+    const yagit::BrickedImage brickedImage(image);
+
+    EXPECT_EQ(image.get(1, 2, 4), brickedImage.get(2, 3, 5));
+    EXPECT_EQ(image.get(0, 2, 1), brickedImage.get(0, 3, 1));
+    EXPECT_EQ(image.get(1, 0, 4), brickedImage.get(1, 0, 5));
+}
+
+TEST(GammaCommonTest, paddedImageShouldReplicateClosestVoxel){
+    const yagit::DataSize size{2, 3, 5};
+    std::vector<float> data(size.frames * size.rows * size.columns);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = static_cast<float>(i);
+    }
+    const yagit::ImageData image(data, size, {1, 2, 3}, {0.5, 1, 1.5});
+
+    const yagit::PaddedImage<> paddedImage(image, 1, 4);
+
+    EXPECT_EQ(size, paddedImage.getSize());
+    EXPECT_EQ(image.getOffset(), paddedImage.getOffset());
+    EXPECT_EQ(image.getSpacing(), paddedImage.getSpacing());
+    EXPECT_EQ(8, paddedImage.getPaddedColumns());
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j <= size.rows; j++){
+            const float* row = paddedImage.getRow(k, j);
+            for(uint32_t i = 0; i < paddedImage.getPaddedColumns(); i++){
+                const float expected = image.get(k, std::min(j, size.rows - 1), std::min(i, size.columns - 1));
+                EXPECT_EQ(expected, paddedImage.get(k, j, i));
+                EXPECT_EQ(expected, row[i]);
+            }
+        }
+    }
+}
+
+TEST(GammaCommonTest, paddedAndBrickedImageOfCompactImageShouldMatchWidenedImage){
+    const yagit::DataSize size{3, 4, 5};
+    std::vector<float> data(size.frames * size.rows * size.columns);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = 0.3f * static_cast<float>(i);
+    }
+    const yagit::CompactImageData compactImg(yagit::ImageData(data, size, {1, 2, 3}, {0.5, 1, 1.5}),
+                                             yagit::CompactFormat::BFloat16);
+    const yagit::ImageData widenedImg = compactImg.toImageData();
+
+    const yagit::PaddedImage<> paddedImage(compactImg, 1, 4);
+    const yagit::PaddedImage<> expectedPaddedImage(widenedImg, 1, 4);
+    const yagit::BrickedImage brickedImage(compactImg);
+    const yagit::BrickedImage expectedBrickedImage(widenedImg);
+    // raw 16-bit values are widened when they are read
+    const yagit::CompactPaddedImage<yagit::BFloat16Values> compactPaddedImage(compactImg, 1, 4);
+    const yagit::BrickedImage<yagit::BFloat16Values> compactBrickedImage(compactImg);
+
+    EXPECT_EQ(size, paddedImage.getSize());
+    EXPECT_EQ(widenedImg.getOffset(), paddedImage.getOffset());
+    EXPECT_EQ(widenedImg.getSpacing(), paddedImage.getSpacing());
+    EXPECT_EQ(expectedPaddedImage.getPaddedColumns(), paddedImage.getPaddedColumns());
+    EXPECT_EQ(size, brickedImage.getSize());
+    EXPECT_EQ(widenedImg.getOffset(), brickedImage.getOffset());
+    EXPECT_EQ(widenedImg.getSpacing(), brickedImage.getSpacing());
+    // halo is included
+    for(uint32_t k = 0; k <= size.frames; k++){
+        for(uint32_t j = 0; j <= size.rows; j++){
+            for(uint32_t i = 0; i <= size.columns; i++){
+                if(k < size.frames){
+                    EXPECT_EQ(expectedPaddedImage.get(k, j, i), paddedImage.get(k, j, i));
+                    EXPECT_EQ(expectedPaddedImage.get(k, j, i), compactPaddedImage.get(k, j, i));
+                }
+                EXPECT_EQ(expectedBrickedImage.get(k, j, i), brickedImage.get(k, j, i));
+                EXPECT_EQ(expectedBrickedImage.get(k, j, i), compactBrickedImage.get(k, j, i));
+            }
+        }
+    }
+}
+
+TEST(GammaCommonTest, lazyEvalFramesShouldInterpolateFramesOnDemandAndReleaseThem){
+    const yagit::ImageData refImg(yagit::ImageData::container_type(3 * 2 * 2, 1), {3, 2, 2}, {0, 0, 0}, {1, 1, 1});
+    const yagit::ImageData evalImg({0, 0, 0, 0, 2, 4, 6, 8}, {2, 2, 2}, {0.5, 0, 0}, {1, 1, 1});
+    const auto tiles = yagit::generateTiles(refImg.getSize(), {1, 1, 2}, yagit::TileOrder::MortonByFrame);
+    const yagit::LazyEvalFrames evalFrames(refImg, evalImg, tiles);
+
+    // reference frame 0 (z = 0) is outside evaluated image
+    EXPECT_EQ(nullptr, evalFrames.acquire(0));
+
+    // reference frame 1 (z = 1) is between evaluated frames
+    const auto* frame1 = evalFrames.acquire(1);
+    ASSERT_NE(nullptr, frame1);
+    EXPECT_FLOAT_EQ(1, frame1->get(0, 0, 0));
+    EXPECT_FLOAT_EQ(2, frame1->get(0, 0, 1));
+    EXPECT_FLOAT_EQ(3, frame1->get(0, 1, 0));
+    EXPECT_FLOAT_EQ(4, frame1->get(0, 1, 1));
+    EXPECT_FLOAT_EQ(1, frame1->getOffset().frames);
+
+    // frame is interpolated once and kept until all its tiles (2 rows) are released
+    evalFrames.release(1);
+    EXPECT_EQ(frame1, evalFrames.acquire(1));
+    evalFrames.release(1);
+}
+
+TEST(GammaCommonTest, wendlingInterpolationsAtPoint){
+    // dose is a quadratic function of position, which is reproduced exactly only by cubic (Catmull-Rom) interpolation
+    const yagit::DataSize size{1, 5, 6};
+    std::vector<float> data(size.rows * size.columns);
+    for(uint32_t j = 0; j < size.rows; j++){
+        for(uint32_t i = 0; i < size.columns; i++){
+            data[j * size.columns + i] = static_cast<float>(j * j + 2 * i);
+        }
+    }
+    const yagit::ImageData image(data, size, {0, 1, 2}, {1, 2, 2});
+    const yagit::PaddedImage<> paddedImage(image, 1);
+    const yagit::EvalGrid grid(paddedImage);
+
+    // point between voxels (j=1.75, i=2.5)
+    const float ye = 1 + 1.75f * 2;
+    const float xe = 2 + 2.5f * 2;
+
+    EXPECT_FLOAT_EQ(4 + 2 * 3, yagit::NearestInterpolation::at2D(paddedImage, 0, grid, ye, xe));
+    EXPECT_FLOAT_EQ(0.25f * (1 + 5) + 0.75f * (4 + 5), yagit::LinearInterpolation::at2D(paddedImage, 0, grid, ye, xe));
+    EXPECT_FLOAT_EQ(1.75f * 1.75f + 5, yagit::CubicInterpolation::at2D(paddedImage, 0, grid, ye, xe));
+
+    // at voxels all interpolations return value of the voxel, also at the border
+    for(uint32_t j = 0; j < size.rows; j++){
+        for(uint32_t i = 0; i < size.columns; i++){
+            const float yv = 1 + j * 2.0f;
+            const float xv = 2 + i * 2.0f;
+            EXPECT_FLOAT_EQ(image.get(0, j, i), yagit::NearestInterpolation::at2D(paddedImage, 0, grid, yv, xv));
+            EXPECT_FLOAT_EQ(image.get(0, j, i), yagit::LinearInterpolation::at2D(paddedImage, 0, grid, yv, xv));
+            EXPECT_FLOAT_EQ(image.get(0, j, i), yagit::CubicInterpolation::at2D(paddedImage, 0, grid, yv, xv));
+        }
+    }
+}
+
+TEST(GammaCommonTest, wendlingInterpolationsAtPoint3D){
+    const yagit::DataSize size{4, 5, 6};
+    std::vector<float> data(size.frames * size.rows * size.columns);
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            for(uint32_t i = 0; i < size.columns; i++){
+                data[(k * size.rows + j) * size.columns + i] = static_cast<float>(k * k + j + i * i);
+            }
+        }
+    }
+    const yagit::ImageData image(data, size, {0, 0, 0}, {1, 1, 1});
+    const yagit::BrickedImage brickedImage(image);
+    const yagit::EvalGrid grid(brickedImage);
+
+    EXPECT_FLOAT_EQ(4 + 3 + 9, yagit::NearestInterpolation::at3D(brickedImage, grid, 1.5f, 2.75f, 3.25f));
+    EXPECT_FLOAT_EQ(2.5f + 2.75f + 0.75f * 9 + 0.25f * 16,
+                    yagit::LinearInterpolation::at3D(brickedImage, grid, 1.5f, 2.75f, 3.25f));
+    EXPECT_FLOAT_EQ(1.5f * 1.5f + 2.75f + 3.25f * 3.25f,
+                    yagit::CubicInterpolation::at3D(brickedImage, grid, 1.5f, 2.75f, 3.25f));
+}
+
+TEST(GammaCommonTest, passingRateMonitorShouldDecideWhenTargetCanNoLongerBeMet){
+    // 4 voxels need calculation (the first one is below dose cutoff), each of them is a separate tile
+    const yagit::ImageData refImg(yagit::ImageData::container_type{0.1, 1, 1, 1, 1}, {1, 1, 5}, {0, 0, 0}, {1, 1, 1});
+    const yagit::GammaParameters gammaParams{3, 3, yagit::GammaNormalization::Global, 1, 0.5};
+    const yagit::GammaValues gammaVals{yagit::NaN, 0.5, 2, 1.5, 0.2};
+    const auto tile = [](uint32_t i){ return yagit::Tile{0, 1, 0, 1, i, i + 1}; };
+
+    yagit::PassingRateMonitor monitor(refImg, gammaParams, {0.75});
+    monitor.addTile(tile(0), gammaVals);
+    monitor.addTile(tile(1), gammaVals);
+    EXPECT_FALSE(monitor.isDecided());
+    // 1 passed and 1 failed of 4, so at most 3/4 can pass
+    monitor.addTile(tile(2), gammaVals);
+    EXPECT_FALSE(monitor.isDecided());
+    // 1 passed and 2 failed of 4
+    monitor.addTile(tile(3), gammaVals);
+    EXPECT_TRUE(monitor.isDecided());
+    EXPECT_TRUE(monitor.isPartial());
+    EXPECT_FALSE(monitor.isTargetMet());
+}
+
+TEST(GammaCommonTest, passingRateMonitorShouldDecideWhenTargetIsGuaranteed){
+    const yagit::ImageData refImg(yagit::ImageData::container_type{1, 1, 1, 1}, {1, 1, 4}, {0, 0, 0}, {1, 1, 1});
+    const yagit::GammaParameters gammaParams{3, 3, yagit::GammaNormalization::Global, 1, 0.5};
+    const yagit::GammaValues gammaVals{0.5, 0.7, 2, yagit::NaN};
+    const auto tile = [](uint32_t i){ return yagit::Tile{0, 1, 0, 1, i, i + 1}; };
+
+    yagit::PassingRateMonitor guaranteedMonitor(refImg, gammaParams, {0.5, true});
+    guaranteedMonitor.addTile(tile(0), gammaVals);
+    EXPECT_FALSE(guaranteedMonitor.isDecided());
+    guaranteedMonitor.addTile(tile(1), gammaVals);
+    EXPECT_TRUE(guaranteedMonitor.isDecided());
+    EXPECT_TRUE(guaranteedMonitor.isPartial());
+    EXPECT_TRUE(guaranteedMonitor.isTargetMet());
+
+    // NaN voxels are not taken into account in passing rate (2 of 3 voxels pass)
+    yagit::PassingRateMonitor monitor(refImg, gammaParams, {0.6});
+    for(uint32_t i = 0; i < 4; i++){
+        monitor.addTile(tile(i), gammaVals);
+    }
+    EXPECT_TRUE(monitor.isDecided());
+    EXPECT_FALSE(monitor.isPartial());
+    EXPECT_TRUE(monitor.isTargetMet());
+}
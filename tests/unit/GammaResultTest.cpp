@@ -20,6 +20,9 @@
 #include "yagit/GammaResult.hpp"
 
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using ::testing::IsNan;
 
 namespace{
 const float NaN = std::numeric_limits<float>::quiet_NaN();
@@ -66,3 +69,41 @@ TEST(GammaResultTest, varGamma){
     EXPECT_FLOAT_EQ(expectedVarGamma, GAMMA_RESULT.varGamma());
     EXPECT_FLOAT_EQ(expectedVarGamma, GAMMA_RESULT_WITH_NANS.varGamma());
 }
+
+TEST(GammaResultTest, statistics){
+    const std::vector<float> thresholds{0.5, 1, 2};
+    const std::vector<double> percentiles{50, 0, 25, 100};
+    const std::vector<double> expectedPassingRates{0.625, 0.75, 0.875};
+    const std::vector<float> expectedPercentiles{0.35, 0.0, 0.175, 3.0};
+
+    for(const auto& gammaRes : {GAMMA_RESULT, GAMMA_RESULT_WITH_NANS}){
+        const yagit::GammaStatistics stats = gammaRes.statistics(thresholds, percentiles);
+        EXPECT_EQ(8, stats.size);
+        EXPECT_FLOAT_EQ(6.1, stats.sumGamma);
+        EXPECT_FLOAT_EQ(0.7625, stats.meanGamma);
+        EXPECT_FLOAT_EQ(0.86234375, stats.varGamma);
+        EXPECT_FLOAT_EQ(0.0, stats.minGamma);
+        EXPECT_FLOAT_EQ(3.0, stats.maxGamma);
+        ASSERT_EQ(expectedPassingRates.size(), stats.passingRates.size());
+        for(size_t i = 0; i < expectedPassingRates.size(); i++){
+            EXPECT_DOUBLE_EQ(expectedPassingRates[i], stats.passingRates[i]);
+        }
+        ASSERT_EQ(expectedPercentiles.size(), stats.percentiles.size());
+        for(size_t i = 0; i < expectedPercentiles.size(); i++){
+            EXPECT_FLOAT_EQ(expectedPercentiles[i], stats.percentiles[i]);
+        }
+    }
+}
+
+TEST(GammaResultTest, statisticsOfOnlyNans){
+    const yagit::GammaResult gammaRes(yagit::ImageData::container_type{NaN, NaN}, {1, 1, 2}, {0, 0, 0}, {1, 1, 1});
+    const yagit::GammaStatistics stats = gammaRes.statistics({1}, {50});
+    EXPECT_EQ(0, stats.size);
+    EXPECT_THAT(stats.passingRates[0], IsNan());
+    EXPECT_THAT(stats.percentiles[0], IsNan());
+}
+
+TEST(GammaResultTest, statisticsThrowsForInvalidPercentile){
+    EXPECT_THROW(GAMMA_RESULT.statistics({1}, {-1}), std::invalid_argument);
+    EXPECT_THROW(GAMMA_RESULT.statistics({1}, {100.5}), std::invalid_argument);
+}
@@ -20,6 +20,8 @@
 #include "yagit/Gamma.hpp"
 
 #include <tuple>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include <gtest/gtest.h>
@@ -72,6 +74,15 @@ const yagit::GammaParameters INCORRECT_GAMMA_PARAMS4{3, 0, yagit::GammaNormaliza
 const yagit::GammaParameters INCORRECT_GAMMA_PARAMS5{3, 3, yagit::GammaNormalization::Global, 10, 0, 0, 0};
 const yagit::GammaParameters INCORRECT_GAMMA_PARAMS6{3, 3, yagit::GammaNormalization::Global, 10, 0, 10, 0};
 const yagit::GammaParameters INCORRECT_GAMMA_PARAMS7{3, 3, yagit::GammaNormalization::Global, 10, 0, 10, 12};
+const yagit::GammaParameters INCORRECT_GAMMA_PARAMS8{3, 3, yagit::GammaNormalization::Global, 10, 0, 10, 1,
+                                                     static_cast<yagit::GammaInterpolation>(20)};
+const yagit::GammaParameters INCORRECT_GAMMA_PARAMS9{3, 3, yagit::GammaNormalization::Global, 10, 0, 10, 1,
+                                                     yagit::GammaInterpolation::Linear,
+                                                     static_cast<yagit::GammaTraversal>(20)};
+
+const yagit::GammaInterpolation INTERPOLATIONS[] = {
+    yagit::GammaInterpolation::Nearest, yagit::GammaInterpolation::Linear, yagit::GammaInterpolation::Cubic
+};
 
 using GammaParametric2D = std::tuple<yagit::GammaParameters, yagit::Image2D>;
 using GammaParametric3D = std::tuple<yagit::GammaParameters, yagit::Image3D>;
@@ -526,6 +537,464 @@ TEST(GammaTest, gammaIndex3DWendlingForImagesWithDifferentSpacings){
 }
 
 
+namespace{
+// streamed image reading frames from image in memory
+yagit::StreamedImage streamedImage(const yagit::ImageData& img){
+    return {img.getSize(), img.getOffset(), img.getSpacing(), [&img](uint32_t frameBegin, uint32_t nrOfFrames){
+        const size_t frameSize = static_cast<size_t>(img.getSize().rows) * img.getSize().columns;
+        return yagit::ImageData::container_type(img.data() + frameBegin * frameSize,
+                                                img.data() + (frameBegin + nrOfFrames) * frameSize);
+    }};
+}
+}
+
+TEST(GammaTest, gammaIndex3DWendlingStreamedShouldReturnTheSameImageAsGammaIndex3DWendling){
+    const yagit::DataSize size{9, 6, 7};
+    std::vector<float> refData(size.frames * size.rows * size.columns);
+    std::vector<float> evalData(refData.size());
+    for(size_t i = 0; i < refData.size(); i++){
+        refData[i] = 1 + 0.5f * std::sin(0.3f * i);
+        evalData[i] = 1 + 0.5f * std::sin(0.3f * i + 0.2f);
+    }
+    const yagit::ImageData refImg(refData, size, {0, 0, 0}, {1, 1, 1});
+    // evaluated image is shorter along z, so some reference frames are outside it
+    evalData.resize(6 * size.rows * size.columns);
+    const yagit::ImageData evalImg(evalData, {6, size.rows, size.columns}, {1.3, 0.2, -0.1}, {1.2, 1, 1});
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 2, 0.2};
+
+    // z coordinates of slabs are calculated from their first frame, so they can have different rounding errors
+    const float maxAbsError = 1e-5;
+    const yagit::GammaResult expected = yagit::gammaIndex3DWendling(refImg, evalImg, gammaParams);
+    for(const uint32_t slabFrames : {1u, 2u, 4u, 20u}){
+        std::vector<float> gammaVals;
+        uint32_t nextFrame = 0;
+        yagit::gammaIndex3DWendlingStreamed(streamedImage(refImg), streamedImage(evalImg), gammaParams, slabFrames,
+            [&](const yagit::GammaResult& slab, uint32_t frameBegin){
+                EXPECT_EQ(nextFrame, frameBegin);
+                EXPECT_NEAR(refImg.getOffset().frames + frameBegin * refImg.getSpacing().frames,
+                            slab.getOffset().frames, maxAbsError);
+                nextFrame += slab.getSize().frames;
+                gammaVals.insert(gammaVals.end(), slab.data(), slab.data() + slab.size());
+            });
+
+        EXPECT_EQ(size.frames, nextFrame);
+        EXPECT_THAT(expected, matchImageData(gammaVals, size, refImg.getOffset(), refImg.getSpacing(), maxAbsError));
+    }
+}
+
+TEST(GammaTest, gammaIndex3DWendlingStreamedForIncorrectArgumentsShouldThrow){
+    const auto writeSlab = [](const yagit::GammaResult&, uint32_t){};
+    EXPECT_THROW(yagit::gammaIndex3DWendlingStreamed(streamedImage(REF_3D), streamedImage(EVAL_3D),
+                                                     GAMMA_PARAMS_3D, 0, writeSlab), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendlingStreamed(streamedImage(REF_3D), streamedImage(EVAL_3D),
+                                                     INCORRECT_GAMMA_PARAMS5, 1, writeSlab), std::invalid_argument);
+
+    yagit::StreamedImage incorrectImg = streamedImage(EVAL_3D);
+    incorrectImg.readFrames = [](uint32_t, uint32_t){ return yagit::ImageData::container_type(1); };
+    EXPECT_THROW(yagit::gammaIndex3DWendlingStreamed(streamedImage(REF_3D), incorrectImg,
+                                                     GAMMA_PARAMS_3D, 1, writeSlab), std::runtime_error);
+}
+
+namespace{
+// gaussian dose distribution which is below dose cutoff near the borders of image
+yagit::ImageData gaussianImageData(const yagit::DataSize& size, const yagit::DataOffset& offset, float amplitude){
+    std::vector<float> data;
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            for(uint32_t i = 0; i < size.columns; i++){
+                const float z = k - 0.4f * size.frames;
+                const float y = j - 0.5f * size.rows;
+                const float x = i - 0.6f * size.columns;
+                data.push_back(amplitude * std::exp(-(x * x + y * y + z * z) / 8));
+            }
+        }
+    }
+    return yagit::ImageData(data, size, offset, {1, 1, 1});
+}
+}
+
+TEST(GammaTest, gammaIndexCroppedShouldReturnTheSameImageAsGammaIndex){
+    const yagit::ImageData refImg = gaussianImageData({10, 12, 14}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({11, 13, 12}, {0.3, -0.4, 0.6}, 1.02);
+    const yagit::ImageData refImg2D = refImg.getImageData2D(4);
+    const yagit::ImageData evalImg2D = evalImg.getImageData2D(4);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25,
+                                             yagit::GammaInterpolation::Cubic};
+    // classic method searches the whole evaluated image, so it gives the same values only for large maxSearchDistance
+    yagit::GammaParameters classicGammaParams = gammaParams;
+    classicGammaParams.maxSearchDistance = 100;
+
+    for(const auto method : {yagit::GammaMethod::Classic, yagit::GammaMethod::Wendling, yagit::GammaMethod::Chi}){
+        const auto& params = method == yagit::GammaMethod::Classic ? classicGammaParams : gammaParams;
+        EXPECT_THAT(yagit::gammaIndex2DCropped(refImg2D, evalImg2D, params, method),
+                    matchImageData(yagit::gammaIndex2D(refImg2D, evalImg2D, params, method)));
+        EXPECT_THAT(yagit::gammaIndex2_5DCropped(refImg, evalImg, params, method),
+                    matchImageData(yagit::gammaIndex2_5D(refImg, evalImg, params, method)));
+        EXPECT_THAT(yagit::gammaIndex3DCropped(refImg, evalImg, params, method),
+                    matchImageData(yagit::gammaIndex3D(refImg, evalImg, params, method)));
+    }
+}
+
+TEST(GammaTest, gammaIndex2_5DClassicCroppedShouldCompareFramesWithTheSameIndex){
+    // bounding box of dose cutoff starts at frame 4, and evaluated image cropped by search distance would start at frame 0
+    const yagit::ImageData refImg = gaussianImageData({20, 12, 12}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({20, 12, 12}, {0.3, -0.4, 0.6}, 1.02);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25};
+
+    const yagit::GammaResult expected = yagit::gammaIndex2_5D(refImg, evalImg, gammaParams, yagit::GammaMethod::Classic);
+    const yagit::GammaResult gammaRes = yagit::gammaIndex2_5DCropped(refImg, evalImg, gammaParams,
+                                                                     yagit::GammaMethod::Classic);
+    ASSERT_EQ(expected.getSize(), gammaRes.getSize());
+    for(size_t i = 0; i < expected.size(); i++){
+        if(std::isnan(expected.get(i))){
+            EXPECT_TRUE(std::isnan(gammaRes.get(i)));
+        }
+        else if(expected.get(i) <= gammaParams.maxSearchDistance / gammaParams.dtaThreshold){
+            EXPECT_FLOAT_EQ(expected.get(i), gammaRes.get(i));
+        }
+        else{
+            // evaluated voxels further than maxSearchDistance are not taken into account
+            EXPECT_GE(gammaRes.get(i), expected.get(i));
+        }
+    }
+}
+
+TEST(GammaTest, gammaIndexWendlingWithTiledTraversalShouldReturnTheSameImageAsWithRasterTraversal){
+    // images are larger than one tile (16x16 in 2D, 4x4x4 in 3D)
+    const yagit::ImageData refImg = gaussianImageData({10, 20, 18}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({11, 19, 17}, {0.3, -0.4, 0.6}, 1.02);
+    const yagit::ImageData refImg2D = refImg.getImageData2D(4);
+    const yagit::ImageData evalImg2D = evalImg.getImageData2D(4);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25};
+    yagit::GammaParameters tiledGammaParams = gammaParams;
+    tiledGammaParams.traversal = yagit::GammaTraversal::Tiled;
+
+    // coordinates of voxels are accumulated from the beginning of tile, so they can have different rounding errors
+    EXPECT_THAT(yagit::gammaIndex2DWendling(refImg2D, evalImg2D, tiledGammaParams),
+                matchImageData(yagit::gammaIndex2DWendling(refImg2D, evalImg2D, gammaParams), MAX_ABS_ERROR));
+    EXPECT_THAT(yagit::gammaIndex2_5DWendling(refImg, evalImg, tiledGammaParams),
+                matchImageData(yagit::gammaIndex2_5DWendling(refImg, evalImg, gammaParams), MAX_ABS_ERROR));
+    EXPECT_THAT(yagit::gammaIndex3DWendling(refImg, evalImg, tiledGammaParams),
+                matchImageData(yagit::gammaIndex3DWendling(refImg, evalImg, gammaParams), MAX_ABS_ERROR));
+}
+
+TEST(GammaTest, gammaIndexCroppedWithCroppedResultShouldReturnBoundingBoxOfDoseCutoff){
+    const yagit::ImageData refImg = gaussianImageData({10, 12, 14}, {1, 2, 3}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({10, 12, 14}, {1, 2, 3}, 1.02);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25};
+
+    // voxels with dose >= 0.2 are in frames 1-7, rows 3-9, columns 5-11, and result is expanded by one voxel
+    const auto croppedRes = yagit::gammaIndex3DCropped(refImg, evalImg, gammaParams, yagit::GammaMethod::Wendling,
+                                                       yagit::GammaCropResult::Cropped);
+    EXPECT_EQ((yagit::DataSize{9, 9, 9}), croppedRes.getSize());
+    EXPECT_EQ((yagit::DataOffset{1, 4, 7}), croppedRes.getOffset());
+    EXPECT_EQ(refImg.getSpacing(), croppedRes.getSpacing());
+
+    const auto fullRes = yagit::gammaIndex3D(refImg, evalImg, gammaParams);
+    for(uint32_t k = 0; k < 9; k++){
+        for(uint32_t j = 0; j < 9; j++){
+            for(uint32_t i = 0; i < 9; i++){
+                const float expected = fullRes.get(k, j + 2, i + 4);
+                if(std::isnan(expected)){
+                    EXPECT_TRUE(std::isnan(croppedRes.get(k, j, i)));
+                }
+                else{
+                    EXPECT_FLOAT_EQ(expected, croppedRes.get(k, j, i));
+                }
+            }
+        }
+    }
+}
+
+TEST(GammaTest, gammaIndexCroppedWithRoiMaskShouldCalculateGammaOnlyInBoundingBoxOfRoi){
+    const yagit::ImageData refImg = gaussianImageData({10, 12, 14}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({10, 12, 14}, {0, 0, 0}, 1.02);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25};
+
+    yagit::ImageData roiMask = generateImageData(0, refImg.getSize(), refImg.getOffset(), refImg.getSpacing());
+    roiMask.get(4, 5, 8) = 1;
+    roiMask.get(5, 6, 9) = 1;
+
+    const auto gammaRes = yagit::gammaIndex3DCropped(refImg, evalImg, roiMask, gammaParams);
+    const auto fullRes = yagit::gammaIndex3D(refImg, evalImg, gammaParams);
+    ASSERT_EQ(refImg.getSize(), gammaRes.getSize());
+    for(uint32_t k = 0; k < 10; k++){
+        for(uint32_t j = 0; j < 12; j++){
+            for(uint32_t i = 0; i < 14; i++){
+                const bool inExpandedBox = k >= 3 && k <= 6 && j >= 4 && j <= 7 && i >= 7 && i <= 10;
+                if(inExpandedBox){
+                    EXPECT_FLOAT_EQ(fullRes.get(k, j, i), gammaRes.get(k, j, i));
+                }
+                else{
+                    EXPECT_TRUE(std::isnan(gammaRes.get(k, j, i)));
+                }
+            }
+        }
+    }
+
+    const auto croppedRes = yagit::gammaIndex3DCropped(refImg, evalImg, roiMask, gammaParams,
+                                                       yagit::GammaMethod::Wendling, yagit::GammaCropResult::Cropped);
+    EXPECT_EQ((yagit::DataSize{4, 4, 4}), croppedRes.getSize());
+}
+
+TEST(GammaTest, gammaIndexCroppedForAllVoxelsBelowDoseCutoffShouldReturnImageFilledWithNaN){
+    yagit::GammaParameters gammaParams = GAMMA_PARAMS_3D;
+    gammaParams.doseCutoff = 10;
+
+    const auto nanImg = generateImageData(NaN, REF_3D.getSize(), REF_3D.getOffset(), REF_3D.getSpacing());
+    EXPECT_THAT(yagit::gammaIndex3DCropped(REF_3D, EVAL_3D, gammaParams), matchImageData(nanImg));
+    EXPECT_EQ(0, yagit::gammaIndex3DCropped(REF_3D, EVAL_3D, gammaParams, yagit::GammaMethod::Wendling,
+                                            yagit::GammaCropResult::Cropped).size());
+}
+
+namespace{
+// buffer with image in every second column (other columns are NaN)
+std::vector<float> interleaveColumns(const yagit::ImageData& img){
+    std::vector<float> buffer(2 * img.size(), NaN);
+    for(size_t i = 0; i < img.size(); i++){
+        buffer[2 * i] = img.get(i);
+    }
+    return buffer;
+}
+
+yagit::ImageView stridedView(const std::vector<float>& buffer, const yagit::ImageData& img){
+    const yagit::DataSize size = img.getSize();
+    const yagit::DataStrides strides{2 * static_cast<std::ptrdiff_t>(size.rows) * size.columns,
+                                     2 * static_cast<std::ptrdiff_t>(size.columns), 2};
+    return yagit::ImageView(buffer.data(), size, img.getOffset(), img.getSpacing(), strides);
+}
+}
+
+TEST(GammaTest, gammaIndexForImageViewsShouldReturnTheSameImageAsForImageData){
+    const yagit::ImageData refImg = gaussianImageData({6, 8, 9}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({7, 8, 8}, {0.3, -0.4, 0.6}, 1.02);
+    const yagit::ImageData refImg2D = refImg.getImageData2D(3);
+    const yagit::ImageData evalImg2D = evalImg.getImageData2D(3);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.2, 2, 0.25};
+
+    // views of contiguous external buffers
+    const std::vector<float> refData = refImg.getData();
+    const std::vector<float> evalData = evalImg.getData();
+    const yagit::ImageView refView(refData.data(), refImg.getSize(), refImg.getOffset(), refImg.getSpacing());
+    const yagit::ImageView evalView(evalData.data(), evalImg.getSize(), evalImg.getOffset(), evalImg.getSpacing());
+    // views with strides
+    const std::vector<float> refBuffer = interleaveColumns(refImg);
+    const std::vector<float> evalBuffer = interleaveColumns(evalImg);
+    const std::vector<float> refBuffer2D = interleaveColumns(refImg2D);
+    const std::vector<float> evalBuffer2D = interleaveColumns(evalImg2D);
+    const yagit::ImageView refStridedView = stridedView(refBuffer, refImg);
+    const yagit::ImageView evalStridedView = stridedView(evalBuffer, evalImg);
+    const yagit::ImageView refStridedView2D = stridedView(refBuffer2D, refImg2D);
+    const yagit::ImageView evalStridedView2D = stridedView(evalBuffer2D, evalImg2D);
+
+    for(const auto method : {yagit::GammaMethod::Classic, yagit::GammaMethod::Wendling, yagit::GammaMethod::Chi}){
+        const yagit::GammaResult expected2_5D = yagit::gammaIndex2_5D(refImg, evalImg, gammaParams, method);
+        const yagit::GammaResult expected3D = yagit::gammaIndex3D(refImg, evalImg, gammaParams, method);
+        EXPECT_THAT(yagit::gammaIndex2_5D(refView, evalView, gammaParams, method), matchImageData(expected2_5D));
+        EXPECT_THAT(yagit::gammaIndex3D(refView, evalView, gammaParams, method), matchImageData(expected3D));
+
+        EXPECT_THAT(yagit::gammaIndex2D(refStridedView2D, evalStridedView2D, gammaParams, method),
+                    matchImageData(yagit::gammaIndex2D(refImg2D, evalImg2D, gammaParams, method)));
+        EXPECT_THAT(yagit::gammaIndex2_5D(refStridedView, evalStridedView, gammaParams, method),
+                    matchImageData(expected2_5D));
+        EXPECT_THAT(yagit::gammaIndex3D(refStridedView, evalStridedView, gammaParams, method),
+                    matchImageData(expected3D));
+        EXPECT_THAT(yagit::gammaIndex3DCropped(refStridedView, evalStridedView, gammaParams, method),
+                    matchImageData(yagit::gammaIndex3DCropped(refImg, evalImg, gammaParams, method)));
+    }
+}
+
+TEST(GammaTest, gammaIndexCroppedForIncorrectArgumentsShouldThrow){
+    EXPECT_THROW(yagit::gammaIndex2DCropped(REF_3D, EVAL_3D, GAMMA_PARAMS_3D), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DCropped(REF_3D, EVAL_3D, ZERO_2D, GAMMA_PARAMS_3D), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DCropped(REF_3D, EVAL_3D, INCORRECT_GAMMA_PARAMS5), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DCropped(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, static_cast<yagit::GammaMethod>(20)),
+                 std::invalid_argument);
+}
+
+namespace{
+// check that calculated values of partial result are the same as values of full result
+void expectPartialResultMatches(const yagit::GammaResult& partialRes, const yagit::GammaResult& fullRes){
+    ASSERT_EQ(fullRes.getSize(), partialRes.getSize());
+    for(uint32_t i = 0; i < fullRes.size(); i++){
+        if(!std::isnan(partialRes.get(i))){
+            EXPECT_FLOAT_EQ(fullRes.get(i), partialRes.get(i));
+        }
+    }
+}
+}
+
+TEST(GammaTest, gammaIndexWendlingWithTargetForMetTargetShouldReturnFullResult){
+    const yagit::ImageData refImg = gaussianImageData({10, 20, 20}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({10, 20, 20}, {0.2, 0.3, -0.1}, 1.01);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.05, 2, 0.25};
+    const yagit::GammaPassingRateTarget target{0.5};
+
+    const auto res2D = yagit::gammaIndex2DWendlingWithTarget(refImg.getImageData2D(4), evalImg.getImageData2D(4),
+                                                             gammaParams, target);
+    EXPECT_FALSE(res2D.partial);
+    EXPECT_TRUE(res2D.targetMet);
+    EXPECT_THAT(res2D.gammaResult,
+                matchImageData(yagit::gammaIndex2DWendling(refImg.getImageData2D(4), evalImg.getImageData2D(4), gammaParams)));
+
+    const auto res2_5D = yagit::gammaIndex2_5DWendlingWithTarget(refImg, evalImg, gammaParams, target);
+    EXPECT_FALSE(res2_5D.partial);
+    EXPECT_TRUE(res2_5D.targetMet);
+    EXPECT_THAT(res2_5D.gammaResult, matchImageData(yagit::gammaIndex2_5DWendling(refImg, evalImg, gammaParams)));
+
+    const auto res3D = yagit::gammaIndex3DWendlingWithTarget(refImg, evalImg, gammaParams, target);
+    EXPECT_FALSE(res3D.partial);
+    EXPECT_TRUE(res3D.targetMet);
+    EXPECT_THAT(res3D.gammaResult, matchImageData(yagit::gammaIndex3DWendling(refImg, evalImg, gammaParams)));
+}
+
+TEST(GammaTest, gammaIndexWendlingWithTargetForUnreachableTargetShouldStopEarly){
+    const yagit::ImageData refImg = gaussianImageData({10, 20, 20}, {0, 0, 0}, 1);
+    // evaluated dose is 20% higher and DTA is small, so most of voxels fail
+    const yagit::ImageData evalImg = gaussianImageData({10, 20, 20}, {0, 0, 0}, 1.2);
+    const yagit::GammaParameters gammaParams{1, 0.1, yagit::GammaNormalization::Global, 1, 0.05, 0.2, 0.05};
+    const yagit::GammaPassingRateTarget target{0.95};
+
+    const auto fullRes3D = yagit::gammaIndex3DWendling(refImg, evalImg, gammaParams);
+    ASSERT_LT(fullRes3D.passingRate(), target.passingRate);
+
+    const auto res3D = yagit::gammaIndex3DWendlingWithTarget(refImg, evalImg, gammaParams, target);
+    EXPECT_TRUE(res3D.partial);
+    EXPECT_FALSE(res3D.targetMet);
+    EXPECT_LT(res3D.gammaResult.nansize(), fullRes3D.nansize());
+    expectPartialResultMatches(res3D.gammaResult, fullRes3D);
+
+    const auto res2_5D = yagit::gammaIndex2_5DWendlingWithTarget(refImg, evalImg, gammaParams, target);
+    EXPECT_TRUE(res2_5D.partial);
+    EXPECT_FALSE(res2_5D.targetMet);
+    expectPartialResultMatches(res2_5D.gammaResult, yagit::gammaIndex2_5DWendling(refImg, evalImg, gammaParams));
+
+    const auto refImg2D = refImg.getImageData2D(4);
+    const auto evalImg2D = evalImg.getImageData2D(4);
+    const auto res2D = yagit::gammaIndex2DWendlingWithTarget(refImg2D, evalImg2D, gammaParams, target);
+    EXPECT_TRUE(res2D.partial);
+    EXPECT_FALSE(res2D.targetMet);
+    expectPartialResultMatches(res2D.gammaResult, yagit::gammaIndex2DWendling(refImg2D, evalImg2D, gammaParams));
+}
+
+TEST(GammaTest, gammaIndexWendlingWithTargetStoppingWhenGuaranteedShouldStopEarly){
+    const yagit::ImageData refImg = gaussianImageData({10, 20, 20}, {0, 0, 0}, 1);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.05, 2, 0.25};
+
+    // all voxels pass, so target is guaranteed after the first tile
+    const auto res3D = yagit::gammaIndex3DWendlingWithTarget(refImg, refImg, gammaParams, {0.1, true});
+    EXPECT_TRUE(res3D.partial);
+    EXPECT_TRUE(res3D.targetMet);
+    expectPartialResultMatches(res3D.gammaResult, yagit::gammaIndex3DWendling(refImg, refImg, gammaParams));
+
+    // without stopWhenGuaranteed all voxels are calculated
+    const auto fullRes3D = yagit::gammaIndex3DWendlingWithTarget(refImg, refImg, gammaParams, {0.1, false});
+    EXPECT_FALSE(fullRes3D.partial);
+    EXPECT_TRUE(fullRes3D.targetMet);
+}
+
+TEST(GammaTest, gammaIndexWendlingWithTargetForIncorrectArgumentsShouldThrow){
+    EXPECT_THROW(yagit::gammaIndex2DWendlingWithTarget(REF_2D, EVAL_2D, GAMMA_PARAMS_2D, {-0.1}), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2_5DWendlingWithTarget(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, {1.1}), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendlingWithTarget(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, {NaN}), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendlingWithTarget(REF_3D, EVAL_3D, INCORRECT_GAMMA_PARAMS5, {0.95}),
+                 std::invalid_argument);
+}
+
+namespace{
+void expectSummaryMatches(const yagit::GammaSummary& summary, const yagit::GammaResult& gammaRes,
+                          uint32_t histogramBins, float histogramMax){
+    std::vector<size_t> histogram(histogramBins, 0);
+    const float binWidth = histogramMax / (histogramBins - 1);
+    for(uint32_t i = 0; i < gammaRes.size(); i++){
+        const float val = gammaRes.get(i);
+        if(!std::isnan(val)){
+            histogram[std::min(static_cast<size_t>(val / binWidth), histogram.size() - 1)]++;
+        }
+    }
+
+    EXPECT_EQ(gammaRes.nansize(), summary.size);
+    EXPECT_DOUBLE_EQ(gammaRes.passingRate(), summary.passingRate);
+    EXPECT_FLOAT_EQ(gammaRes.minGamma(), summary.minGamma);
+    EXPECT_FLOAT_EQ(gammaRes.maxGamma(), summary.maxGamma);
+    EXPECT_NEAR(gammaRes.meanGamma(), summary.meanGamma, 1e-9);
+    EXPECT_NEAR(gammaRes.varGamma(), summary.varGamma, 1e-9);
+    EXPECT_FLOAT_EQ(binWidth, summary.histogramBinWidth);
+    EXPECT_EQ(histogram, summary.histogram);
+}
+}
+
+TEST(GammaTest, gammaIndexSummaryShouldReturnStatisticsOfGammaIndex){
+    const yagit::ImageData refImg = gaussianImageData({10, 12, 14}, {0, 0, 0}, 1);
+    const yagit::ImageData evalImg = gaussianImageData({11, 13, 12}, {0.3, -0.4, 0.6}, 1.05);
+    const yagit::ImageData refImg2D = refImg.getImageData2D(4);
+    const yagit::ImageData evalImg2D = evalImg.getImageData2D(4);
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1, 0.1, 2, 0.25};
+
+    for(const auto method : {yagit::GammaMethod::Classic, yagit::GammaMethod::Wendling, yagit::GammaMethod::Chi}){
+        expectSummaryMatches(yagit::gammaIndex2DSummary(refImg2D, evalImg2D, gammaParams, method),
+                             yagit::gammaIndex2D(refImg2D, evalImg2D, gammaParams, method), 21, 2);
+        expectSummaryMatches(yagit::gammaIndex2_5DSummary(refImg, evalImg, gammaParams, method, 5, 0.5),
+                             yagit::gammaIndex2_5D(refImg, evalImg, gammaParams, method), 5, 0.5);
+        expectSummaryMatches(yagit::gammaIndex3DSummary(refImg, evalImg, gammaParams, method, 2, 1),
+                             yagit::gammaIndex3D(refImg, evalImg, gammaParams, method), 2, 1);
+    }
+}
+
+TEST(GammaTest, gammaIndexSummaryOfLargeImageShouldReturnStatisticsOfGammaIndex){
+    // image is processed in several chunks, which should give the same values as the whole image
+    // (chi method is the most sensitive to it, because it uses neighbouring reference voxels)
+    const yagit::DataSize size{20, 250, 220};
+    std::vector<float> refData(size.frames * size.rows * size.columns);
+    std::vector<float> evalData(refData.size());
+    for(size_t i = 0; i < refData.size(); i++){
+        refData[i] = 1 + 0.5f * std::sin(0.01f * i);
+        evalData[i] = 1 + 0.5f * std::sin(0.01f * i + 0.05f);
+    }
+    const yagit::ImageData refImg(refData, size, {0, 0, 0}, {1, 1, 1});
+    const yagit::ImageData evalImg(evalData, size, {0, 0, 0}, {1, 1, 1});
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 2, 0.25};
+
+    expectSummaryMatches(yagit::gammaIndex3DSummary(refImg, evalImg, gammaParams, yagit::GammaMethod::Chi),
+                         yagit::gammaIndex3DChi(refImg, evalImg, gammaParams), 21, 2);
+    expectSummaryMatches(yagit::gammaIndex2_5DSummary(refImg, evalImg, gammaParams, yagit::GammaMethod::Chi),
+                         yagit::gammaIndex2_5DChi(refImg, evalImg, gammaParams), 21, 2);
+
+    const yagit::ImageData refImg2D(refData, {1, 5000, 220}, {0, 0, 0}, {1, 1, 1});
+    const yagit::ImageData evalImg2D(evalData, {1, 5000, 220}, {0, 0, 0}, {1, 1, 1});
+    expectSummaryMatches(yagit::gammaIndex2DSummary(refImg2D, evalImg2D, gammaParams, yagit::GammaMethod::Chi),
+                         yagit::gammaIndex2DChi(refImg2D, evalImg2D, gammaParams), 21, 2);
+}
+
+TEST(GammaTest, gammaIndex2_5DClassicSummaryOfLargeImageShouldCompareFramesWithTheSameIndex){
+    // image is processed in several chunks of frames, and each chunk of reference image
+    // should be compared with frames of evaluated image with the same indices
+    const yagit::DataSize size{16500, 8, 8};
+    std::vector<float> refData(size.frames * size.rows * size.columns);
+    std::vector<float> evalData(refData.size() + 2 * size.rows * size.columns);
+    for(size_t i = 0; i < evalData.size(); i++){
+        if(i < refData.size()){
+            refData[i] = 1 + 0.5f * std::sin(0.01f * i);
+        }
+        evalData[i] = 1 + 0.5f * std::sin(0.01f * i + 0.05f);
+    }
+    const yagit::ImageData refImg(refData, size, {0, 0, 0}, {1, 1, 1});
+    const yagit::ImageData evalImg(evalData, {size.frames + 2, size.rows, size.columns}, {0, 0, 0}, {1, 1, 1});
+    const yagit::GammaParameters gammaParams{3, 1, yagit::GammaNormalization::Global, 1.5, 0, 2, 0.25};
+
+    expectSummaryMatches(yagit::gammaIndex2_5DSummary(refImg, evalImg, gammaParams, yagit::GammaMethod::Classic),
+                         yagit::gammaIndex2_5DClassic(refImg, evalImg, gammaParams), 21, 2);
+}
+
+TEST(GammaTest, gammaIndexSummaryForIncorrectArgumentsShouldThrow){
+    EXPECT_THROW(yagit::gammaIndex2DSummary(REF_3D, EVAL_3D, GAMMA_PARAMS_3D), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DSummary(REF_3D, EVAL_3D, INCORRECT_GAMMA_PARAMS1), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DSummary(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, yagit::GammaMethod::Wendling, 1, 2),
+                 std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DSummary(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, yagit::GammaMethod::Wendling, 10, 0),
+                 std::invalid_argument);
+}
+
 TEST(GammaTest, gammaIndex2DForClassicMethod){
     const yagit::Image2D expectedImage = {
         {0.471405, 0.577350},
@@ -666,6 +1135,124 @@ TEST(GammaTest, gammaIndex3DClassicAndWendlingForCorrespondingParametersShouldRe
     EXPECT_THAT(classicRes, matchImageData(wendlingRes));
 }
 
+TEST(GammaTest, gammaIndexWendlingWithAnyInterpolationForTheSameImagesShouldReturnImageFilledWithZeros){
+    // coordinates of search points have rounding errors, which are amplified by cubic interpolation
+    const float maxAbsError = 1e-5;
+    for(const auto interpolation : INTERPOLATIONS){
+        yagit::GammaParameters gammaParams2D = GAMMA_PARAMS_2D;
+        yagit::GammaParameters gammaParams3D = GAMMA_PARAMS_3D;
+        gammaParams2D.interpolation = interpolation;
+        gammaParams3D.interpolation = interpolation;
+
+        EXPECT_THAT(yagit::gammaIndex2DWendling(REF_2D, REF_2D, gammaParams2D), matchImageData(ZERO_2D, maxAbsError));
+        EXPECT_THAT(yagit::gammaIndex2_5DWendling(REF_3D, REF_3D, gammaParams3D), matchImageData(ZERO_3D, maxAbsError));
+        EXPECT_THAT(yagit::gammaIndex3DWendling(REF_3D, REF_3D, gammaParams3D), matchImageData(ZERO_3D, maxAbsError));
+    }
+}
+
+TEST(GammaTest, gammaIndexClassicAndWendlingWithAnyInterpolationForCorrespondingParametersShouldReturnTheSameImage){
+    // search points lie exactly at voxels, where all interpolations return the value of voxel
+    const float spacing = 2;
+    const yagit::DataSpacing dataSpacing{spacing, spacing, spacing};
+
+    const yagit::ImageData refImg2D(REF_IMAGE_2D, {0, 0, 0}, dataSpacing);
+    const yagit::ImageData evalImg2D(EVAL_IMAGE_2D, {0, 0, 0}, dataSpacing);
+    const yagit::ImageData refImg3D(REF_IMAGE_3D, {0, 0, 0}, dataSpacing);
+    const yagit::ImageData evalImg3D(EVAL_IMAGE_3D, {0, 0, 0}, dataSpacing);
+
+    for(const auto interpolation : INTERPOLATIONS){
+        yagit::GammaParameters gammaParams{3, 3, yagit::GammaNormalization::Global, refImg3D.max(), 0, 10, spacing};
+        gammaParams.interpolation = interpolation;
+
+        EXPECT_THAT(yagit::gammaIndex2DWendling(refImg2D, evalImg2D, gammaParams),
+                    matchImageData(yagit::gammaIndex2DClassic(refImg2D, evalImg2D, gammaParams)));
+        EXPECT_THAT(yagit::gammaIndex2_5DWendling(refImg3D, evalImg3D, gammaParams),
+                    matchImageData(yagit::gammaIndex2_5DClassic(refImg3D, evalImg3D, gammaParams)));
+        EXPECT_THAT(yagit::gammaIndex3DWendling(refImg3D, evalImg3D, gammaParams),
+                    matchImageData(yagit::gammaIndex3DClassic(refImg3D, evalImg3D, gammaParams)));
+    }
+}
+
+TEST(GammaTest, gammaIndexChiForTheSameImagesShouldReturnImageFilledWithZeros){
+    EXPECT_THAT(yagit::gammaIndex2DChi(REF_2D, REF_2D, GAMMA_PARAMS_2D), matchImageData(ZERO_2D, MAX_ABS_ERROR2));
+    EXPECT_THAT(yagit::gammaIndex2_5DChi(REF_3D, REF_3D, GAMMA_PARAMS_3D), matchImageData(ZERO_3D, MAX_ABS_ERROR2));
+    EXPECT_THAT(yagit::gammaIndex3DChi(REF_3D, REF_3D, GAMMA_PARAMS_3D), matchImageData(ZERO_3D, MAX_ABS_ERROR2));
+}
+
+TEST(GammaTest, gammaIndex2DChiForLinearRamp){
+    // ref = x + 1 (gradient 1), eval = ref + 0.5, DD = 1 and DTA = 1, so chi = 0.5 / sqrt(1 + 1).
+    // Rows are longer than SIMD vectors, so vectorized kernel is also tested
+    const uint32_t columns = 20;
+    yagit::Image2D refImage(2, std::vector<float>(columns));
+    yagit::Image2D evalImage(2, std::vector<float>(columns));
+    for(uint32_t j = 0; j < 2; j++){
+        for(uint32_t i = 0; i < columns; i++){
+            refImage[j][i] = i + 1.0f;
+            evalImage[j][i] = i + 1.5f;
+        }
+    }
+    const yagit::ImageData refImg(refImage, {0, 0, 0}, {1, 1, 1});
+    const yagit::ImageData evalImg(evalImage, {0, 0, 0}, {1, 1, 1});
+    // the same doses as evalImg, but on grid shifted by 0.5 along x, so it's interpolated at voxels of refImg
+    const yagit::ImageData evalImgShifted(refImage, {0, 0, 0.5}, {1, 1, 1});
+
+    const yagit::GammaParameters gammaParams{10, 1, yagit::GammaNormalization::Global, 10, 3.5};
+    std::vector<float> expected(refImg.size(), 0.353553f);
+    for(uint32_t j = 0; j < 2; j++){
+        for(uint32_t i = 0; i < 3; i++){
+            expected[j * columns + i] = NaN;  // below dose cutoff
+        }
+    }
+    EXPECT_THAT(yagit::gammaIndex2DChi(refImg, evalImg, gammaParams),
+                matchImageData(expected, refImg.getSize(), refImg.getOffset(), refImg.getSpacing(), MAX_ABS_ERROR));
+    EXPECT_THAT(yagit::gammaIndex2DChi(refImg, evalImgShifted, gammaParams),
+                matchImageData(expected, refImg.getSize(), refImg.getOffset(), refImg.getSpacing(), MAX_ABS_ERROR));
+
+    // local DD is 0.1 * ref, so chi = 0.5 / sqrt((0.1 * ref)^2 + 1)
+    const yagit::GammaParameters gammaParamsLocal{10, 1, yagit::GammaNormalization::Local, 0, 0};
+    std::vector<float> expectedLocal(refImg.size());
+    for(size_t i = 0; i < refImg.size(); i++){
+        expectedLocal[i] = 5 / std::sqrt(refImg.get(i) * refImg.get(i) + 100);
+    }
+    EXPECT_THAT(yagit::gammaIndex2DChi(refImg, evalImg, gammaParamsLocal),
+                matchImageData(expectedLocal, refImg.getSize(), refImg.getOffset(), refImg.getSpacing(), MAX_ABS_ERROR));
+}
+
+TEST(GammaTest, gammaIndex2_5DAnd3DChiForRampAlongZ){
+    // ref = z / 2 + 1 (gradient 0.5 along z), eval = ref + 0.5, DD = 1 and DTA = 2,
+    // so 3D chi = 0.5 / sqrt(1 + 1), but 2.5D chi doesn't use gradient along z and it's 0.5
+    const yagit::DataSize size{3, 2, 20};
+    yagit::Image3D refImage(size.frames, yagit::Image2D(size.rows, std::vector<float>(size.columns)));
+    yagit::Image3D evalImage = refImage;
+    for(uint32_t k = 0; k < size.frames; k++){
+        for(uint32_t j = 0; j < size.rows; j++){
+            for(uint32_t i = 0; i < size.columns; i++){
+                refImage[k][j][i] = k + 1.0f;
+                evalImage[k][j][i] = k + 1.5f;
+            }
+        }
+    }
+    const yagit::ImageData refImg(refImage, {0, 0, 0}, {2, 1, 1});
+    const yagit::ImageData evalImg(evalImage, {0, 0, 0}, {2, 1, 1});
+    const yagit::GammaParameters gammaParams{10, 2, yagit::GammaNormalization::Global, 10, 0};
+
+    EXPECT_THAT(yagit::gammaIndex3DChi(refImg, evalImg, gammaParams),
+                matchImageData(generateImageData(0.353553f, size, refImg.getOffset(), refImg.getSpacing()),
+                               MAX_ABS_ERROR));
+    EXPECT_THAT(yagit::gammaIndex2_5DChi(refImg, evalImg, gammaParams),
+                matchImageData(generateImageData(0.5f, size, refImg.getOffset(), refImg.getSpacing()),
+                               MAX_ABS_ERROR));
+}
+
+TEST(GammaTest, gammaIndexForChiMethod){
+    EXPECT_THAT(yagit::gammaIndex2D(REF_2D, EVAL_2D, GAMMA_PARAMS_2D, yagit::GammaMethod::Chi),
+                matchImageData(yagit::gammaIndex2DChi(REF_2D, EVAL_2D, GAMMA_PARAMS_2D)));
+    EXPECT_THAT(yagit::gammaIndex2_5D(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, yagit::GammaMethod::Chi),
+                matchImageData(yagit::gammaIndex2_5DChi(REF_3D, EVAL_3D, GAMMA_PARAMS_3D)));
+    EXPECT_THAT(yagit::gammaIndex3D(REF_3D, EVAL_3D, GAMMA_PARAMS_3D, yagit::GammaMethod::Chi),
+                matchImageData(yagit::gammaIndex3DChi(REF_3D, EVAL_3D, GAMMA_PARAMS_3D)));
+}
+
 TEST(GammaTest, gammaIndex2DClassicFor3DImageShouldThrow){
     EXPECT_THROW(yagit::gammaIndex2DClassic(REF_3D, EVAL_2D, GAMMA_PARAMS_2D), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2DClassic(REF_2D, EVAL_3D, GAMMA_PARAMS_2D), std::invalid_argument);
@@ -692,6 +1279,14 @@ TEST(GammaTest, gammaIndex3DClassicForIncorrectParametersShouldThrow){
     EXPECT_THROW(yagit::gammaIndex3DClassic(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS4), std::invalid_argument);
 }
 
+TEST(GammaTest, gammaIndexChiForIncorrectParametersShouldThrow){
+    EXPECT_THROW(yagit::gammaIndex2DChi(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS1), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2DChi(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS3), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2DChi(REF_3D, EVAL_2D, GAMMA_PARAMS_2D), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2_5DChi(REF_3D, EVAL_3D, INCORRECT_GAMMA_PARAMS2), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DChi(REF_3D, EVAL_3D, INCORRECT_GAMMA_PARAMS4), std::invalid_argument);
+}
+
 TEST(GammaTest, gammaIndex2DWendlingForIncorrectParametersShouldThrow){
     EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS1), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS2), std::invalid_argument);
@@ -700,6 +1295,8 @@ TEST(GammaTest, gammaIndex2DWendlingForIncorrectParametersShouldThrow){
     EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS5), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS6), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS7), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS8), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS9), std::invalid_argument);
 }
 
 TEST(GammaTest, gammaIndex2_5DWendlingForIncorrectParametersShouldThrow){
@@ -710,6 +1307,8 @@ TEST(GammaTest, gammaIndex2_5DWendlingForIncorrectParametersShouldThrow){
     EXPECT_THROW(yagit::gammaIndex2_5DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS5), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2_5DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS6), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex2_5DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS7), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2_5DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS8), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex2_5DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS9), std::invalid_argument);
 }
 
 TEST(GammaTest, gammaIndex3DWendlingForIncorrectParametersShouldThrow){
@@ -720,4 +1319,6 @@ TEST(GammaTest, gammaIndex3DWendlingForIncorrectParametersShouldThrow){
     EXPECT_THROW(yagit::gammaIndex3DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS5), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex3DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS6), std::invalid_argument);
     EXPECT_THROW(yagit::gammaIndex3DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS7), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS8), std::invalid_argument);
+    EXPECT_THROW(yagit::gammaIndex3DWendling(REF_2D, EVAL_2D, INCORRECT_GAMMA_PARAMS9), std::invalid_argument);
 }
@@ -21,6 +21,8 @@
 
 #include <limits>
 #include <cmath>
+#include <cstdint>
+#include <memory_resource>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -71,8 +73,8 @@ const yagit::ImageData IMAGE_DATA_SMALL(DATA_SMALL, {1, 2, 2}, DATA_OFFSET, DATA
 const yagit::ImageData IMAGE_DATA_SMALL_WITH_NANS(DATA_SMALL_WITH_NANS, {1, 2, 3}, DATA_OFFSET, DATA_SPACING);
 const yagit::ImageData IMAGE_DATA_SMALL_WITH_INFS(DATA_SMALL_WITH_INFS, {1, 2, 3}, DATA_OFFSET, DATA_SPACING);
 const yagit::ImageData IMAGE_DATA_SMALL_WITH_INFS2(DATA_SMALL_WITH_INFS2, {1, 2, 3}, DATA_OFFSET, DATA_SPACING);
-const yagit::ImageData EMPTY_IMAGE_DATA(std::vector<float>{}, {0, 0, 0}, {0, 0, 0}, {1, 1, 1});
-const yagit::ImageData EMPTY_IMAGE_DATA2(std::vector<float>{}, {0, 0, 0}, DATA_OFFSET, DATA_SPACING);
+const yagit::ImageData EMPTY_IMAGE_DATA(yagit::ImageData::container_type{}, {0, 0, 0}, {0, 0, 0}, {1, 1, 1});
+const yagit::ImageData EMPTY_IMAGE_DATA2(yagit::ImageData::container_type{}, {0, 0, 0}, DATA_OFFSET, DATA_SPACING);
 }
 
 TEST(ImageDataTest, defaultConstructor){
@@ -211,12 +213,38 @@ TEST(ImageDataTest, image3DConstructorForEmptyAndInconsistentSizeShouldThrow){
 TEST(ImageDataTest, moveDataConstructor){
     std::vector<float> data(DATA);
 
+    // constructor taking std::vector<float>&& is deprecated, but it has to be still chosen for rvalue std::vector<float>
+    #if defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    #endif
     yagit::ImageData imageData(std::move(data), DATA_SIZE, DATA_OFFSET, DATA_SPACING);
+    #if defined(__GNUC__)
+    #pragma GCC diagnostic pop
+    #endif
 
     EXPECT_EQ(std::vector<float>{}, data);
     EXPECT_THAT(imageData, matchImageData(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING));
 }
 
+TEST(ImageDataTest, moveAlignedDataConstructor){
+    yagit::ImageData::container_type data(DATA.begin(), DATA.end());
+
+    yagit::ImageData imageData(std::move(data), DATA_SIZE, DATA_OFFSET, DATA_SPACING);
+
+    EXPECT_TRUE(data.empty());
+    EXPECT_THAT(imageData, matchImageData(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING));
+}
+
+TEST(ImageDataTest, stdVectorIsCopiedToAlignedStorage){
+    const std::vector<float> data(DATA);
+
+    yagit::ImageData imageData(data, DATA_SIZE, DATA_OFFSET, DATA_SPACING);
+
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(imageData.data()) % yagit::DataAlignment);
+    EXPECT_THAT(imageData, matchImageData(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING));
+}
+
 TEST(ImageDataTest, copyConstructor){
     yagit::ImageData imageData2(IMAGE_DATA);
 
@@ -367,13 +395,42 @@ TEST(ImageDataTest, setDataUsingGetWithIndex){
 }
 
 TEST(ImageDataTest, data){
-    std::vector<float> data(DATA);
+    yagit::ImageData::container_type data(DATA.begin(), DATA.end());
     const float* dataPtr = data.data();
     const yagit::ImageData imageData(std::move(data), DATA_SIZE, DATA_OFFSET, DATA_SPACING);
 
     EXPECT_EQ(dataPtr, imageData.data());
 }
 
+TEST(ImageDataTest, dataIsAligned){
+    for(const yagit::ImageData* imageData : {&IMAGE_DATA, &IMAGE_2D_DATA, &IMAGE_3D_DATA, &IMAGE_DATA_SMALL}){
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(imageData->data()) % yagit::DataAlignment);
+    }
+    const yagit::ImageData imageData2D = IMAGE_3D_DATA.getImageData2D(1, yagit::ImagePlane::Coronal);
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(imageData2D.data()) % yagit::DataAlignment);
+}
+
+TEST(ImageDataTest, dataIsAllocatedFromGivenMemoryResource){
+    std::byte buffer[1024];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    const yagit::ImageData imageData(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING, &resource);
+    const yagit::ImageData imageData3D(IMAGE_3D, DATA_OFFSET, DATA_SPACING, &resource);
+
+    for(const yagit::ImageData* img : {&imageData, &imageData3D}){
+        EXPECT_EQ(&resource, img->getAllocator().getResource());
+        EXPECT_GE(img->data(), reinterpret_cast<const float*>(buffer));
+        EXPECT_LE(img->data() + img->size(), reinterpret_cast<const float*>(buffer + sizeof(buffer)));
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(img->data()) % yagit::DataAlignment);
+    }
+    EXPECT_THAT(imageData, matchImageData(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING));
+    EXPECT_THAT(imageData3D, matchImageData(IMAGE_3D_DATA));
+
+    const yagit::ImageData copy(imageData);
+    EXPECT_EQ(&resource, copy.getAllocator().getResource());
+    EXPECT_EQ(imageData, copy);
+}
+
 TEST(ImageDataTest, getData){
     EXPECT_EQ(DATA, IMAGE_DATA.getData());
 }
@@ -592,6 +649,70 @@ TEST(ImageDataTest, nansize){
     EXPECT_EQ(6, IMAGE_DATA_SMALL_WITH_INFS.nansize());
 }
 
+TEST(ImageDataTest, nanstatistics){
+    const yagit::ImageStatistics stats = IMAGE_DATA_SMALL_WITH_NANS.nanstatistics();
+    EXPECT_EQ(4, stats.size);
+    EXPECT_FLOAT_EQ(8.2, stats.sum);
+    EXPECT_FLOAT_EQ(2.05, stats.mean);
+    EXPECT_FLOAT_EQ(145.8225, stats.var);
+    EXPECT_FLOAT_EQ(-13.5, stats.min);
+    EXPECT_FLOAT_EQ(20.4, stats.max);
+
+    const yagit::ImageStatistics statsInfs = IMAGE_DATA_SMALL_WITH_INFS.nanstatistics();
+    EXPECT_EQ(6, statsInfs.size);
+    EXPECT_FLOAT_EQ(INF, statsInfs.mean);
+    EXPECT_THAT(statsInfs.var, IsNan());
+}
+
+TEST(ImageDataTest, nanstatisticsOfLargeImage){
+    // image is larger than one block of values processed at once
+    std::vector<float> data(3 * 5007);
+    for(size_t i = 0; i < data.size(); i++){
+        data[i] = i % 13 == 0 ? NaN : 1000 + std::sin(0.01f * i) * (i % 7);
+    }
+    const yagit::ImageData img(data, {3, 1, 5007}, DATA_OFFSET, DATA_SPACING);
+
+    size_t expectedSize = 0;
+    double expectedSum = 0;
+    float expectedMin = INF;
+    float expectedMax = -INF;
+    for(float val : data){
+        if(!std::isnan(val)){
+            expectedSize++;
+            expectedSum += val;
+            expectedMin = std::min(expectedMin, val);
+            expectedMax = std::max(expectedMax, val);
+        }
+    }
+    const double expectedMean = expectedSum / expectedSize;
+    double expectedVar = 0;
+    for(float val : data){
+        if(!std::isnan(val)){
+            expectedVar += (val - expectedMean) * (val - expectedMean);
+        }
+    }
+    expectedVar /= expectedSize;
+
+    const yagit::ImageStatistics stats = img.nanstatistics();
+    EXPECT_EQ(expectedSize, stats.size);
+    EXPECT_DOUBLE_EQ(expectedSum, stats.sum);
+    EXPECT_DOUBLE_EQ(expectedMean, stats.mean);
+    EXPECT_NEAR(expectedVar, stats.var, 1e-9 * expectedVar);
+    EXPECT_FLOAT_EQ(expectedMin, stats.min);
+    EXPECT_FLOAT_EQ(expectedMax, stats.max);
+}
+
+TEST(ImageDataTest, nanstatisticsOfOnlyNans){
+    const yagit::ImageData img(yagit::ImageData::container_type{NaN, NaN, NaN}, {1, 1, 3}, DATA_OFFSET, DATA_SPACING);
+    const yagit::ImageStatistics stats = img.nanstatistics();
+    EXPECT_EQ(0, stats.size);
+    EXPECT_DOUBLE_EQ(0, stats.sum);
+    EXPECT_THAT(stats.mean, IsNan());
+    EXPECT_THAT(stats.var, IsNan());
+    EXPECT_FLOAT_EQ(INF, stats.min);
+    EXPECT_FLOAT_EQ(-INF, stats.max);
+}
+
 TEST(ImageDataTest, containsNan){
     EXPECT_FALSE(IMAGE_DATA_SMALL.containsNan());
     EXPECT_TRUE(IMAGE_DATA_SMALL_WITH_NANS.containsNan());
@@ -0,0 +1,118 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/ImageView.hpp"
+
+#include <gtest/gtest.h>
+
+namespace{
+const std::vector<float> DATA{1.5, 2.3, 4.4, 0.1, -0.3, 0.0, -2.5, 153.0, -200.4, 12.9, 9.0, 0.0};
+
+const yagit::DataSize DATA_SIZE{2, 3, 2};
+const yagit::DataOffset DATA_OFFSET{0.1, -1.2, 0.0};
+const yagit::DataSpacing DATA_SPACING{1.0, 2.0, 2.5};
+
+const yagit::ImageData IMAGE_DATA(DATA, DATA_SIZE, DATA_OFFSET, DATA_SPACING);
+
+void expectImageViewEqual(const std::vector<float>& expectedData, const yagit::DataSize& expectedSize,
+                          const yagit::ImageView& view){
+    ASSERT_EQ(expectedSize, view.getSize());
+    ASSERT_EQ(expectedData.size(), view.size());
+    size_t index = 0;
+    for(uint32_t k = 0; k < expectedSize.frames; k++){
+        for(uint32_t j = 0; j < expectedSize.rows; j++){
+            for(uint32_t i = 0; i < expectedSize.columns; i++){
+                EXPECT_EQ(expectedData[index], view.get(k, j, i));
+                EXPECT_EQ(expectedData[index], view.at(k, j, i));
+                index++;
+            }
+        }
+    }
+    EXPECT_EQ(expectedData, view.getData());
+}
+}
+
+TEST(ImageViewTest, defaultConstructor){
+    const yagit::ImageView view;
+    EXPECT_EQ(0, view.size());
+    EXPECT_EQ(nullptr, view.data());
+    EXPECT_TRUE(view.isContiguous());
+    EXPECT_EQ((yagit::DataSpacing{1, 1, 1}), view.getSpacing());
+}
+
+TEST(ImageViewTest, constructorFromImageDataDoesntCopyData){
+    const yagit::ImageView view(IMAGE_DATA);
+    EXPECT_EQ(IMAGE_DATA.data(), view.data());
+    EXPECT_EQ(DATA_SIZE, view.getSize());
+    EXPECT_EQ(DATA_OFFSET, view.getOffset());
+    EXPECT_EQ(DATA_SPACING, view.getSpacing());
+    EXPECT_EQ((yagit::DataStrides{6, 2, 1}), view.getStrides());
+    EXPECT_TRUE(view.isContiguous());
+    expectImageViewEqual(DATA, DATA_SIZE, view);
+}
+
+TEST(ImageViewTest, constructorFromPointer){
+    const yagit::ImageView view(DATA.data(), DATA_SIZE, DATA_OFFSET, DATA_SPACING);
+    EXPECT_EQ(DATA.data(), view.data());
+    EXPECT_TRUE(view.isContiguous());
+    expectImageViewEqual(DATA, DATA_SIZE, view);
+    for(size_t i = 0; i < DATA.size(); i++){
+        EXPECT_EQ(DATA[i], view.get(i));
+    }
+}
+
+TEST(ImageViewTest, constructorThrowsForInvalidArguments){
+    EXPECT_THROW(yagit::ImageView(DATA.data(), DATA_SIZE, DATA_OFFSET, {1.0, 0.0, 1.0}), std::invalid_argument);
+    EXPECT_THROW(yagit::ImageView(nullptr, DATA_SIZE, DATA_OFFSET, DATA_SPACING), std::invalid_argument);
+}
+
+TEST(ImageViewTest, viewWithStrides){
+    // the last column of each frame of DATA (it is 2x3x2 image)
+    const yagit::ImageView columnView(DATA.data() + 1, {2, 3, 1}, DATA_OFFSET, DATA_SPACING, {6, 2, 2});
+    EXPECT_FALSE(columnView.isContiguous());
+    expectImageViewEqual({2.3, 0.1, 0.0, 153.0, 12.9, 0.0}, {2, 3, 1}, columnView);
+
+    // transposed rows and columns
+    const yagit::ImageView transposedView(DATA.data(), {2, 2, 3}, DATA_OFFSET, DATA_SPACING, {6, 1, 2});
+    EXPECT_FALSE(transposedView.isContiguous());
+    expectImageViewEqual({1.5, 4.4, -0.3, 2.3, 0.1, 0.0, -2.5, -200.4, 9.0, 153.0, 12.9, 0.0}, {2, 2, 3},
+                         transposedView);
+}
+
+TEST(ImageViewTest, viewWithNegativeStrides){
+    // frames in reversed order
+    const yagit::ImageView flippedView(DATA.data() + 6, DATA_SIZE, DATA_OFFSET, DATA_SPACING, {-6, 2, 1});
+    EXPECT_FALSE(flippedView.isContiguous());
+    expectImageViewEqual({-2.5, 153.0, -200.4, 12.9, 9.0, 0.0, 1.5, 2.3, 4.4, 0.1, -0.3, 0.0}, DATA_SIZE,
+                         flippedView);
+}
+
+TEST(ImageViewTest, atOutOfRange){
+    const yagit::ImageView view(IMAGE_DATA);
+    EXPECT_THROW(view.at(DATA_SIZE.frames - 1, DATA_SIZE.rows - 1, DATA_SIZE.columns), std::out_of_range);
+    EXPECT_THROW(view.at(100, 100, 100), std::out_of_range);
+}
+
+TEST(ImageViewTest, toImageData){
+    const yagit::ImageView columnView(DATA.data() + 1, {2, 3, 1}, DATA_OFFSET, DATA_SPACING, {6, 2, 2});
+    const yagit::ImageData expected(yagit::ImageData::container_type{2.3, 0.1, 0.0, 153.0, 12.9, 0.0}, {2, 3, 1},
+                                    DATA_OFFSET, DATA_SPACING);
+    EXPECT_EQ(expected, columnView.toImageData());
+    EXPECT_EQ(IMAGE_DATA, yagit::ImageView(IMAGE_DATA).toImageData());
+}
@@ -330,6 +330,55 @@ TEST(InterpolationTest, linearAlongAxisWithRefImg){
     EXPECT_THAT(yagit::Interpolation::linearAlongAxis(img, refImg, yagit::ImageAxis::X), matchImageData(expectedX));
 }
 
+TEST(InterpolationTest, linearFrameAtZ){
+    const yagit::ImageData img({0, 1, 2, 4, 4, 10}, {3, 1, 2}, {1, 2, 3}, {2, 2, 2});
+
+    const yagit::ImageData expected1({1, 2.5}, {1, 1, 2}, {2, 2, 3}, {2, 2, 2});
+    const yagit::ImageData expected2({0, 1}, {1, 1, 2}, {1, 2, 3}, {2, 2, 2});
+    const yagit::ImageData expected3({4, 10}, {1, 1, 2}, {5, 2, 3}, {2, 2, 2});
+    EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(img, 2, 2), matchImageData(expected1, MAX_ABS_ERROR));
+    EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(img, 1, 2), matchImageData(expected2));
+    EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(img, 5, 2), matchImageData(expected3));
+
+    EXPECT_EQ(std::nullopt, yagit::Interpolation::linearFrameAtZ(img, 0.9, 2));
+    EXPECT_EQ(std::nullopt, yagit::Interpolation::linearFrameAtZ(img, 5.1, 2));
+    EXPECT_EQ(std::nullopt, yagit::Interpolation::linearFrameAtZ(yagit::ImageData(), 0, 1));
+}
+
+TEST(InterpolationTest, linearFrameAtZIsTheSameAsFrameOfLinearAlongAxis){
+    const float newOffset = 0.3;
+    const float newSpacing = 0.7;
+    const yagit::ImageData refImg({0}, {1, 1, 1}, {newOffset, 0, 0}, {newSpacing, 1, 1});
+    const yagit::ImageData interpolated = yagit::Interpolation::linearAlongAxis(IMAGE_DATA, refImg, yagit::ImageAxis::Z);
+
+    for(uint32_t k = 0; k < interpolated.getSize().frames; k++){
+        const float z = interpolated.getOffset().frames + k * newSpacing;
+        // spacing along Z isn't changed for a single frame
+        const yagit::ImageData expected = interpolated.getImageData2D(k);
+        EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(IMAGE_DATA, z, newSpacing),
+                    matchImageData(expected.getData(), expected.getSize(), expected.getOffset(),
+                                   IMAGE_DATA.getSpacing(), MAX_ABS_ERROR));
+    }
+}
+
+TEST(InterpolationTest, linearFrameAtZIsTheSameAsFrameOfLinearAlongAxisForCoarseImage){
+    // spacing of grid is smaller than half of spacing of image, so linearAlongAxis uses the formula with slope
+    const float newOffset = 0.3;
+    const float newSpacing = 0.7;
+    const yagit::ImageData img({0.7, -2.3, 11.9, 5.3, 8.1, 9.5, -7.7, 0.01}, {4, 1, 2}, {-0.2, 1, 2}, {3.1, 1, 1});
+    const yagit::ImageData refImg({0}, {1, 1, 1}, {newOffset, 0, 0}, {newSpacing, 1, 1});
+    const yagit::ImageData interpolated = yagit::Interpolation::linearAlongAxis(img, refImg, yagit::ImageAxis::Z);
+    ASSERT_GT(interpolated.getSize().frames, 10);
+
+    for(uint32_t k = 0; k < interpolated.getSize().frames; k++){
+        const float z = interpolated.getOffset().frames + k * newSpacing;
+        const yagit::ImageData expected = interpolated.getImageData2D(k);
+        EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(img, z, newSpacing),
+                    matchImageData(expected.getData(), expected.getSize(), expected.getOffset(),
+                                   img.getSpacing(), 1e-5));  // Z coordinates differ by rounding
+    }
+}
+
 TEST(InterpolationTest, linearAlongAxisInDifferentOrder){
     const float newOffset = 1.2;
     const float newSpacing = 0.7;
@@ -616,3 +665,24 @@ TEST(InterpolationTest, trilinearAndTrilinearAtPointShouldReturnTheSameNumbers){
         }
     }
 }
+
+TEST(InterpolationTest, interpolationOfImageViewWithStridesIsTheSameAsOfItsCopy){
+    // frames of IMAGE_3D in reversed order, without copying
+    const std::vector<float> data = IMAGE_DATA.getData();
+    const yagit::ImageView view(data.data() + 4, {2, 2, 2}, DATA_OFFSET, {1, 1, 1}, {-4, 2, 1});
+    const yagit::ImageData copy = view.toImageData();
+    ASSERT_FALSE(view.isContiguous());
+
+    EXPECT_THAT(yagit::Interpolation::linearAlongAxis(view, 0.4, yagit::ImageAxis::Z),
+                matchImageData(yagit::Interpolation::linearAlongAxis(copy, 0.4, yagit::ImageAxis::Z)));
+    EXPECT_THAT(yagit::Interpolation::bilinearOnPlane(view, 0.3, 0.6, yagit::ImagePlane::YX),
+                matchImageData(yagit::Interpolation::bilinearOnPlane(copy, 0.3, 0.6, yagit::ImagePlane::YX)));
+    EXPECT_THAT(yagit::Interpolation::trilinear(view, {0.5, 0.3, 0.7}),
+                matchImageData(yagit::Interpolation::trilinear(copy, {0.5, 0.3, 0.7})));
+    EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(view, 0.3, 0.4),
+                matchImageData(*yagit::Interpolation::linearFrameAtZ(copy, 0.3, 0.4)));
+    EXPECT_THAT(*yagit::Interpolation::linearFrameAtZ(view, 1, 0.4),
+                matchImageData(*yagit::Interpolation::linearFrameAtZ(copy, 1, 0.4)));
+    EXPECT_FLOAT_EQ(*yagit::Interpolation::trilinearAtPoint(copy, 0.2, 0.6, 0.1),
+                    *yagit::Interpolation::trilinearAtPoint(view, 0.2, 0.6, 0.1));
+}
@@ -0,0 +1,125 @@
+/********************************************************************************************
+ * Copyright (C) 2023 'Yet Another Gamma Index Tool' Developers.
+ * 
+ * This file is part of 'Yet Another Gamma Index Tool'.
+ * 
+ * 'Yet Another Gamma Index Tool' is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * 'Yet Another Gamma Index Tool' is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 'Yet Another Gamma Index Tool'.  If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************************************/
+
+#include "yagit/MappedImage.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "TestUtils.hpp"
+
+using ::testing::ThrowsMessage, ::testing::HasSubstr;
+
+namespace{
+const yagit::Image3D IMAGE_3D = {
+    {{0.93, 0.95}, {0.97, 0.86}},
+    {{0.90, 0.92}, {0.94, 0.96}},
+    {{0.98, 1.00}, {1.01, 0.99}}
+};
+const yagit::DataOffset DATA_OFFSET{2.1, -3.2, 0.0};
+const yagit::DataSpacing DATA_SPACING{1.0, 2.5, 0.5};
+
+const yagit::ImageData IMAGE_DATA(IMAGE_3D, DATA_OFFSET, DATA_SPACING);
+
+// header that is skipped when file is mapped (its length is a multiple of float alignment)
+const std::string HEADER = "header: ";
+
+class MappedImageTest : public ::testing::Test{
+protected:
+    void SetUp() override{
+        std::ofstream file(m_filepath, std::ios::binary);
+        file.write(HEADER.data(), HEADER.size());
+        file.write(reinterpret_cast<const char*>(IMAGE_DATA.data()), IMAGE_DATA.size() * sizeof(float));
+    }
+
+    void TearDown() override{
+        std::remove(m_filepath.c_str());
+    }
+
+    yagit::MappedImage mapImage(size_t dataOffset = HEADER.size()) const{
+        return yagit::MappedImage(m_filepath, dataOffset, IMAGE_DATA.getSize(), DATA_OFFSET, DATA_SPACING);
+    }
+
+    const std::string m_filepath = (std::filesystem::temp_directory_path() / "yagit_mapped_image_test.bin").string();
+};
+}
+
+TEST_F(MappedImageTest, mappedFileConstructor){
+    const yagit::MappedImage image = mapImage();
+    EXPECT_TRUE(image.isMapped());
+    EXPECT_EQ(IMAGE_DATA.size(), image.size());
+    EXPECT_EQ(IMAGE_DATA.get(2, 1, 0), image.get(2, 1, 0));
+    EXPECT_EQ(IMAGE_DATA.get(5), image.get(5));
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST_F(MappedImageTest, viewRefersToMappedData){
+    const yagit::MappedImage image = mapImage();
+    const yagit::ImageView view = image;
+    EXPECT_EQ(image.data(), view.data());
+    EXPECT_THAT(view.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST_F(MappedImageTest, moveKeepsMapping){
+    yagit::MappedImage image = mapImage();
+    const float* data = image.data();
+
+    yagit::MappedImage movedImage(std::move(image));
+    EXPECT_TRUE(movedImage.isMapped());
+    EXPECT_EQ(data, movedImage.data());
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_EQ(0, image.size());
+
+    image = std::move(movedImage);
+    EXPECT_TRUE(image.isMapped());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST_F(MappedImageTest, ownedImageConstructor){
+    yagit::ImageData imageData = IMAGE_DATA;
+    const float* data = imageData.data();
+
+    yagit::MappedImage image(std::move(imageData));
+    EXPECT_FALSE(image.isMapped());
+    EXPECT_EQ(data, image.data());
+    EXPECT_THAT(image.toImageData(), matchImageData(IMAGE_DATA));
+
+    const yagit::MappedImage movedImage(std::move(image));
+    EXPECT_EQ(data, movedImage.data());
+    EXPECT_THAT(movedImage.view().toImageData(), matchImageData(IMAGE_DATA));
+}
+
+TEST_F(MappedImageTest, unalignedDataOffsetShouldThrow){
+    EXPECT_THROW(mapImage(HEADER.size() - 1), std::invalid_argument);
+}
+
+TEST_F(MappedImageTest, tooSmallFileShouldThrow){
+    const auto mapTooSmallFile = [this](){ mapImage(HEADER.size() + sizeof(float)); };
+    EXPECT_THAT(mapTooSmallFile, ThrowsMessage<std::runtime_error>(HasSubstr("doesn't contain")));
+}
+
+TEST(MappedImageFileTest, nonexistentFileShouldThrow){
+    const auto mapNonexistentFile = [](){
+        yagit::MappedImage("nonexistent_file", 0, IMAGE_DATA.getSize(), DATA_OFFSET, DATA_SPACING);
+    };
+    EXPECT_THAT(mapNonexistentFile, ThrowsMessage<std::runtime_error>(HasSubstr("cannot read")));
+}
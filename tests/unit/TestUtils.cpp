@@ -66,7 +66,7 @@ Matcher<yagit::ImageData> matchImageData(const std::vector<float>& expectedData,
 yagit::ImageData generateImageData(float value, const yagit::DataSize& size,
                                    const yagit::DataOffset& offset, const yagit::DataSpacing& spacing){
     size_t count = size.frames * size.rows * size.columns;
-    return yagit::ImageData(std::vector<float>(count, value), size, offset, spacing);
+    return yagit::ImageData(yagit::ImageData::container_type(count, value), size, offset, spacing);
 }
 
 